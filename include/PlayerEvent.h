@@ -8,10 +8,26 @@
 enum class PlayerEvent {
     None,                       // 无事件
     PlayPause,                  // 暂停/播放
-    SeekBackWard_5,             // 回退5S
-    SeekForward_5,              // 前进5S
+    SeekBackWard_5,             // 回退5S（value 为合并后的秒数，暂停时改为后退一帧）
+    SeekForward_5,              // 前进5S（value 为合并后的秒数，暂停时改为前进一帧）
     Restart,                    // 从头播放
-    Quit                        // 退出
+    Quit,                       // 退出
+    Seek,                       // 跳转到进度比例 value，arg 为 1 表示拖动中的预览
+    StepFrame,                  // 暂停时单帧步进，arg 为步数（负数后退）
+    SpeedStep,                  // 播放速度升降档，arg 为档数（负数减速）
+    ToggleFilter,               // 开关滤镜，arg 为按键 1~7 对应的滤镜序号
+    AdjustFilter,               // 灰度强度调节，arg 为步数
+    ClearFilters,               // 关闭所有滤镜
+    CycleScaler,                // 切换缩放方式
+    ToggleStats,                // 显示/隐藏统计
+    ToggleRecording             // 开始/停止录制
+};
+
+// 输入线程发往播放引擎的命令
+struct PlayerCommand {
+    PlayerEvent event = PlayerEvent::None;
+    double value = 0.0;
+    int arg = 0;
 };
 
 #endif //PLAYEREVENT_H
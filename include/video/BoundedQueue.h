@@ -0,0 +1,102 @@
+//
+// Created by WeiChuandong on 2025/3/18.
+//
+
+#ifndef VIDEOPLAYER_BOUNDEDQUEUE_H
+#define VIDEOPLAYER_BOUNDEDQUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+namespace video {
+
+    // 有界阻塞队列，用于流水线各阶段之间传递帧
+    template <typename T>
+    class BoundedQueue {
+    public:
+        explicit BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+        // 队列满时阻塞，队列关闭后返回 false
+        bool push(T item) {
+            std::unique_lock<std::mutex> lock(mutex);
+            notFull.wait(lock, [this] { return closed || items.size() < capacity; });
+            if (closed) return false;
+            items.push_back(std::move(item));
+            notEmpty.notify_one();
+            return true;
+        }
+
+        // 不阻塞，队列满或已关闭时返回 false，item 保持不变
+        bool tryPush(T& item) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed || items.size() >= capacity) return false;
+            items.push_back(std::move(item));
+            notEmpty.notify_one();
+            return true;
+        }
+
+        // 队列空时阻塞，队列关闭且取空后返回 false
+        bool pop(T& item) {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [this] { return closed || !items.empty(); });
+            if (items.empty()) return false;
+            item = std::move(items.front());
+            items.pop_front();
+            notFull.notify_one();
+            return true;
+        }
+
+        // 最多等待 timeout，超时或队列关闭且取空后返回 false
+        template <typename Rep, typename Period>
+        bool popFor(T& item, std::chrono::duration<Rep, Period> timeout) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!notEmpty.wait_for(lock, timeout, [this] { return closed || !items.empty(); })) return false;
+            if (items.empty()) return false;
+            item = std::move(items.front());
+            items.pop_front();
+            notFull.notify_one();
+            return true;
+        }
+
+        bool tryPop(T& item) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (items.empty()) return false;
+            item = std::move(items.front());
+            items.pop_front();
+            notFull.notify_one();
+            return true;
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+            notEmpty.notify_all();
+            notFull.notify_all();
+        }
+
+        // 调整容量，变小时已在队列中的元素保留，取走后才接受新元素
+        void setCapacity(size_t value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            capacity = value;
+            notFull.notify_all();
+        }
+
+        size_t size() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return items.size();
+        }
+
+    private:
+        mutable std::mutex mutex;
+        std::condition_variable notEmpty;
+        std::condition_variable notFull;
+        std::deque<T> items;
+        size_t capacity;
+        bool closed = false;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_BOUNDEDQUEUE_H
@@ -0,0 +1,19 @@
+//
+// Created by Weichuandong on 2025/3/30.
+//
+
+#ifndef VIDEOPLAYER_BOXDOWNSCALE_H
+#define VIDEOPLAYER_BOXDOWNSCALE_H
+
+#include <cstdint>
+
+namespace video {
+
+    // 8bit 单通道平面的 2x2 盒式缩小（四舍五入取平均），SSE2/NEON 加速
+    // dst 尺寸可以是 src 的一半向上取整，越界的源行列取边缘像素
+    void box_downscale_2x(const uint8_t* src, int src_stride, int src_width, int src_height,
+                          uint8_t* dst, int dst_stride, int dst_width, int dst_height);
+
+} // namespace video
+
+#endif //VIDEOPLAYER_BOXDOWNSCALE_H
@@ -0,0 +1,44 @@
+//
+// Created by Weichuandong on 2025/4/4.
+//
+
+#ifndef VIDEOPLAYER_COMMANDBUS_H
+#define VIDEOPLAYER_COMMANDBUS_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <SDL2/SDL.h>
+#include "PlayerEvent.h"
+#include "video/MpscRing.h"
+
+namespace video {
+
+    constexpr double RelativeSeekSeconds = 5.0;    // 方向键一次跳转的秒数
+
+    // 按键绑定，没有对应命令时 event 为 None
+    PlayerCommand command_for_key(SDL_Keycode key);
+
+    // 输入到播放引擎的命令总线
+    // 窗口事件线程（以及其他任意线程）投递命令，无锁、从不阻塞；
+    // 播放线程在帧边界一次取出全部命令，相邻的同类命令先合并再执行：
+    // 跳转在整批中只保留最新的一次（预览或最终跳转，按到达顺序，不要求相邻），
+    // 相对跳转、变速档位、单帧步进和强度调节累加，成对的暂停/播放抵消
+    class CommandBus {
+    public:
+        // 队列满时丢弃命令并返回 false
+        bool post(const PlayerCommand& command);
+        // 仅播放线程调用，commands 被替换为合并后的命令
+        void drain(std::vector<PlayerCommand>& commands);
+
+    private:
+        // next 能并入 last 时返回 true；合并后互相抵消时 last.event 置为 None
+        static bool merge(PlayerCommand& last, const PlayerCommand& next);
+
+        MpscRing<PlayerCommand, 256> queue;
+        std::atomic<int64_t> dropped{0};
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_COMMANDBUS_H
@@ -1,9 +1,19 @@
 #ifndef FFMPEGDECODER_H
 #define FFMPEGDECODER_H
 
+#include <chrono>
+#include <functional>
 #include <string>
 #include <stdexcept>
+#include <thread>
+#include <atomic>
 #include "logger.h"
+#include "video/BoundedQueue.h"
+#include "video/FrameBufferPool.h"
+#include "video/MemoryBudget.h"
+#include "video/ProgressiveInput.h"
+#include "video/RGBConverter.h"
+#include "video/TrickPlayPolicy.h"
 #include "video/filters/FilterManager.h"
 
 extern "C" {
@@ -14,7 +24,18 @@ extern "C" {
 
 namespace video {
 
-    class FFmpegDecoder {
+    struct DecoderOptions {
+        int threads = 0;            // 解码线程数，0 表示由 FFmpeg 按核数选择
+        // 显示尺寸，>0 时在解码器支持的范围内按它选择低分辨率解码（lowres），解码尺寸不小于显示尺寸
+        int targetWidth = 0;
+        int targetHeight = 0;
+        ProgressiveOptions network;     // http(s) 输入的预读与磁盘缓存
+        // 直播源：解封装不缓冲、只探测少量数据、解码器低延迟输出（不使用帧级多线程）
+        bool lowLatency = false;
+    };
+
+    // 滤镜流水线中的帧登记到内存预算，内存紧张时减少在途帧数
+    class FFmpegDecoder : public MemoryConsumer {
     public:
 
         struct YUVData {
@@ -25,30 +46,109 @@ namespace video {
             }
         };
 
-        explicit FFmpegDecoder(const std::string& filepath);
-        ~FFmpegDecoder();
+        explicit FFmpegDecoder(const std::string& filepath, const DecoderOptions& options = DecoderOptions());
+        ~FFmpegDecoder() override;
+
+        size_t memory_usage() const override { return frames_in_flight * pipeline_frame_bytes; }
+        void on_memory_pressure(int level) override { memory_level = level; }
 
         bool get_next_frame(YUVData& yuv_data);   // 获取下一帧 YUV 数据
-        bool get_next_frame(uint8_t* rgb_buffer); // 获取下一帧 RGB 数据
-        int width() const;  // 视频宽度
+        bool get_next_frame(uint8_t* rgb_buffer); // 获取下一帧 RGB 数据（行距 width * 3）
+        // 获取下一帧 RGB24 数据，按条带多线程转换后直接写入调用方缓冲（建议使用 RGBBuffer 的对齐行距）
+        bool get_next_frame(uint8_t* rgb_buffer, int stride);
+        bool get_next_frame(RGBBuffer& rgb_buffer);
+        int width() const;  // 视频宽度（低分辨率解码时为缩小后的宽度）
         int height() const; // 视频高度
         double get_current_pts() const;  //获取当前时间戳
-        bool seek(double seconds);       //跳转到指定时间
+        // 跳转到指定时间；accurate 为 false 时从目标之前的关键帧开始播放，
+        // 为 true 时从关键帧预解码到目标帧，预解码的帧不经过滤镜、不返回给调用方
+        bool seek(double seconds, bool accurate = false);
+        // 拖动预览：跳转到 seconds 之前的关键帧并只解码这一帧，之后的解码从下一个关键帧继续
+        bool preview_frame(double seconds, YUVData& yuv_data);
         double duration() const;        //获取视频总时长
+        AVRational time_base() const;   //视频流时间基（帧 pts 的单位）
+        AVRational frame_rate() const;  //视频帧率
+        int pix_format() const;         //解码输出像素格式
+        int lowres() const;             //低分辨率解码级别，输出尺寸为原始尺寸的 1/2^lowres
+
+        // 快进时跳过部分帧的解码，下一个数据包起生效
+        void set_decode_skip(DecodeSkip skip);
+        DecodeSkip decode_skip() const { return skip_level; }
 
         FilterManager& getFilterManager() { return filterManager; }
 
+        // 每读到一个视频数据包时调用，参数为数据包时间戳（秒），在解码线程执行
+        using PacketCallback = std::function<void(double pts)>;
+        void setPacketCallback(const PacketCallback& callback) { packet_callback = callback; }
+
+        // 滤镜流水线：滤镜在独立线程执行，与后续帧的解码重叠
+        // depth 为流水线中同时存在的帧数，enable 为 false 时回到解码线程内联滤镜
+        void setFilterPipeline(bool enable, size_t depth = 2);
+
+        // 解码帧缓冲来源（如 GL 暂存缓冲），nullptr 表示使用 FFmpeg 默认分配
+        // 解码器不支持 DR1、像素格式不匹配、启用滤镜或缓冲耗尽时自动回退
+        // pool 必须比解码器存活更久
+        void setFrameBufferPool(FrameBufferPool* pool) { buffer_pool = pool; }
+
     private:
+        // 解码下一帧并计算其 PTS（秒）
+        bool decode_next(AVFrame* frame, double& pts);
+        // 读取下一个视频数据包送入解码器，输入结束时返回 false
+        bool send_next_packet();
+        double frame_seconds(const AVFrame* frame, int64_t dts) const;
+        // 对解码出的帧执行滤镜，结果交给 yuv_data，frame 被释放
+        void apply_filters(AVFrame* frame, YUVData& yuv_data);
+
+        // 自定义 get_buffer2：从 buffer_pool 分配帧缓冲
+        static int get_buffer(AVCodecContext* ctx, AVFrame* frame, int flags);
+        bool fill_from_pool(AVCodecContext* ctx, FrameBufferPool* pool, AVFrame* frame);
+
+        // 滤镜流水线
+        struct StageFrame {
+            AVFrame* frame = nullptr;
+            double pts = 0.0;
+        };
+        void filter_loop();
+        void stop_filter_pipeline();
+        void flush_filter_pipeline();
+        bool get_next_frame_pipelined(YUVData& yuv_data);
+
+        std::unique_ptr<ProgressiveInput> network_input;   // http(s) 输入，需比 fmt_ctx 晚释放
         AVFormatContext* fmt_ctx = nullptr;
         AVCodecContext* codec_ctx = nullptr;
-        struct SwsContext* sws_ctx = nullptr;
+        std::unique_ptr<RGBConverter> rgb_converter;    // RGB 输出路径，首次使用时创建
         int video_stream_idx = -1;
 
         double last_valid_pts = 0.0;     // 当前帧 PTS（秒为单位）
+
+        // 精确跳转的预解码状态
+        bool preroll = false;
+        double preroll_target = 0.0;     // 秒
+        int64_t preroll_target_ts = 0;   // 流时间基
+        int preroll_frames = 0;          // 已解码并丢弃的帧
+        int preroll_nonkey = 0;          // 目标前的非关键包（不被参考的才会被解码器跳过）
+        std::chrono::steady_clock::time_point preroll_start;
+        AVDiscard skip_discard() const;
+        void end_preroll();
+        DecodeSkip skip_level = DecodeSkip::None;
+        bool wait_keyframe = false;      // 只解码关键帧后恢复时，从下一个关键帧开始送入解码器
+        bool decoder_draining = false;   // 输入已结束并送入空包，只取出解码器中剩余的帧
         AVRational stream_time_base;     // 视频流时间基
+        PacketCallback packet_callback;
 
         // 滤镜管理
         FilterManager filterManager;
+
+        std::atomic<FrameBufferPool*> buffer_pool{nullptr};
+
+        std::unique_ptr<BoundedQueue<StageFrame>> filter_input;
+        std::unique_ptr<BoundedQueue<StageFrame>> filter_output;
+        std::thread filter_thread;
+        size_t pipeline_depth = 0;       // 0 表示未启用流水线
+        std::atomic<size_t> frames_in_flight{0};    // 已送入流水线但尚未取出的帧数
+        std::atomic<size_t> pipeline_frame_bytes{0};
+        std::atomic<int> memory_level{0};
+        bool decode_eof = false;
     };
 
 } // namespace video
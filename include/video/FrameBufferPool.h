@@ -0,0 +1,32 @@
+//
+// Created by WeiChuandong on 2025/3/25.
+//
+
+#ifndef VIDEOPLAYER_FRAMEBUFFERPOOL_H
+#define VIDEOPLAYER_FRAMEBUFFERPOOL_H
+
+extern "C" {
+#include <libavutil/buffer.h>
+#include <libavutil/pixfmt.h>
+}
+
+#include <cstddef>
+
+namespace video {
+
+    // 解码帧缓冲来源，由解码器的 get_buffer2 使用
+    // 实现需保证可在解码线程（以及 FFmpeg 帧线程）上并发调用
+    class FrameBufferPool {
+    public:
+        virtual ~FrameBufferPool() = default;
+
+        // 是否为该像素格式提供缓冲
+        virtual bool supports(AVPixelFormat format) const = 0;
+
+        // 申请至少 size 字节的缓冲，暂无可用缓冲时返回 nullptr，由解码器回退到默认分配
+        virtual AVBufferRef* acquire(size_t size) = 0;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_FRAMEBUFFERPOOL_H
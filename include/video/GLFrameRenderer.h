@@ -0,0 +1,124 @@
+//
+// Created by Weichuandong on 2025/3/29.
+//
+
+#ifndef VIDEOPLAYER_GLFRAMERENDERER_H
+#define VIDEOPLAYER_GLFRAMERENDERER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include "video/GLFrameUploader.h"
+#include "video/GlyphAtlas.h"
+#include "video/GLOverlay.h"
+#include "video/PresentScheduler.h"
+#include "video/ScalerPolicy.h"
+#include "video/RenderTypes.h"
+#include "logger.h"
+
+namespace video {
+
+    // 视频帧与 UI 叠加层的绘制，只依赖当前线程上已就绪的 GL 3.3 上下文
+    // 窗口（GLRenderer）和离屏（OffscreenRenderer）后端共用，保证两者输出一致
+    class GLFrameRenderer {
+    public:
+        // 需在 GL 上下文所在线程构造和析构
+        GLFrameRenderer();
+        ~GLFrameRenderer();
+
+        // 绘制视频帧到当前绑定的帧缓冲（视口 view_w x view_h 像素）；frame 为 nullptr 时重绘上一帧
+        void render_frame(const AVFrame* frame, int view_w, int view_h);
+        // 拼接模式：frames 按 columns 列排布到各自的分块，nullptr 表示该分块重绘上一帧
+        void render_tiles(const std::vector<AVFrame*>& frames, int columns, int view_w, int view_h);
+        // 在 w x h 的视口上叠加进度条、时间和统计文本，pacing 为空时不显示显示节奏
+        void render_ui(const OverlayState& state, int w, int h, const PacingStats* pacing = nullptr);
+
+        // 左上角显示纹理上传统计
+        void set_show_stats(bool show) { show_stats = show; }
+        bool is_showing_stats() const { return show_stats; }
+
+        // 缩放方式，可在任意线程设置，下一帧生效
+        void set_scaler(ScaleFilter filter, bool allow_prescale) {
+            requested_filter = filter;
+            prescale_enabled = allow_prescale;
+        }
+        ScaleFilter scaler() const { return requested_filter; }
+        // 帧预算（毫秒），自动选择缩放方式时参考，<=0 表示不限
+        void set_frame_budget(double ms) { frame_budget_ms = ms; }
+
+        // 解码暂存缓冲，不支持时为 nullptr
+        GLStagingPool* staging_pool() const { return staging.get(); }
+        const UploadStats& upload_stats() const { return uploader->stats(); }
+
+    private:
+        void compile_shaders();
+        void draw_video(const GLFrameUploader& source, const ScalerChoice& choice);
+        // 读取已完成的 GPU 计时查询
+        void poll_gpu_timer();
+        bool begin_gpu_timer();
+        void end_gpu_timer(bool timing);
+        void init_ui_resources();
+        std::string format_time(double seconds);
+
+        // 每种卷积核 x 平面布局一个着色器变体
+        static constexpr int KernelCount = 3;   // 线性（含 mipmap）、双三次、Lanczos
+        static int kernel_index(ScaleFilter filter);
+
+        struct VideoProgram {
+            GLuint program = 0;
+            GLint scale_loc = -1;
+            GLint xform_loc = -1;
+            GLint limit_loc = -1;
+        };
+        VideoProgram video_programs[KernelCount][static_cast<int>(ShaderLayout::Count)];
+        std::unique_ptr<GLFrameUploader> uploader;
+        std::unique_ptr<GLStagingPool> staging;
+        GLuint vao = 0, vbo = 0;
+        bool has_video = false;
+        std::atomic<bool> show_stats{false};
+
+        // 缩放方式选择
+        std::atomic<ScaleFilter> requested_filter{ScaleFilter::Auto};
+        std::atomic<bool> prescale_enabled{true};
+        std::atomic<double> frame_budget_ms{0.0};
+        ScalerPolicy scaler_policy;
+        ScalerChoice drawn;
+
+        // 拼接模式的分块，首次使用时创建
+        struct Tile {
+            std::unique_ptr<GLFrameUploader> uploader;
+            ScalerPolicy policy;
+            ScalerChoice drawn;
+            bool has_video = false;
+        };
+        std::vector<std::unique_ptr<Tile>> tiles;
+
+        // GPU 耗时：环形计时查询，只读取已完成的结果，不会阻塞
+        static constexpr int TimerQueries = 3;
+        GLuint timer_queries[TimerQueries] = {0, 0, 0};
+        bool timer_pending[TimerQueries] = {false, false, false};
+        int timer_index = 0;
+        double gpu_ms = 0.0;
+
+        // 进度条参数
+        struct {
+            float height = ProgressBarHeight;
+            glm::vec4 background_color {0.2f, 0.2f, 0.2f, 0.7f};
+            glm::vec4 progress_color {0.86f, 0.12f, 0.12f, 1.0f};
+        } progress_style;
+
+        // UI 叠加层：字形图集 + 批量绘制
+        std::unique_ptr<GlyphAtlas> text_atlas;
+        std::unique_ptr<GLOverlay> overlay;
+        std::string stats_text;
+        std::string memory_text;        // 各子系统内存占用，统计文本的第二行
+        std::chrono::steady_clock::time_point stats_updated;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_GLFRAMERENDERER_H
@@ -0,0 +1,153 @@
+//
+// Created by Weichuandong on 2025/3/24.
+//
+
+#ifndef VIDEOPLAYER_GLFRAMEUPLOADER_H
+#define VIDEOPLAYER_GLFRAMEUPLOADER_H
+
+#include <GL/glew.h>
+#include <atomic>
+#include "video/GLPixelFormat.h"
+#include "video/GLStagingPool.h"
+#include "video/MemoryBudget.h"
+#include "logger.h"
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+namespace video {
+
+    // 上传统计，用于性能观察
+    struct UploadStats {
+        double upload_ms = 0.0;     // 最近一帧上传的 CPU 耗时
+        bool pbo = false;           // 是否走 PBO 异步路径
+        int gl_calls = 0;           // 最近一帧上传发出的 GL 调用数
+        int tex_uploads = 0;        // 其中 glTexSubImage2D 的次数
+        bool zero_copy = false;     // 直接从解码暂存缓冲上传，无 CPU 拷贝
+    };
+
+    // 将解码帧按原始像素布局上传为 GL 纹理（每个平面一张纹理）
+    // 纹理存储只在尺寸/格式变化时分配一次，数据经 PBO 环形缓冲异步上传，
+    // 纹理采用双缓冲：上传下一帧时不会与仍在绘制的上一帧纹理冲突
+    // 内存超出预算时释放 PBO，改为直接从客户端内存上传
+    class GLFrameUploader : public MemoryConsumer {
+    public:
+        static constexpr int MaxPlanes = 3;
+        static constexpr int TextureSets = 2;
+        static constexpr int PboCount = 3;
+
+        GLFrameUploader();
+        ~GLFrameUploader() override;
+
+        // 纹理与 PBO 占用的显存
+        size_t memory_usage() const override { return gpu_bytes; }
+        void on_memory_pressure(int level) override { memory_level = level; }
+
+        // 上传一帧，需在 GL 上下文所在线程调用
+        bool upload(const AVFrame* frame);
+
+        // 解码暂存缓冲：帧数据位于其中时直接从该缓冲上传
+        void set_staging_pool(GLStagingPool* pool) { staging = pool; }
+
+        // 无需 CPU 转换即可上传的像素格式
+        static bool is_native_format(int format);
+
+        // 为纹理生成 mipmap 链，用于大比例缩小时的三线性过滤；切换时重建纹理存储
+        void set_mipmaps(bool enable) { mipmaps = enable; }
+        // 上传前在 CPU 上 2x2 盒式缩小 shift 次（仅 8bit 平面格式，其余格式忽略）
+        void set_prescale(int shift) { prescale_shift = shift; }
+        // 最近一帧实际使用的预缩小次数
+        int prescaled() const { return applied_prescale; }
+
+        // 将最近上传的各平面纹理绑定到 GL_TEXTURE0 起始的纹理单元
+        void bind() const;
+
+        ShaderLayout layout() const { return current_layout; }
+        float sample_scale() const { return current_scale; }
+
+        // 各平面纹理坐标变换 (scale.xy, offset.xy)，用于裁剪行尾 padding 和负跨度翻转
+        const float* plane_transforms() const { return &plane_xforms[0][0]; }
+        // 各平面 u 坐标上限，避免线性过滤采样到 padding
+        const float* plane_u_limits() const { return plane_limits; }
+        const UploadStats& stats() const { return upload_stats; }
+
+    private:
+        struct PlaneUpload {
+            const uint8_t* data;
+            int width;
+            int height;
+            int stride;
+            GLPlaneFormat format;
+        };
+
+        // 纹理存储描述，变化时重新分配
+        struct TextureStorage {
+            GLuint texture = 0;
+            int width = 0;
+            int height = 0;
+            GLint internalFormat = 0;
+            bool mipmapped = false;
+            size_t bytes = 0;
+        };
+
+        // 平面在内存中的布局及对应的上传方式
+        struct PlaneLayout {
+            const uint8_t* base = nullptr;  // 平面最低地址
+            size_t bytes = 0;               // 从 base 起需要拷贝的字节数
+            int row_length = 0;             // GL_UNPACK_ROW_LENGTH（像素）
+            int tex_width = 0;              // 纹理宽度，可能包含 padding
+            bool contiguous = true;         // 跨度是像素大小的整数倍，可整块上传
+            bool flipped = false;           // 负跨度，需要在着色器中翻转
+        };
+
+        template <AVPixelFormat Format>
+        void upload_frame(const AVFrame* frame);
+
+        static PlaneLayout plan_plane(const PlaneUpload& plane, bool allow_padding);
+        void upload_planes(const PlaneUpload* planes, int count);
+        void ensure_storage(TextureStorage& storage, const PlaneUpload& plane, int tex_width);
+        bool upload_from_staging(const PlaneUpload* planes, const PlaneLayout* layouts, int count);
+        bool upload_via_pbo(const PlaneUpload* planes, const PlaneLayout* layouts, int count);
+        void upload_direct(const PlaneUpload* planes, const PlaneLayout* layouts, int count);
+        void release_pbos();
+        void update_memory_usage();
+
+        // 不支持的像素格式回退到 CPU 转换为 YUV420P
+        const AVFrame* convert_fallback(const AVFrame* frame);
+        // 8bit 平面格式逐级减半，返回 nullptr 表示不适用
+        const AVFrame* prescale(const AVFrame* frame, int shift);
+
+        TextureStorage storages[TextureSets][MaxPlanes];
+        int current_set = 0;
+        bool immutable_storage = false;
+
+        GLuint pbos[PboCount] = {0, 0, 0};
+        size_t pbo_sizes[PboCount] = {0, 0, 0};
+        int current_pbo = 0;
+
+        std::atomic<size_t> gpu_bytes{0};
+        std::atomic<int> memory_level{0};
+
+        GLStagingPool* staging = nullptr;
+
+        ShaderLayout current_layout = ShaderLayout::Planar;
+        float current_scale = 1.0f;
+        float plane_xforms[MaxPlanes][4] = {{1, 1, 0, 0}, {1, 1, 0, 0}, {1, 1, 0, 0}};
+        float plane_limits[MaxPlanes] = {1, 1, 1};
+        UploadStats upload_stats;
+
+        bool mipmaps = false;
+        int prescale_shift = 0;
+        int applied_prescale = 0;
+        AVFrame* prescale_frames[2] = {nullptr, nullptr};
+
+        SwsContext* fallback_sws = nullptr;
+        AVFrame* fallback_frame = nullptr;
+        int warned_format = AV_PIX_FMT_NONE;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_GLFRAMEUPLOADER_H
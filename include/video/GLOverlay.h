@@ -0,0 +1,78 @@
+//
+// Created by WeiChuandong on 2025/3/26.
+//
+
+#ifndef VIDEOPLAYER_GLOVERLAY_H
+#define VIDEOPLAYER_GLOVERLAY_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+#include "video/GlyphAtlas.h"
+
+namespace video {
+
+    // UI 叠加层：矩形和文字共用字形图集纹理，所有四边形写入同一个流式顶点缓冲，一次绘制
+    // 绘制结果缓存在离屏纹理中，只有顶点内容变化时才重绘，否则每帧只合成一个全屏三角形
+    class GLOverlay {
+    public:
+        // atlas 为 nullptr 时只绘制矩形
+        explicit GLOverlay(GlyphAtlas* atlas);
+        ~GLOverlay();
+
+        // 开始记录一帧 UI，坐标以窗口左上角为原点
+        void begin(int width, int height);
+        void add_rect(float x, float y, float w, float h, const glm::vec4& color);
+        // 返回文本宽度
+        float add_text(const std::string& text, float x, float y, const glm::vec4& color);
+
+        // 内容变化时重绘缓存纹理，然后合成到当前帧缓冲
+        void draw();
+
+        // 缓存纹理的重绘次数（用于观察 UI 开销）
+        int redraw_count() const { return redraws; }
+
+    private:
+        struct Vertex {
+            float x, y;
+            float u, v;
+            float r, g, b, a;
+        };
+
+        void push_quad(float x0, float y0, float x1, float y1,
+                       float u0, float v0, float u1, float v1, const glm::vec4& color);
+        void ensure_target(int w, int h);
+        void upload_atlas();
+        void redraw();
+
+        GlyphAtlas* atlas = nullptr;
+        std::vector<GlyphQuad> quads;
+        std::vector<Vertex> vertices;
+        std::vector<Vertex> drawn_vertices;     // 缓存纹理中当前内容对应的顶点
+        int width = 0;
+        int height = 0;
+
+        // 批量绘制
+        GLuint batch_program = 0;
+        GLint projection_loc = -1;
+        GLuint vao = 0;
+        GLuint vbo = 0;
+        size_t vbo_capacity = 0;
+        GLuint atlas_texture = 0;
+
+        // 缓存纹理及合成
+        GLuint fbo = 0;
+        GLuint target_texture = 0;
+        int target_width = 0;
+        int target_height = 0;
+        bool target_valid = false;
+        GLuint blit_program = 0;
+        GLuint blit_vao = 0;
+
+        int redraws = 0;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_GLOVERLAY_H
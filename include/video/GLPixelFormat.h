@@ -0,0 +1,135 @@
+//
+// Created by Weichuandong on 2025/3/24.
+//
+
+#ifndef VIDEOPLAYER_GLPIXELFORMAT_H
+#define VIDEOPLAYER_GLPIXELFORMAT_H
+
+#include <GL/glew.h>
+
+extern "C" {
+#include <libavutil/pixfmt.h>
+}
+
+namespace video {
+
+    // 着色器变体：决定片段着色器如何从纹理中取出 Y/U/V
+    enum class ShaderLayout {
+        Planar = 0,     // Y、U、V 三个单通道纹理
+        SemiPlanar,     // Y 单通道 + UV 双通道交错纹理（NV12/P010）
+        Gray,           // 只有 Y
+        Count
+    };
+
+    // 单个平面对应的纹理格式
+    struct GLPlaneFormat {
+        GLint internalFormat;
+        GLenum format;
+        GLenum type;
+        int bytesPerPixel;
+    };
+
+    // 各种平面布局的公共定义
+    struct Planar8Layout {
+        static constexpr ShaderLayout layout = ShaderLayout::Planar;
+        static constexpr int planeCount = 3;
+        static constexpr GLPlaneFormat luma {GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1};
+        static constexpr GLPlaneFormat chroma {GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1};
+        static constexpr float sampleScale = 1.0f;
+    };
+
+    struct Planar10Layout {
+        static constexpr ShaderLayout layout = ShaderLayout::Planar;
+        static constexpr int planeCount = 3;
+        static constexpr GLPlaneFormat luma {GL_R16, GL_RED, GL_UNSIGNED_SHORT, 2};
+        static constexpr GLPlaneFormat chroma {GL_R16, GL_RED, GL_UNSIGNED_SHORT, 2};
+        // 10bit 数据存放在 16bit 的低位，需要放大到 [0,1]
+        static constexpr float sampleScale = 65535.0f / 1023.0f;
+    };
+
+    struct SemiPlanar8Layout {
+        static constexpr ShaderLayout layout = ShaderLayout::SemiPlanar;
+        static constexpr int planeCount = 2;
+        static constexpr GLPlaneFormat luma {GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1};
+        static constexpr GLPlaneFormat chroma {GL_RG8, GL_RG, GL_UNSIGNED_BYTE, 2};
+        static constexpr float sampleScale = 1.0f;
+    };
+
+    struct SemiPlanar16Layout {
+        static constexpr ShaderLayout layout = ShaderLayout::SemiPlanar;
+        static constexpr int planeCount = 2;
+        static constexpr GLPlaneFormat luma {GL_R16, GL_RED, GL_UNSIGNED_SHORT, 2};
+        static constexpr GLPlaneFormat chroma {GL_RG16, GL_RG, GL_UNSIGNED_SHORT, 4};
+        // P010 数据高位对齐，直接归一化即可
+        static constexpr float sampleScale = 1.0f;
+    };
+
+    struct Gray8Layout {
+        static constexpr ShaderLayout layout = ShaderLayout::Gray;
+        static constexpr int planeCount = 1;
+        static constexpr GLPlaneFormat luma {GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1};
+        static constexpr GLPlaneFormat chroma {GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1};
+        static constexpr float sampleScale = 1.0f;
+    };
+
+    // 像素格式特征：平面布局 + 色度下采样
+    template <AVPixelFormat Format>
+    struct GLPixelFormatTraits;
+
+    template <>
+    struct GLPixelFormatTraits<AV_PIX_FMT_YUV420P> : Planar8Layout {
+        static constexpr int chromaShiftW = 1;
+        static constexpr int chromaShiftH = 1;
+    };
+
+    template <>
+    struct GLPixelFormatTraits<AV_PIX_FMT_YUV422P> : Planar8Layout {
+        static constexpr int chromaShiftW = 1;
+        static constexpr int chromaShiftH = 0;
+    };
+
+    template <>
+    struct GLPixelFormatTraits<AV_PIX_FMT_YUV444P> : Planar8Layout {
+        static constexpr int chromaShiftW = 0;
+        static constexpr int chromaShiftH = 0;
+    };
+
+    template <>
+    struct GLPixelFormatTraits<AV_PIX_FMT_YUV420P10LE> : Planar10Layout {
+        static constexpr int chromaShiftW = 1;
+        static constexpr int chromaShiftH = 1;
+    };
+
+    template <>
+    struct GLPixelFormatTraits<AV_PIX_FMT_YUV422P10LE> : Planar10Layout {
+        static constexpr int chromaShiftW = 1;
+        static constexpr int chromaShiftH = 0;
+    };
+
+    template <>
+    struct GLPixelFormatTraits<AV_PIX_FMT_YUV444P10LE> : Planar10Layout {
+        static constexpr int chromaShiftW = 0;
+        static constexpr int chromaShiftH = 0;
+    };
+
+    template <>
+    struct GLPixelFormatTraits<AV_PIX_FMT_NV12> : SemiPlanar8Layout {
+        static constexpr int chromaShiftW = 1;
+        static constexpr int chromaShiftH = 1;
+    };
+
+    template <>
+    struct GLPixelFormatTraits<AV_PIX_FMT_P010LE> : SemiPlanar16Layout {
+        static constexpr int chromaShiftW = 1;
+        static constexpr int chromaShiftH = 1;
+    };
+
+    template <>
+    struct GLPixelFormatTraits<AV_PIX_FMT_GRAY8> : Gray8Layout {
+        static constexpr int chromaShiftW = 0;
+        static constexpr int chromaShiftH = 0;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_GLPIXELFORMAT_H
@@ -8,89 +8,82 @@
 #pragma once
 #include <GL/glew.h>
 #include <SDL2/SDL.h>
-#include <SDL_ttf.h>
 #include <functional>
 #include <glm/glm.hpp>
 #include <glm/ext/matrix_clip_space.hpp>
+#include <memory>
+#include <thread>
+#include <future>
+#include <atomic>
+#include <mutex>
+#include "video/VideoRenderer.h"
+#include "video/GLFrameRenderer.h"
+#include "video/ScreenRecorder.h"
 #include "logger.h"
 
 namespace video {
 
-    class GLRenderer {
+    // 窗口与事件在创建它的（主）线程处理，GL 上下文由内部渲染线程独占
+    // 解码线程通过显示队列提交帧，交换缓冲不会阻塞解码
+    // 帧按原始像素格式上传并绘制（YUV420P/422P/444P、10bit、NV12、P010、GRAY8）
+    class GLRenderer : public VideoRenderer {
     public:
-        GLRenderer(int width, int height);
-        ~GLRenderer();
+        GLRenderer(int width, int height, SwapMode swap_mode = SwapMode::VSync);
+        ~GLRenderer() override;
 
-        void render_frame(const uint8_t* y_plane, const uint8_t* u_plane, const uint8_t* v_plane,
-                          int y_width, int y_height, int uv_width, int uv_height);
-        bool handle_events();
+        bool handle_events() override;
 
-        using EventCallback = std::function<void(SDL_KeyCode)>;
-        void setEventCallback(const EventCallback& callback);
+        // 左上角显示纹理上传统计
+        void set_show_stats(bool show) override { frame_renderer->set_show_stats(show); }
+        bool is_showing_stats() const override { return frame_renderer->is_showing_stats(); }
 
-        using SeekCallback = std::function<void(float)>;
-        void setSeekCallback(const SeekCallback& callback);
+        // 录制屏幕画面到文件，在渲染线程的下一次绘制时生效；重复调用会先结束当前录制
+        void start_recording(const RecordOptions& options) override;
+        void stop_recording() override;
+        bool is_recording() const override { return recording; }
+        int recordings_started() const override { return started_recordings; }
 
-        using FrameStepCallback = std::function<void(bool)>;
-        void setFrameStepCallback(const FrameStepCallback& callback);
-        // 添加获取暂停状态的回调
-        using IsPausedCallback = std::function<bool()>;
-        void setIsPausedCallback(const IsPausedCallback& callback);
+        // 视频缩放方式，下一帧生效
+        void set_scaler(ScaleFilter filter, bool allow_prescale) override { frame_renderer->set_scaler(filter, allow_prescale); }
+        ScaleFilter scaler() const override { return frame_renderer->scaler(); }
+
+        // 解码暂存缓冲，不支持时为 nullptr
+        GLStagingPool* staging_pool() const { return frame_renderer->staging_pool(); }
+        FrameBufferPool* frame_buffer_pool() const override { return staging_pool(); }
+
+    protected:
+        // record 为 false 的重复刷新不写入录制（输出为可变帧率）
+        void draw(const AVFrame* frame, const OverlayState& state, bool record) override;
+        void draw_tiles(const std::vector<AVFrame*>& frames, int columns, const OverlayState& state) override;
+        void on_window_resized(int w, int h) override;
 
-        void render_ui(float progress, double current_time, double total_time,
-                       bool is_paused, bool show_debug);
     private:
-        void init_gl();
-        void compile_shaders();
-        void create_textures();
+        // 渲染线程：独占 GL 上下文，从显示队列取帧绘制并交换缓冲
+        void render_loop(std::promise<void>& ready);
+        // 应用 start_recording/stop_recording 的请求，仅在渲染线程调用
+        void apply_recording_request();
+        // 交换缓冲，录制时在交换前后捕获画面
+        void swap_buffers(int drawable_w, int drawable_h, bool record);
 
-        // 进度条
-        void init_ui_resources();
-        void create_ui_shaders();
-        void render_progress_bar(float progress);
+        SDL_GLContext gl_context = nullptr;
 
-        // 进度时间文本
-        void init_text_renderer();
-        std::string format_time(double seconds);
-        void render_text(const std::string& text, float x, float y, const glm::vec4& color);
+        // 视频与 UI 绘制，在渲染线程创建和销毁
+        std::unique_ptr<GLFrameRenderer> frame_renderer;
 
-        // 窗口大小调整
-        void update_projection(int width, int height);
+        // 录制：请求由任意线程提交，录制器在渲染线程创建与销毁
+        std::mutex record_mutex;
+        bool record_request_pending = false;
+        std::unique_ptr<RecordOptions> record_request;  // 为空表示停止录制
+        std::unique_ptr<ScreenRecorder> recorder;
+        std::atomic<bool> recording{false};
+        std::atomic<int> started_recordings{0};
 
-        SDL_Window* window = nullptr;
-        SDL_GLContext gl_context = nullptr;
+        std::thread render_thread;
 
-        GLuint program = 0;
-        GLuint y_tex = 0, u_tex = 0, v_tex = 0;
-        GLuint vao = 0, vbo = 0;
-
-        EventCallback eventCallback;
-        SeekCallback seekCallback;
-        FrameStepCallback frameStepCallback;
-        IsPausedCallback isPausedCallback;
-
-        // ui渲染相关资源
-        GLuint ui_vao = 0;
-        GLuint ui_vbo = 0;
-        GLuint ui_program = 0;
-
-        // 进度条参数
-        struct {
-            float height = 8.0f;
-            glm::vec4 background_color {0.2f, 0.2f, 0.2f, 0.7f};
-            glm::vec4 progress_color {0.86f, 0.12f, 0.12f, 1.0f};
-        } progress_style;
-
-        // 文本渲染相关
-        TTF_Font* font = nullptr;
-        GLuint text_texture = 0;
-        GLuint text_vao = 0;
-        GLuint text_vbo = 0;
-        GLuint text_program = 0;
-
-
-        // 用于调试的彩色矩形渲染方法
-        void render_colored_rect(float x, float y, float width, float height, const glm::vec4& color);
+        // 事件线程记录的新窗口尺寸，由渲染线程应用
+        std::atomic<bool> viewport_dirty{false};
+        std::atomic<int> viewport_width{0};
+        std::atomic<int> viewport_height{0};
     };
 
 
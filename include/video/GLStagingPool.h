@@ -0,0 +1,70 @@
+//
+// Created by WeiChuandong on 2025/3/25.
+//
+
+#ifndef VIDEOPLAYER_GLSTAGINGPOOL_H
+#define VIDEOPLAYER_GLSTAGINGPOOL_H
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "video/FrameBufferPool.h"
+#include "video/MemoryBudget.h"
+#include "logger.h"
+
+namespace video {
+
+    // 持久映射的 GL 像素缓冲，切分为固定大小的槽位直接交给解码器写入
+    // 解码结果已位于上传暂存内存中，上传时直接从该缓冲 glTexSubImage2D，省去一次整帧拷贝
+    // 槽位在帧缓冲释放且 GPU 读取完成（fence）后才会被复用
+    class GLStagingPool : public FrameBufferPool, public MemoryConsumer {
+    public:
+        // 需覆盖解码器参考帧 + 帧线程 + 显示中的帧
+        static constexpr int DefaultSlots = 24;
+
+        // 需在 GL 线程创建与销毁；销毁前所有帧缓冲必须已释放（先销毁解码器）
+        explicit GLStagingPool(int slot_count = DefaultSlots);
+        ~GLStagingPool() override;
+
+        // 当前上下文是否支持持久映射（ARB_buffer_storage）
+        static bool is_available();
+
+        size_t memory_usage() const override { return storage_bytes; }
+
+        bool supports(AVPixelFormat format) const override;
+        AVBufferRef* acquire(size_t size) override;
+
+        // 以下仅在 GL 线程调用
+        // 回收 GPU 已读取完毕的槽位；帧尺寸变大时在槽位全部空闲后重新分配存储
+        void recycle();
+        // ptr 是否位于暂存缓冲内，是则给出相对缓冲起始的偏移
+        bool offset_of(const uint8_t* ptr, size_t& offset) const;
+        // 记录对 ptr 所在槽位的读取，GPU 完成前该槽位不会被复用
+        void fence(const uint8_t* ptr);
+        GLuint buffer() const { return gl_buffer; }
+
+    private:
+        struct Slot {
+            bool referenced = false;    // 仍被某个 AVFrame 引用
+            GLsync fence = nullptr;     // GPU 尚未完成的读取
+        };
+
+        static void release_buffer(void* opaque, uint8_t* data);
+        bool reallocate(size_t size);
+        void free_storage();
+
+        std::mutex mutex;
+        std::vector<Slot> slots;
+        GLuint gl_buffer = 0;
+        uint8_t* mapped = nullptr;
+        size_t slot_size = 0;
+        std::atomic<size_t> storage_bytes{0};
+        size_t requested_size = 0;      // 解码器请求过的最大尺寸
+        bool disabled = false;          // 分配失败后不再尝试
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_GLSTAGINGPOOL_H
@@ -0,0 +1,80 @@
+//
+// Created by WeiChuandong on 2025/3/26.
+//
+
+#ifndef VIDEOPLAYER_GLYPHATLAS_H
+#define VIDEOPLAYER_GLYPHATLAS_H
+
+#include <SDL2/SDL_ttf.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "video/MemoryBudget.h"
+
+namespace video {
+
+    // 一个字形在屏幕上的矩形及其在图集中的纹理坐标（左上角为原点，y 向下）
+    struct GlyphQuad {
+        float x0, y0, x1, y1;
+        float u0, v0, u1, v1;
+    };
+
+    // 字形图集：每个字形只光栅化一次，存入一张 RGBA 图集（RGB 恒为白色，alpha 为覆盖率）
+    // 与具体渲染后端无关，GLRenderer 和 SDLRenderer 各自把图集上传为纹理后按四边形批量绘制
+    // 图集的 CPU 副本登记到内存预算（只统计，大小固定）
+    class GlyphAtlas : public MemoryConsumer {
+    public:
+        static constexpr int AtlasSize = 512;
+
+        GlyphAtlas(const char* font_path, int font_size);
+        ~GlyphAtlas() override;
+
+        size_t memory_usage() const override { return atlas.size(); }
+
+        GlyphAtlas(const GlyphAtlas&) = delete;
+        GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+        // 排版 UTF-8 文本，(x, y) 为左上角，四边形追加到 quads，返回文本宽度
+        float layout(const std::string& text, float x, float y, std::vector<GlyphQuad>& quads);
+        int line_height() const { return font_height; }
+
+        // 不透明白色像素的纹理坐标，用于绘制纯色矩形
+        static constexpr float WhiteU = 0.5f / AtlasSize;
+        static constexpr float WhiteV = 0.5f / AtlasSize;
+
+        // 图集像素（RGBA32，行跨度 AtlasSize * 4）
+        const uint8_t* pixels() const { return atlas.data(); }
+
+        // 取出自上次调用以来新写入字形的行范围 [y0, y1)，没有变化返回 false
+        bool take_dirty_rows(int& y0, int& y1);
+
+    private:
+        struct Glyph {
+            float u0 = 0, v0 = 0, u1 = 0, v1 = 0;
+            int width = 0;
+            int height = 0;
+            int advance = 0;
+            bool drawable = false;  // 空格等没有像素的字形只前进
+        };
+
+        const Glyph& glyph(uint16_t codepoint);
+        Glyph rasterize(uint16_t codepoint);
+
+        TTF_Font* font = nullptr;
+        int font_height = 0;
+        std::vector<uint8_t> atlas;
+        std::unordered_map<uint16_t, Glyph> glyphs;
+
+        // 按行（shelf）从左到右放置字形
+        int pen_x = 1;
+        int pen_y = 1;
+        int shelf_height = 0;
+
+        int dirty_y0 = AtlasSize;
+        int dirty_y1 = 0;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_GLYPHATLAS_H
@@ -0,0 +1,71 @@
+//
+// Created by Weichuandong on 2025/3/29.
+//
+
+#ifndef VIDEOPLAYER_HEADLESSRUNNER_H
+#define VIDEOPLAYER_HEADLESSRUNNER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include <memory>
+#include <cstdint>
+#include "video/FFmpegDecoder.h"
+#include "video/OffscreenRenderer.h"
+#include "logger.h"
+
+namespace video {
+
+    struct HeadlessOptions {
+        std::string input;
+        std::vector<std::string> filters;   // 与交互播放相同的滤镜名
+        int filterThreads = 0;
+        int width = 0;                      // 渲染尺寸，0 表示使用视频尺寸
+        int height = 0;
+        int maxFrames = 0;                  // >0 时只渲染前 N 帧
+        bool drawUi = true;                 // 是否叠加进度条和时间文本
+        bool asyncReadback = true;          // PBO 异步读回
+        bool zeroCopyDecode = true;
+        ScaleFilter scaleFilter = ScaleFilter::Auto;
+        bool prescale = true;
+        std::string dumpDir;                // 非空时把读回的帧写成 PPM
+        std::string goldenDir;              // 非空时与该目录中的同名 PPM 逐像素比较
+        int goldenTolerance = 0;            // 每个通道允许的误差（不同 GPU 的舍入差异），0 表示逐字节一致
+        int dumpEvery = 1;                  // 每 N 帧读回一次
+    };
+
+    // 无窗口运行完整渲染路径（上传、着色器、UI），用于基准测试和滤镜的逐像素回归测试
+    class HeadlessRunner {
+    public:
+        explicit HeadlessRunner(const HeadlessOptions& options);
+        ~HeadlessRunner();
+
+        // 全部帧渲染完成且没有与基准图不一致时返回 true；
+        // 比较基准图时还要求至少读回一帧，且目录中的每张基准图都有对应的渲染帧
+        bool run();
+
+    private:
+        // 取出已完成的读回并写文件/比较，drain 为 true 时等待全部在途读回
+        void collect_readbacks(bool drain);
+        bool handle_pixels(int64_t index, const std::vector<uint8_t>& rgba);
+        std::string frame_name(int64_t index) const;
+
+        HeadlessOptions options;
+        std::unique_ptr<FFmpegDecoder> decoder;
+        std::unique_ptr<OffscreenRenderer> renderer;
+
+        std::deque<int64_t> readback_frames;    // 在途读回对应的帧序号，按提交顺序
+        std::vector<uint8_t> pixels;
+        int64_t frames_rendered = 0;
+        int64_t frames_read = 0;
+        int64_t golden_mismatches = 0;
+        int64_t golden_missing = 0;
+        std::set<std::string> golden_compared;  // 已参与比较的基准图文件名
+        double upload_ms_total = 0.0;
+        double readback_ms_total = 0.0;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_HEADLESSRUNNER_H
@@ -0,0 +1,58 @@
+//
+// Created by Weichuandong on 2025/4/4.
+//
+
+#ifndef VIDEOPLAYER_LIVELATENCYPOLICY_H
+#define VIDEOPLAYER_LIVELATENCYPOLICY_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace video {
+
+    // udp/rtp/rtsp/srt 等实时源
+    bool is_live_url(const std::string& url);
+
+    // 直播延迟控制
+    // 数据包到达时刻减去其时间戳的最小值作为基准（网络最快送达的情况），
+    // 帧显示时的延迟 = 当前时刻 - 时间戳 - 基准 + 显示队列中排在它前面的时长，
+    // 即播放器在最快送达之外额外积累的缓冲。延迟略高于目标时小幅加速播放，
+    // 远超目标（卡顿后积压）时直接丢帧追到目标附近
+    class LiveLatencyPolicy {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit LiveLatencyPolicy(double target_seconds = 0.3);
+
+        // 每读到一个视频数据包调用，pts 为秒；时间戳不连续时重新估计基准
+        void on_packet(double pts);
+        // 帧提交显示前调用，queued_seconds 为显示队列中已有的内容时长；
+        // 返回 false 表示延迟过大，该帧应丢弃
+        bool update(double pts, double queued_seconds);
+
+        double latency() const { return current_latency; }  // 秒，<0 表示尚未测量
+        double target() const { return target_latency; }
+        double speed() const;                               // 追赶时的播放速度
+        int64_t dropped() const { return dropped_frames; }
+
+    private:
+        double seconds(Clock::time_point t) const { return std::chrono::duration<double>(t - epoch).count(); }
+
+        double target_latency;
+        Clock::time_point epoch = Clock::now();
+
+        bool has_baseline = false;
+        double baseline = 0.0;          // 到达时刻 - pts 的最小值（秒），缓慢上调以跟随时钟漂移
+        double last_packet_pts = 0.0;
+        double last_packet_time = 0.0;
+
+        double current_latency = -1.0;
+        double smoothed_latency = -1.0;
+        int level = 0;                  // 追赶档位
+        int64_t dropped_frames = 0;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_LIVELATENCYPOLICY_H
@@ -0,0 +1,82 @@
+//
+// Created by Weichuandong on 2025/4/3.
+//
+
+#ifndef VIDEOPLAYER_MEMORYBUDGET_H
+#define VIDEOPLAYER_MEMORYBUDGET_H
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct AVFrame;
+
+namespace video {
+
+    // 帧引用的缓冲总字节数
+    size_t frame_memory(const AVFrame* frame);
+
+    // 向内存预算登记的子系统（帧队列、缓存、滤镜图、纹理池等）
+    class MemoryConsumer {
+    public:
+        virtual ~MemoryConsumer() = default;
+
+        // 当前占用的字节数，可能在任意线程调用，实现需线程安全且开销很小
+        virtual size_t memory_usage() const = 0;
+
+        // 内存压力等级变化：0 正常，1 接近预算，2 超出预算
+        // 在预算服务的锁内调用，实现不能阻塞、不能回调预算服务；通常只记录等级，在自己的线程中生效
+        virtual void on_memory_pressure(int level) { (void)level; }
+    };
+
+    // 进程内的内存统计与全局预算
+    // 各子系统构造时 add、析构时最先 remove；update() 汇总占用，超出预算时通知各子系统
+    // 缩小队列深度、丢弃缓存，回落后恢复。预算为 0 时只统计不限制
+    class MemoryBudget {
+    public:
+        static constexpr int PressureLevels = 3;
+
+        struct Usage {
+            std::string name;
+            size_t bytes = 0;
+        };
+
+        static MemoryBudget& shared();
+
+        void set_limit(size_t bytes);
+        size_t limit() const;
+
+        // 同名的子系统（如拼接模式下的多路纹理）合并统计
+        void add(MemoryConsumer* consumer, const std::string& name);
+        void remove(MemoryConsumer* consumer);
+
+        // 汇总占用并更新压力等级，可频繁调用，内部每 100ms 最多统计一次
+        void update();
+        int pressure() const;
+
+        // 按名称合并的占用，按字节数从大到小
+        std::vector<Usage> usage() const;
+        // 统计信息文本，如 "mem 310/512 MB  staging 190  textures 95"
+        std::string summary() const;
+
+    private:
+        struct Entry {
+            MemoryConsumer* consumer;
+            std::string name;
+        };
+
+        MemoryBudget() = default;
+        size_t total_locked() const;
+
+        mutable std::mutex mutex;
+        std::vector<Entry> entries;
+        size_t limit_bytes = 0;
+        int level = 0;
+        std::chrono::steady_clock::time_point last_update{};
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_MEMORYBUDGET_H
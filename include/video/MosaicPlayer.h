@@ -0,0 +1,86 @@
+//
+// Created by Weichuandong on 2025/4/2.
+//
+
+#ifndef VIDEOPLAYER_MOSAICPLAYER_H
+#define VIDEOPLAYER_MOSAICPLAYER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "video/FFmpegDecoder.h"
+#include "video/GLRenderer.h"
+#include "video/PlayerOptions.h"
+#include "video/ThreadPool.h"
+#include "logger.h"
+
+namespace video {
+
+    // 多路拼接播放：N 路视频显示在同一个 GLRenderer 窗口的网格分块中
+    // 各路解码作为任务调度到共享的工作窃取线程池（每路解码器单线程），线程数与路数无关；
+    // 解码器按分块尺寸选择低分辨率解码。各路有独立的内容时钟，播放到结尾后从头循环
+    class MosaicPlayer {
+    public:
+        MosaicPlayer(const std::vector<std::string>& files, const PlayerOptions& options = PlayerOptions());
+        ~MosaicPlayer();
+        void run(); // 启动播放循环
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr int WindowWidth = 1600;
+        static constexpr int WindowHeight = 900;
+        static constexpr size_t ReadyDepth = 3;    // 每路预先解码的帧数
+
+        struct DecodedFrame {
+            AVFrame* frame = nullptr;
+            double pts = 0.0;
+        };
+
+        // 一路视频；ready、decoding、failed 由 mutex 保护，解码器同一时刻只被一个任务使用
+        struct Tile {
+            std::string path;
+            std::unique_ptr<FFmpegDecoder> decoder;
+            std::mutex mutex;
+            std::deque<DecodedFrame> ready;
+            bool decoding = false;
+            bool failed = false;
+
+            // 内容时钟：origin_pts 对应 origin_time，仅在播放线程访问
+            bool has_origin = false;
+            double origin_pts = 0.0;
+            double last_pts = 0.0;
+            Clock::time_point origin_time;
+        };
+
+        void compose_loop();                    // 播放线程：按各路时钟选帧并提交拼接画面
+        void schedule_decode(Tile& tile);       // 预解码不足时向线程池提交一次解码
+        void decode_one(Tile& tile);            // 线程池任务：解码一帧，到结尾时从头循环
+        bool apply_commands();                  // 帧边界执行输入命令，收到退出命令时返回 false
+
+        ThreadPool& pool;
+        std::vector<std::unique_ptr<Tile>> tiles;
+        int columns = 1;
+        std::unique_ptr<GLRenderer> renderer;
+
+        std::atomic<bool> shouldQuit{false};
+        std::vector<PlayerCommand> pending_commands;
+        bool is_paused = false;
+        bool needs_redraw = false;              // 暂停或切换显示选项后重绘
+        Clock::time_point pause_start;
+        bool allowPrescale = true;
+
+        // 在途的解码任务，析构前等待其完成
+        std::mutex task_mutex;
+        std::condition_variable task_done;
+        int tasks_in_flight = 0;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_MOSAICPLAYER_H
@@ -0,0 +1,77 @@
+//
+// Created by Weichuandong on 2025/4/4.
+//
+
+#ifndef VIDEOPLAYER_MPSCRING_H
+#define VIDEOPLAYER_MPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace video {
+
+    // 多生产者单消费者无锁环形缓冲（有界，按槽位序号同步）
+    // 生产者用 CAS 领取写入位置，写完后发布槽位序号；消费者只读取已发布的槽位
+    // Capacity 必须是 2 的幂
+    template <typename T, size_t Capacity>
+    class MpscRing {
+        static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        MpscRing() {
+            for (size_t i = 0; i < Capacity; i++) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        // 任意线程调用，不阻塞，满时返回 false
+        bool try_push(const T& item) {
+            size_t pos = tail_index.load(std::memory_order_relaxed);
+            while (true) {
+                Cell& cell = cells[pos & (Capacity - 1)];
+                const size_t seq = cell.sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0) {
+                    // 槽位空闲，领取成功后写入并发布
+                    if (tail_index.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        cell.item = item;
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;   // 消费者尚未取走一整圈之前的元素
+                } else {
+                    pos = tail_index.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // 仅消费者线程调用，空（或下一个槽位尚未写完）时返回 false
+        bool try_pop(T& item) {
+            const size_t pos = head_index.load(std::memory_order_relaxed);
+            Cell& cell = cells[pos & (Capacity - 1)];
+            const size_t seq = cell.sequence.load(std::memory_order_acquire);
+            if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0) return false;
+            item = cell.item;
+            // 槽位留给下一圈的生产者
+            cell.sequence.store(pos + Capacity, std::memory_order_release);
+            head_index.store(pos + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T item;
+        };
+
+        Cell cells[Capacity];
+        // 分处不同缓存行，避免生产者与消费者互相干扰
+        alignas(64) std::atomic<size_t> head_index{0};
+        alignas(64) std::atomic<size_t> tail_index{0};
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_MPSCRING_H
@@ -0,0 +1,79 @@
+//
+// Created by Weichuandong on 2025/3/29.
+//
+
+#ifndef VIDEOPLAYER_OFFSCREENRENDERER_H
+#define VIDEOPLAYER_OFFSCREENRENDERER_H
+
+#include <GL/glew.h>
+#include <EGL/egl.h>
+#include <memory>
+#include <vector>
+#include <deque>
+#include "video/GLFrameRenderer.h"
+#include "logger.h"
+
+namespace video {
+
+    // 无窗口的 GL 渲染后端：EGL（surfaceless 或 pbuffer）上下文 + FBO
+    // 在无显示器、无 GPU 的机器上可运行于 Mesa llvmpipe，绘制路径与 GLRenderer 完全相同
+    // 所有调用须在构造它的线程上进行
+    class OffscreenRenderer {
+    public:
+        static constexpr int ReadbackSlots = 3;
+
+        // async_readback 为 true 时经 PBO 环形缓冲异步读回，像素延迟若干帧才可取出
+        OffscreenRenderer(int width, int height, bool async_readback = true);
+        ~OffscreenRenderer();
+
+        // 绘制一帧到 FBO；readback 为 true 时安排读回该帧像素
+        void render(const AVFrame* frame, const OverlayState& state, bool draw_ui, bool readback);
+
+        // 按提交顺序取出一帧已读回的像素（RGBA，自上而下逐行）
+        // 异步模式下只在读回环形缓冲已满或 drain 为 true 时等待最早的一帧，否则返回 false
+        bool take_pixels(std::vector<uint8_t>& rgba, bool drain = false);
+
+        // 等待所有已提交的 GL 命令完成，用于计时
+        void finish();
+
+        int width() const { return target_width; }
+        int height() const { return target_height; }
+        size_t pending_readbacks() const { return pending.size(); }
+        double last_readback_ms() const { return readback_ms; }
+
+        GLFrameRenderer& frame_renderer() { return *renderer; }
+
+    private:
+        void init_egl();
+        void init_target();
+        void release_target();
+        void copy_flipped(const uint8_t* src, std::vector<uint8_t>& rgba) const;
+
+        EGLDisplay display = EGL_NO_DISPLAY;
+        EGLContext context = EGL_NO_CONTEXT;
+        EGLSurface surface = EGL_NO_SURFACE;
+
+        int target_width = 0;
+        int target_height = 0;
+        GLuint fbo = 0;
+        GLuint color_buffer = 0;
+
+        // 异步读回：每个槽位一个 PBO 和一个栅栏
+        struct ReadbackSlot {
+            GLuint pbo = 0;
+            GLsync fence = nullptr;
+        };
+        bool async = true;
+        ReadbackSlot slots[ReadbackSlots];
+        int next_slot = 0;
+        std::deque<int> pending;    // 已提交读回的槽位，按帧顺序
+        std::vector<uint8_t> sync_pixels;   // 同步模式下最近一帧读回的像素
+        bool sync_ready = false;
+        double readback_ms = 0.0;
+
+        std::unique_ptr<GLFrameRenderer> renderer;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_OFFSCREENRENDERER_H
@@ -0,0 +1,46 @@
+//
+// Created by WeiChuandong on 2025/3/18.
+//
+
+#ifndef VIDEOPLAYER_PLAYEROPTIONS_H
+#define VIDEOPLAYER_PLAYEROPTIONS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "video/PresentScheduler.h"
+#include "video/ScalerPolicy.h"
+
+namespace video {
+
+    // 窗口渲染后端
+    enum class RendererBackend {
+        GL,     // OpenGL 3.3，独立渲染线程
+        SDL     // SDL_Renderer + YUV 流式纹理，适合没有 GPU 的机器
+    };
+
+    // 命令行可配置的播放参数
+    struct PlayerOptions {
+        RendererBackend renderer = RendererBackend::GL;
+        int filterThreads = 0;              // 滤镜图切片线程数，0 表示自动
+        bool filterPipeline = false;        // 滤镜在独立线程执行，与解码重叠
+        size_t filterPipelineDepth = 2;     // 滤镜流水线中的帧数
+        bool zeroCopyDecode = true;         // 解码直接写入 GL 暂存缓冲（不支持时自动回退）
+        SwapMode swapMode = SwapMode::VSync; // 交换间隔：垂直同步 / 自适应 / 不同步
+        ScaleFilter scaleFilter = ScaleFilter::Auto; // 视频缩放到窗口的采样方式
+        bool prescale = true;               // 窗口远小于视频时上传前在 CPU 上缩小
+        double speed = 1.0;                 // 初始播放速度 0.25 ~ 16
+        bool accurateSeek = true;           // 跳转时从关键帧预解码到目标帧
+        bool networkCache = true;           // http(s) 输入并行预读并缓存到磁盘
+        std::string cacheDir;               // 网络缓存目录，空表示系统临时目录
+        int64_t cacheLimit = int64_t(2) << 30; // 网络缓存目录的磁盘占用上限（字节），0 表示不限
+        bool live = false;                  // 直播低延迟模式（udp/rtp/rtsp/rtmp/srt 地址自动启用）
+        double liveLatency = 0.3;           // 直播目标延迟（秒）
+        std::string recordPath;             // 非空时从播放开始录制屏幕画面
+        std::string recordCodec = "libx264";
+        int64_t recordBitRate = 0;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_PLAYEROPTIONS_H
@@ -0,0 +1,93 @@
+//
+// Created by WeiChuandong on 2025/3/28.
+//
+
+#ifndef VIDEOPLAYER_PRESENTSCHEDULER_H
+#define VIDEOPLAYER_PRESENTSCHEDULER_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace video {
+
+    // 交换间隔：垂直同步、自适应同步（迟到时立即交换）、不同步
+    enum class SwapMode {
+        VSync,
+        Adaptive,
+        Off
+    };
+
+    // 显示节奏统计
+    struct PacingStats {
+        double refresh_hz = 0.0;            // 实测刷新率
+        double jitter_ms = 0.0;             // 实际显示时刻相对理想时刻偏差的标准差
+        int64_t frames = 0;                 // 显示的新帧数
+        int64_t late_frames = 0;            // 晚于理想时刻一个刷新周期以上的帧
+        int64_t repeated_refreshes = 0;     // 为保持节奏重复显示上一帧的刷新次数
+        int64_t dropped_frames = 0;         // 快进时来不及显示而丢弃的帧
+        double seek_latency_ms = 0.0;       // 最近一次跳转从请求到显示的耗时
+    };
+
+    // 显示调度：把内容时间映射到显示器刷新上
+    // 垂直同步下每次交换对应一次刷新，通过测量交换间隔估计实际刷新周期，
+    // 新帧在理想时刻之后的第一次刷新显示（留 1/4 周期余量），24fps@60Hz 得到稳定的 3:2 节奏
+    // 所有方法都在渲染线程调用
+    class PresentScheduler {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        PresentScheduler(SwapMode mode, double nominal_hz);
+
+        // 需在 GL 上下文当前时调用；驱动不支持自适应同步时回退到垂直同步
+        void apply_swap_interval();
+        SwapMode mode() const { return swap_mode; }
+
+        // 新帧到来，pts 为内容时间（秒），speed 为播放速度（内容时间/墙上时间）；
+        // 时间戳不连续（跳转、暂停恢复）或速度改变时重新对齐时钟
+        void begin_frame(double pts, double speed = 1.0);
+        // 该帧已晚于理想时刻一个刷新周期以上，有后续帧等待时应丢弃
+        bool is_late() const;
+        void on_drop() { pacing.dropped_frames++; }
+        void on_seek_shown(double latency_ms) { pacing.seek_latency_ms = latency_ms; }
+        // 垂直同步模式：下一次刷新仍早于该帧的显示时刻，需要再显示一次上一帧
+        bool should_hold() const;
+        // 不同步模式：睡眠到该帧的理想显示时刻
+        void wait_until_due() const;
+        // 每次交换缓冲后调用，new_frame 表示这次交换显示了 begin_frame 的帧
+        void on_swap(bool new_frame);
+        // should_hold() 为 true 时重复显示上一帧后调用
+        void on_repeat_swap();
+
+        const PacingStats& stats() const { return pacing; }
+
+    private:
+        void update_period(double interval);
+
+        SwapMode swap_mode;
+        double nominal_period;
+        double period;
+
+        // 内容时钟与墙上时钟的对齐点
+        bool has_origin = false;
+        Clock::time_point origin_time;
+        double origin_pts = 0.0;
+        double last_pts = 0.0;
+        double speed = 1.0;
+        Clock::time_point due_time;
+
+        bool has_swap = false;
+        Clock::time_point last_swap;
+        std::vector<double> intervals;      // 最近的交换间隔（秒）
+        size_t interval_pos = 0;
+        int64_t samples = 0;
+        int short_swaps = 0;
+
+        double error_mean = 0.0;
+        double error_var = 0.0;
+        PacingStats pacing;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_PRESENTSCHEDULER_H
@@ -0,0 +1,111 @@
+//
+// Created by Weichuandong on 2025/4/4.
+//
+
+#ifndef VIDEOPLAYER_PROGRESSIVEINPUT_H
+#define VIDEOPLAYER_PROGRESSIVEINPUT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <libavformat/avio.h>
+}
+
+namespace video {
+
+    struct ProgressiveOptions {
+        bool enabled = true;            // http(s) 输入走分块预读与磁盘缓存
+        std::string cacheDir;           // 缓存目录，空表示系统临时目录下的 glitchplayer-cache
+        int64_t cacheLimit = int64_t(2) << 30;  // 缓存目录的磁盘占用上限，超出时删除最久未使用的缓存，0 表示不限
+        int fetchThreads = 4;           // 并行范围请求数
+        int readAheadChunks = 32;       // 播放位置之后预读的块数
+        int64_t chunkSize = 1 << 20;    // 每次范围请求的字节数
+    };
+
+    // 渐进式网络输入：把 http(s) 文件按块并行做范围请求，写入磁盘上的稀疏缓存文件，
+    // 以自定义 AVIOContext 交给 avformat 读取。
+    // 下载顺序从当前读取位置开始向后预读，跳转后立即改为从新位置下载；
+    // 已下载的块直接从本地磁盘读取，同一 URL 再次打开时沿用上次的缓存
+    // （长度、内容类型或文件开头的内容变化时缓存作废）。
+    // 服务器不支持范围请求或长度未知时构造函数抛出异常，调用方回退到直接打开
+    class ProgressiveInput {
+    public:
+        static bool supports(const std::string& url);   // 是否为 http/https 地址
+
+        ProgressiveInput(const std::string& url, const ProgressiveOptions& options = ProgressiveOptions());
+        ~ProgressiveInput();
+
+        ProgressiveInput(const ProgressiveInput&) = delete;
+        ProgressiveInput& operator=(const ProgressiveInput&) = delete;
+
+        // 交给 AVFormatContext::pb，需在 avformat_close_input 之后再析构本对象
+        AVIOContext* avio() const { return io; }
+        int64_t size() const { return total_size; }
+
+    private:
+        enum ChunkState : uint8_t { Missing, Fetching, Ready, Failed };
+
+        static constexpr int IOBufferSize = 64 * 1024;
+        static constexpr int MaxAttempts = 3;
+
+        static int read_packet(void* opaque, uint8_t* buf, int size);
+        static int64_t seek_packet(void* opaque, int64_t offset, int whence);
+        static int interrupt(void* opaque);
+
+        int read(uint8_t* buf, int size);           // 解码线程：等待所在块下载完成后从缓存文件读取
+        int64_t seek(int64_t offset, int whence);
+        void fetch_loop(AVIOContext* conn);         // 下载线程；conn 为已连接到文件开头的连接或 nullptr
+        int64_t next_chunk() const;                 // 需持有 mutex；预读窗口内第一个待下载的块，-1 表示没有
+        void move_playhead(int64_t chunk);          // 需持有 mutex；下载优先级移到 chunk
+        // 下载一块写入缓存；连接正好停在块开头时继续读取，否则从块开头重新发起范围请求
+        bool fetch_chunk(AVIOContext*& conn, int64_t& conn_offset, int64_t chunk, std::vector<uint8_t>& buffer);
+        AVIOContext* connect(int64_t offset);
+        // 用探测连接读取源文件的校验信息（内容类型与开头内容的哈希）
+        bool read_validator(AVIOContext* probe);
+        void open_cache();
+        void release();
+        int64_t chunk_bytes(int64_t chunk) const;
+
+        std::string url;
+        ProgressiveOptions options;
+        AVIOInterruptCB interrupt_cb{};
+        AVIOContext* io = nullptr;
+        int64_t total_size = 0;
+        int64_t chunk_count = 0;
+        int64_t position = 0;           // 解码线程的读取位置
+
+        // 源文件校验信息，与缓存文件头比较
+        std::string mime_type;
+        uint64_t fingerprint = 0;       // 文件开头内容的哈希
+
+        // 缓存文件：data 为与源文件同样大小的稀疏文件，map 为文件头加每块一个字节的下载标记
+        int data_fd = -1;
+        int map_fd = -1;
+
+        std::mutex mutex;
+        std::condition_variable fetch_cv;   // 有新的待下载块或退出
+        std::condition_variable ready_cv;   // 有块下载完成或失败
+        std::vector<uint8_t> chunks;        // ChunkState
+        std::vector<uint8_t> attempts;
+        int64_t playhead = 0;               // 读取位置所在的块
+        std::atomic<bool> stopping{false};
+
+        std::vector<std::thread> workers;   // 每个下载线程持有自己的连接
+
+        // 统计
+        int64_t cached_chunks = 0;          // 打开时缓存中已有的块
+        std::atomic<int64_t> downloaded_bytes{0};
+        int stalls = 0;
+        double stall_ms = 0.0;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_PROGRESSIVEINPUT_H
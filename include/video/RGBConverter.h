@@ -0,0 +1,89 @@
+//
+// Created by Weichuandong on 2025/4/2.
+//
+
+#ifndef VIDEOPLAYER_RGBCONVERTER_H
+#define VIDEOPLAYER_RGBCONVERTER_H
+
+#include <cstdint>
+#include <vector>
+#include "video/ThreadPool.h"
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+namespace video {
+
+    // 可复用的 RGB24 目标缓冲：起始地址和行距按 64 字节对齐，尺寸不变时不重新分配
+    class RGBBuffer {
+    public:
+        static constexpr int Alignment = 64;
+
+        RGBBuffer() = default;
+        ~RGBBuffer();
+        RGBBuffer(const RGBBuffer&) = delete;
+        RGBBuffer& operator=(const RGBBuffer&) = delete;
+
+        bool allocate(int width, int height);
+
+        uint8_t* data() const { return pixels; }
+        int stride() const { return line_size; }
+        int width() const { return buffer_width; }
+        int height() const { return buffer_height; }
+
+    private:
+        uint8_t* pixels = nullptr;
+        int line_size = 0;
+        int buffer_width = 0;
+        int buffer_height = 0;
+    };
+
+    // 多线程 YUV -> RGB24 转换：帧按水平条带切分，每个条带一个 swscale 上下文，在线程池上并行
+    // 颜色矩阵（BT.601/709 等）与范围取自帧属性，输出为全范围 RGB，直接写入调用方的缓冲
+    class RGBConverter {
+    public:
+        // pool 为空时使用共享线程池
+        explicit RGBConverter(ThreadPool* pool = nullptr);
+        ~RGBConverter();
+
+        // dst 至少 frame->height 行、行距 dst_stride 字节；格式、尺寸或颜色属性变化时重建上下文
+        bool convert(const AVFrame* frame, uint8_t* dst, int dst_stride);
+        bool convert(const AVFrame* frame, RGBBuffer& dst);
+
+        // 最近一帧的转换耗时（毫秒）
+        double last_ms() const { return convert_ms; }
+
+    private:
+        // 条带高度为 16 的倍数（满足色度垂直采样对齐），每个条带至少 MinSliceRows 行
+        static constexpr int MinSliceRows = 64;
+        static constexpr int MaxSlices = 32;
+
+        struct Slice {
+            SwsContext* ctx = nullptr;
+            int y = 0;
+            int height = 0;
+        };
+
+        bool prepare(const AVFrame* frame);
+        void release();
+
+        ThreadPool* pool;
+        std::vector<Slice> slices;
+
+        // 当前上下文对应的输入属性
+        int src_format = -1;
+        int src_width = 0;
+        int src_height = 0;
+        int src_colorspace = -1;
+        int src_range = -1;
+        int chroma_shift = 0;
+        bool has_palette = false;
+
+        double convert_ms = 0.0;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_RGBCONVERTER_H
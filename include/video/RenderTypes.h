@@ -0,0 +1,58 @@
+//
+// Created by Weichuandong on 2025/4/1.
+//
+
+#ifndef VIDEOPLAYER_RENDERTYPES_H
+#define VIDEOPLAYER_RENDERTYPES_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace video {
+
+    // 随帧提交的 UI 状态
+    struct OverlayState {
+        float progress = 0.0f;
+        double current_time = 0.0;
+        double total_time = 0.0;
+        bool is_paused = false;
+        double speed = 1.0;             // 播放速度，显示调度按它把内容时间映射到墙上时间
+        // 跳转后的第一帧带有跳转请求的时刻，显示时统计跳转到显示的延迟
+        std::chrono::steady_clock::time_point seek_time{};
+        bool show_debug = false;
+        bool show_timeline = true;      // 进度条与时间文本（拼接模式下不显示）
+        double live_latency = -1.0;     // 直播模式下当前延迟（秒），不显示进度条时代替时间文本；<0 表示非直播
+    };
+
+    struct RecordOptions {
+        std::string path;
+        std::string codec = "libx264";
+        std::string preset = "veryfast";    // 录制需要实时编码
+        int64_t bitRate = 0;
+    };
+
+    // 进度条几何，各渲染后端绘制与点击检测共用
+    constexpr float ProgressBarHeight = 8.0f;
+    // 进度条顶部的 y 坐标（像素，自上而下）
+    inline float progress_bar_top(int h) { return h - ProgressBarHeight - 20.0f; }
+
+    // 时间文本后附加的速度标记，1x 时为空
+    inline std::string speed_label(double speed) {
+        if (speed == 1.0) return "";
+        char text[16];
+        snprintf(text, sizeof(text), "  %.4gx", speed);
+        return text;
+    }
+
+    // 直播状态文本，如 "LIVE 320 ms  1.05x"；按 10ms 取整，避免叠加层每帧重绘
+    inline std::string live_label(double latency, double speed) {
+        char text[32];
+        snprintf(text, sizeof(text), "LIVE %d ms", static_cast<int>(latency * 100.0 + 0.5) * 10);
+        return text + speed_label(speed);
+    }
+
+} // namespace video
+
+#endif //VIDEOPLAYER_RENDERTYPES_H
@@ -3,33 +3,65 @@
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
+#include <chrono>
 #include <memory>
 #include <stdexcept>
+#include <string>
 
+#include "video/VideoRenderer.h"
 #include "video/TextRenderer.h"
-#include "PlayerEvent.h"
+
+extern "C" {
+#include <libswscale/swscale.h>
+}
 
 namespace video {
 
-    class SDLRenderer {
+    // SDL_Renderer 后端，适合没有 GPU 或 GL 驱动不可用的机器
+    // 解码平面通过 IYUV/NV12 流式纹理直接上传，颜色转换由 SDL（GPU 或其软件渲染器）完成，不经过 RGB；
+    // 其他像素格式先转换为 YUV420P。窗口、事件与绘制都在创建它的（主）线程
+    class SDLRenderer : public VideoRenderer {
     public:
-        SDLRenderer(int width, int height);
-        ~SDLRenderer();
+        SDLRenderer(int width, int height, SwapMode swap_mode = SwapMode::VSync);
+        ~SDLRenderer() override;
+
+        // 采集窗口事件，并显示队列中的下一帧（最多等待 10ms）
+        bool handle_events() override;
 
-        void render_frame(const uint8_t* rgb_data, double current_time, double duration);  // 渲染一帧 RGB 数据
-        PlayerEvent handle_events();                 // 处理窗口事件
+    protected:
+        void draw(const AVFrame* frame, const OverlayState& state, bool record) override;
 
     private:
-        void draw_progress_bar(double current_time, double duration);  // 绘制进度条
+        // 上传一帧到流式纹理，格式或尺寸变化时重建纹理
+        bool upload_frame(const AVFrame* frame);
+        bool ensure_texture(Uint32 format, int w, int h, SDL_YUV_CONVERSION_MODE mode);
+        // 没有原生纹理格式时转换为 YUV420P
+        const AVFrame* convert_frame(const AVFrame* frame);
+        void draw_ui(const OverlayState& state, int w, int h);
         std::string format_time(double seconds);
 
-        SDL_Window* window = nullptr;
         SDL_Renderer* renderer = nullptr;
+        std::string renderer_name;
         SDL_Texture* texture = nullptr;
+        Uint32 texture_format = SDL_PIXELFORMAT_UNKNOWN;
+        int texture_width = 0;
+        int texture_height = 0;
+        SDL_YUV_CONVERSION_MODE texture_mode = SDL_YUV_CONVERSION_BT601;
+        bool has_video = false;
+
+        // 格式转换回退
+        SwsContext* fallback_sws = nullptr;
+        AVFrame* fallback_frame = nullptr;
+        int warned_format = -1;
+
         std::unique_ptr<TextRenderer> text_renderer;
 
-        uint16_t width;
-        uint16_t height;
+        // 上传统计
+        double upload_ms = 0.0;
+        bool locked_upload = false;
+        std::string stats_text;
+        std::string memory_text;        // 各子系统内存占用，统计文本的第二行
+        std::chrono::steady_clock::time_point stats_updated;
     };
 
 } // namespace video
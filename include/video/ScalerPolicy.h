@@ -0,0 +1,54 @@
+//
+// Created by Weichuandong on 2025/3/30.
+//
+
+#ifndef VIDEOPLAYER_SCALERPOLICY_H
+#define VIDEOPLAYER_SCALERPOLICY_H
+
+namespace video {
+
+    // 视频缩放到窗口时使用的采样方式
+    enum class ScaleFilter {
+        Auto,       // 根据缩放比例和帧预算自动选择
+        Bilinear,   // 纹理单元的线性过滤，开销最低
+        Bicubic,    // Catmull-Rom，4x4 邻域
+        Lanczos,    // Lanczos2，4x4 邻域，放大/轻度缩小时最清晰
+        Mipmap,     // 三线性 mipmap，大比例缩小时抑制混叠
+        Count
+    };
+
+    const char* scale_filter_name(ScaleFilter filter);
+    // 解析命令行中的名称，未知名称返回 false
+    bool parse_scale_filter(const char* name, ScaleFilter& filter);
+
+    struct ScalerChoice {
+        ScaleFilter filter = ScaleFilter::Bilinear;
+        int prescale_shift = 0;     // 上传前在 CPU 上 2x2 盒式缩小的次数
+    };
+
+    // 缩放方式的自动选择
+    // 窗口远小于视频时先在 CPU 上逐级减半再上传，缩小后的尺寸仍不小于窗口；
+    // 剩余缩放比例小于 1/2 用 mipmap，否则在帧预算允许的范围内选最高质量的卷积核。
+    // 实测 GPU 耗时长期超过预算一半时逐级降级，长期低于预算 1/5 时逐级恢复
+    class ScalerPolicy {
+    public:
+        static constexpr int MaxPrescaleShift = 2;
+
+        // 每帧调用；gpu_ms 为上一次测得的绘制耗时，budget_ms 为帧预算（<=0 表示不限）
+        ScalerChoice update(ScaleFilter requested, bool allow_prescale,
+                            int video_width, int video_height, int view_width, int view_height,
+                            double gpu_ms, double budget_ms);
+
+        ScalerChoice current() const { return choice; }
+
+    private:
+        // 卷积核质量等级：0 双线性，1 双三次，2 Lanczos
+        int quality_cap = 2;
+        int frames_since_change = 0;
+        double smoothed_gpu_ms = 0.0;
+        ScalerChoice choice;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_SCALERPOLICY_H
@@ -0,0 +1,104 @@
+//
+// Created by Weichuandong on 2025/3/31.
+//
+
+#ifndef VIDEOPLAYER_SCREENRECORDER_H
+#define VIDEOPLAYER_SCREENRECORDER_H
+
+#include <GL/glew.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include "video/VideoEncoder.h"
+#include "video/BoundedQueue.h"
+#include "video/MemoryBudget.h"
+#include "video/RenderTypes.h"
+#include "logger.h"
+
+namespace video {
+
+    struct RecordStats {
+        int64_t captured = 0;       // 发起读回的帧
+        int64_t encoded = 0;        // 已编码的帧
+        int64_t dropped = 0;        // 读回槽位或编码队列已满而丢弃的帧
+    };
+
+    // 录制屏幕上显示的画面（含滤镜与 UI 叠加层）
+    // 渲染线程在交换缓冲前把后缓冲复制到录制 FBO 并读回到 PBO，用栅栏跟踪完成情况，从不等待 GPU；
+    // 支持持久映射时编码线程直接从映射内存转换像素，渲染线程无整帧拷贝。
+    // 帧时间戳取交换缓冲的时刻（显示时钟），输出为可变帧率
+    // 读回 PBO 与编码队列登记到内存预算，内存紧张时缩短编码队列（多丢帧）
+    class ScreenRecorder : public MemoryConsumer {
+    public:
+        using Clock = std::chrono::steady_clock;
+        static constexpr int Slots = 4;
+
+        // 需在 GL 线程创建与销毁；width/height 为录制尺寸（向下取偶数），窗口尺寸变化时缩放到该尺寸
+        ScreenRecorder(const RecordOptions& options, int width, int height, double nominal_fps);
+        ~ScreenRecorder() override;
+
+        size_t memory_usage() const override;
+        void on_memory_pressure(int level) override;
+
+        // 交换缓冲前调用：复制当前后缓冲（src_w x src_h）并发起异步读回，槽位全部占用时丢弃该帧
+        void capture(int src_w, int src_h);
+        // 交换缓冲后调用：以显示时刻作为刚捕获帧的时间戳，并把已完成的读回交给编码线程
+        void on_presented(Clock::time_point when);
+        // 把已完成的读回交给编码线程，不阻塞
+        void poll();
+
+        RecordStats stats() const;
+        const std::string& path() const { return options.path; }
+
+    private:
+        enum SlotState { Free = 0, Reading, Encoding };
+
+        struct Slot {
+            GLuint pbo = 0;
+            GLsync fence = nullptr;
+            const uint8_t* mapped = nullptr;    // 持久映射地址，不支持时为 nullptr
+            std::atomic<int> state{Free};
+            int64_t pts = AV_NOPTS_VALUE;
+        };
+
+        // 交给编码线程的一帧：位于持久映射槽位中，或已拷贝到 frame
+        struct EncodeItem {
+            int slot = -1;
+            AVFrame* frame = nullptr;
+            int64_t pts = 0;
+        };
+
+        void encode_loop();
+        bool hand_off(int index, bool wait);
+
+        RecordOptions options;
+        int width = 0;
+        int height = 0;
+        bool persistent = false;
+
+        GLuint fbo = 0;
+        GLuint color_buffer = 0;
+        Slot slots[Slots];
+        int next_slot = 0;
+        int last_captured = -1;
+        std::deque<int> reading;            // 读回中的槽位，按捕获顺序
+
+        Clock::time_point start_time;
+        bool started = false;
+        int64_t last_pts = AV_NOPTS_VALUE;
+
+        std::unique_ptr<VideoEncoder> encoder;
+        std::unique_ptr<BoundedQueue<EncodeItem>> encode_queue;
+        std::thread encode_thread;
+
+        std::atomic<int64_t> captured{0};
+        std::atomic<int64_t> encoded{0};
+        std::atomic<int64_t> dropped{0};
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_SCREENRECORDER_H
@@ -5,21 +5,32 @@
 #ifndef VIDEOPLAYER_TEXTRENDERER_H
 #define VIDEOPLAYER_TEXTRENDERER_H
 
-#include <SDL2/SDL_ttf.h>
+#include <SDL2/SDL.h>
 #include <string>
-#include <memory>
+#include <vector>
+#include "video/GlyphAtlas.h"
 
 namespace video {
 
+    // SDL_Renderer 后端的文本绘制：字形来自 GlyphAtlas，整串文本一次 SDL_RenderGeometry
     class TextRenderer {
     public:
-        TextRenderer(const char* font_path, int font_size);
+        TextRenderer(SDL_Renderer* renderer, const char* font_path, int font_size);
         ~TextRenderer();
 
-        SDL_Texture* render_text(SDL_Renderer* renderer, const std::string& text, SDL_Color color);
+        // 以 (x, y) 为左上角绘制文本，返回文本宽度
+        float draw_text(const std::string& text, float x, float y, SDL_Color color);
+        int line_height() const { return atlas.line_height(); }
 
     private:
-        TTF_Font* font = nullptr;
+        SDL_Renderer* renderer = nullptr;
+        GlyphAtlas atlas;
+        SDL_Texture* atlas_texture = nullptr;
+
+        // 复用的顶点缓冲，避免每帧分配
+        std::vector<GlyphQuad> quads;
+        std::vector<SDL_Vertex> vertices;
+        std::vector<int> indices;
     };
 }
 #endif //VIDEOPLAYER_TEXTRENDERER_H
@@ -0,0 +1,66 @@
+//
+// Created by Weichuandong on 2025/4/2.
+//
+
+#ifndef VIDEOPLAYER_THREADPOOL_H
+#define VIDEOPLAYER_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace video {
+
+    // 固定大小的工作窃取线程池：条带转换、多路解码等共用，线程总数不随任务来源增加
+    // 每个工作线程有自己的任务队列，工作线程提交的任务进入自己的队列（后进先出，缓存友好），
+    // 外部提交的任务轮流分配；自己的队列为空时从其他线程队列的另一端窃取
+    class ThreadPool {
+    public:
+        // threads 为工作线程数，0 表示 CPU 核数 - 1（调用线程也参与 parallel_for）
+        explicit ThreadPool(int threads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        int size() const { return static_cast<int>(workers.size()); }
+
+        // 提交一个异步任务
+        void submit(std::function<void()> task);
+
+        // 对 [0, count) 的每个下标执行 fn，调用线程也领取下标，全部完成后返回
+        // 可在工作线程中嵌套调用，不会死锁
+        void parallel_for(int count, const std::function<void(int)>& fn);
+
+        // 进程内共享的线程池
+        static ThreadPool& shared();
+
+    private:
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        void worker_loop(int index);
+        // 先取自己队列的尾部，再按顺序窃取其他队列的头部
+        bool take(int index, std::function<void()>& task);
+
+        std::vector<std::unique_ptr<WorkerQueue>> queues;
+        std::atomic<int> pending{0};        // 已提交尚未被取走的任务数
+        std::atomic<unsigned> next_queue{0};
+
+        // 空闲线程在此等待
+        std::mutex sleep_mutex;
+        std::condition_variable sleep_cv;
+        bool stopping = false;
+        std::vector<std::thread> workers;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_THREADPOOL_H
@@ -0,0 +1,88 @@
+//
+// Created by WeiChuandong on 2025/3/20.
+//
+
+#ifndef VIDEOPLAYER_TRANSCODER_H
+#define VIDEOPLAYER_TRANSCODER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include "video/FFmpegDecoder.h"
+#include "video/VideoEncoder.h"
+#include "video/BoundedQueue.h"
+#include "video/MemoryBudget.h"
+#include "logger.h"
+
+namespace video {
+
+    struct TranscodeOptions {
+        std::string input;
+        std::string output;
+        std::vector<std::string> filters;   // 与交互播放相同的滤镜名，按顺序组成滤镜链
+        std::string codec = "libx264";
+        int64_t bitRate = 0;
+        int filterThreads = 0;              // 滤镜图切片线程数，0 表示自动
+        int segmentFrames = 0;              // >0 时按该帧数切分 GOP 并行编码
+        int encodeWorkers = 0;              // 并行编码线程数，0 表示自动
+    };
+
+    // 无窗口离线处理：解码 -> 滤镜 -> 编码 -> 封装
+    // 解码、滤镜、编码分别运行在不同线程上，形成帧级流水线
+    // 编码队列登记到内存预算，内存紧张时缩短队列，解码随之放慢
+    class Transcoder : public MemoryConsumer {
+    public:
+        explicit Transcoder(const TranscodeOptions& options);
+        ~Transcoder() override;
+
+        size_t memory_usage() const override;
+        void on_memory_pressure(int level) override;
+
+        bool run();
+
+    private:
+        // 一个独立编码的 GOP 分段
+        struct Segment {
+            int index = 0;
+            std::vector<AVFrame*> frames;
+        };
+        struct EncodedSegment {
+            std::vector<AVPacket*> packets;
+        };
+
+        void encode_loop();
+        void segment_worker(int threads);
+        bool encode_segment(AVCodecContext* ctx, SwsContext*& sws, Segment& segment, EncodedSegment& out);
+        void write_ready_segments();
+        void report_progress(bool final);
+
+        TranscodeOptions options;
+        std::unique_ptr<FFmpegDecoder> decoder;
+        std::unique_ptr<VideoEncoder> encoder;
+
+        // 队列在 run() 开始时创建、登记到内存预算，此后不再替换
+        // 顺序编码模式
+        std::unique_ptr<BoundedQueue<AVFrame*>> frame_queue;
+
+        // GOP 分段并行模式：分段可能乱序完成，按序号顺序写入
+        std::unique_ptr<BoundedQueue<Segment>> segment_queue;
+        std::mutex write_mutex;
+        std::map<int, EncodedSegment> finished_segments;
+        int next_segment_to_write = 0;
+        size_t segment_depth = 1;
+
+        std::atomic<size_t> frame_bytes{0};     // 每帧字节数，按首帧估算
+
+        std::atomic<bool> encode_failed{false};
+        int64_t frames_decoded = 0;
+        double media_seconds = 0.0;
+        int64_t start_time_us = 0;
+        int64_t last_report_us = 0;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_TRANSCODER_H
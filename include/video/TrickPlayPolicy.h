@@ -0,0 +1,54 @@
+//
+// Created by Weichuandong on 2025/4/3.
+//
+
+#ifndef VIDEOPLAYER_TRICKPLAYPOLICY_H
+#define VIDEOPLAYER_TRICKPLAYPOLICY_H
+
+namespace video {
+
+    // 解码时跳过的帧，对应 AVDISCARD_DEFAULT / AVDISCARD_NONREF / AVDISCARD_NONKEY
+    enum class DecodeSkip {
+        None,       // 完整解码
+        NonRef,     // 跳过不被参考的帧（通常是 B 帧）
+        NonKey,     // 只解码关键帧
+        Count
+    };
+
+    const char* decode_skip_name(DecodeSkip skip);
+
+    // 变速播放与跳帧解码的选择
+    // 解码负载 = 解码耗时 / (内容时间前进量 / 速度)，即解码占用的墙上时间比例。
+    // 快进时负载长期超过上限逐级跳过更多帧；改变速度时按各级别实测的负载（折算到新速度）
+    // 选出能跟上的最低级别，不需要重新打开解码器或跳转。慢放与 1x 以下总是完整解码
+    class TrickPlayPolicy {
+    public:
+        static constexpr double MinSpeed = 0.25;
+        static constexpr double MaxSpeed = 16.0;
+
+        explicit TrickPlayPolicy(double speed = 1.0) { set_speed(speed); }
+
+        // 立即生效，返回新速度下的跳帧级别
+        DecodeSkip set_speed(double speed);
+        double speed() const { return playback_speed; }
+        // 按 0.25, 0.5, 0.75, 1, 1.25, 1.5, 2, 4, 8, 16 的档位升降
+        DecodeSkip step_speed(bool faster);
+
+        // 每解码一帧调用；decode_seconds 为取得该帧的耗时，content_seconds 为与上一帧的时间戳差
+        DecodeSkip update(double decode_seconds, double content_seconds);
+        DecodeSkip current() const { return static_cast<DecodeSkip>(level); }
+
+    private:
+        static constexpr int LevelCount = static_cast<int>(DecodeSkip::Count);
+
+        double playback_speed = 1.0;
+        int level = 0;
+        int frames_since_change = 0;
+        double smoothed_load = 0.0;
+        // 各级别实测负载除以当时的速度，0 表示尚未测量
+        double normalized_load[LevelCount] = {0.0, 0.0, 0.0};
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_TRICKPLAYPOLICY_H
@@ -0,0 +1,77 @@
+//
+// Created by WeiChuandong on 2025/3/20.
+//
+
+#ifndef VIDEOPLAYER_VIDEOENCODER_H
+#define VIDEOPLAYER_VIDEOENCODER_H
+
+#include <string>
+#include <stdexcept>
+#include "logger.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+namespace video {
+
+    struct EncoderConfig {
+        std::string path;                   // 输出文件
+        std::string codecName = "libx264";  // 找不到时回退到容器默认编码器
+        int width = 0;
+        int height = 0;
+        AVPixelFormat inputFormat = AV_PIX_FMT_YUV420P;
+        AVPixelFormat outputFormat = AV_PIX_FMT_NONE;   // NONE 表示按输入格式选择编码器支持的最接近格式
+        AVRational timeBase = {1, 1000};    // 输入帧 pts 的时间基
+        AVRational frameRate = {25, 1};
+        int64_t bitRate = 0;                // 0 表示使用编码器默认码控
+        int gopSize = 0;                    // 0 表示编码器默认
+        int maxBFrames = -1;                // -1 表示编码器默认
+        int threads = 0;                    // 0 表示自动
+        std::string preset;                 // 编码器私有 preset 选项（如 x264 的 veryfast），空表示默认
+        bool segmented = false;             // GOP 分段并行编码：主编码器不打开，数据包全部来自分段上下文
+    };
+
+    // 编码 + 封装到文件
+    class VideoEncoder {
+    public:
+        explicit VideoEncoder(const EncoderConfig& config);
+        ~VideoEncoder();
+
+        // 编码一帧，像素格式不被编码器支持时自动转换
+        bool encode(const AVFrame* frame);
+        // 冲刷编码器并写入文件尾
+        bool finish();
+
+        // GOP 分段并行编码：创建与主编码器参数一致的独立编码上下文，由调用者释放
+        // 分段上下文不使用全局头，参数集随每个分段的关键帧写入码流
+        AVCodecContext* create_segment_context(int threads) const;
+        // 写入外部编码上下文产生的数据包（时间基为编码器时间基）
+        bool write_packet(AVPacket* pkt);
+
+        AVPixelFormat encoder_format() const { return codec_ctx->pix_fmt; }
+
+        // 转换为目标像素格式，格式一致时返回新引用；sws 由调用者持有以便在多线程中复用
+        static AVFrame* convert_frame(SwsContext*& sws, const AVFrame* src, AVPixelFormat dst_format);
+
+    private:
+        // 按配置创建编码上下文（未打开）
+        AVCodecContext* configure_context(int threads) const;
+        // 打开编码器，失败时释放 ctx 并返回 nullptr
+        AVCodecContext* open_context(AVCodecContext* ctx) const;
+        bool drain(AVCodecContext* ctx);
+
+        EncoderConfig config;
+        const AVCodec* codec = nullptr;
+        AVFormatContext* fmt_ctx = nullptr;
+        AVCodecContext* codec_ctx = nullptr;
+        AVStream* stream = nullptr;
+        SwsContext* sws_ctx = nullptr;
+        bool finished = false;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_VIDEOENCODER_H
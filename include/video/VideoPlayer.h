@@ -3,33 +3,65 @@
 
 #include <memory>
 #include <string>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
 #include "video/FFmpegDecoder.h"
 #include "video/SDLRenderer.h"
 #include "video/GLRenderer.h"
+#include "video/PlayerOptions.h"
+#include "video/TrickPlayPolicy.h"
+#include "video/LiveLatencyPolicy.h"
 #include "logger.h"
-#include "video/filters/FlipFilter.h"
-#include "video/filters/MirrorFilter.h"
-#include "video/filters/GrayscaleFilter.h"
+#include "video/filters/BuiltinFilters.h"
 
 namespace video {
 
     class VideoPlayer {
     public:
-        explicit VideoPlayer(const std::string& filepath);
+        explicit VideoPlayer(const std::string& filepath, const PlayerOptions& options = PlayerOptions());
+        ~VideoPlayer();
         void run(); // 启动播放循环
 
     private:
         std::unique_ptr<FFmpegDecoder> decoder;
-        std::unique_ptr<GLRenderer> gl_renderer;
-        std::unique_ptr<uint8_t[]> rgb_buffer;
+        std::unique_ptr<VideoRenderer> renderer;
 
-        void handleKeyPress(SDL_Keycode key); // 新增键盘处理函数
-        void handleSeek(float ration);
+        bool apply_commands();                // 帧边界执行输入命令，收到退出命令时返回 false
+        void handle_command(const PlayerCommand& command);
+        void playback_loop();                 // 播放线程：输入回调、解码、提交显示
+        bool present(FFmpegDecoder::YUVData& yuvData); // 提交当前帧，yuvData.frame 为空时只刷新 UI
+        void handleSeek(float ration, bool preview);
+        void seek_to(double seconds);         // 按 accurateSeek 跳转，记录请求时刻
 
+        std::vector<PlayerCommand> pending_commands;  // 本次帧边界合并后的命令，复用避免分配
         bool is_paused = false; // 暂停状态
+        bool scrubbing = false; // 正在拖动进度条：只显示预览帧，不继续解码
         double duration = 0.0;  // 视频总时长
-        bool shouldQuit = false; //是否退出
+        std::atomic<bool> shouldQuit{false}; //是否退出（主线程与播放线程共享）
         bool shouldDebug = true; //调试信息显示开关
+        bool allowPrescale = true; // 切换缩放方式时保持 CPU 预缩小设置
+        bool accurateSeek = true;  // 跳转到目标帧而不是之前的关键帧
+        // 跳转请求的时刻，随跳转后的第一帧交给渲染器统计延迟
+        std::chrono::steady_clock::time_point seek_requested{};
+
+        // 变速播放：速度随帧交给显示调度，快进跟不上时解码器逐级跳帧
+        TrickPlayPolicy trick_play;
+        double last_decoded_pts = 0.0;
+        void apply_decode_skip(DecodeSkip skip);
+
+        // 直播低延迟：按延迟目标小幅加速或丢帧，不支持跳转与手动变速
+        bool live = false;
+        LiveLatencyPolicy live_latency;
+        std::chrono::steady_clock::time_point live_reported{};
+        bool keep_live_latency(double pts);   // 更新延迟估计，返回 false 表示该帧应丢弃
+
+        // 录制：R 键开始/停止，每次录制写入新文件
+        RecordOptions recordOptions;
+        std::string recordBasePath;
+        bool recordRequested = false;   // 最近一次请求是开始录制
+        void toggleRecording();
 
         // 前进后退逻辑
         void step_forward_frame();
@@ -0,0 +1,120 @@
+//
+// Created by Weichuandong on 2025/4/1.
+//
+
+#ifndef VIDEOPLAYER_VIDEORENDERER_H
+#define VIDEOPLAYER_VIDEORENDERER_H
+
+#include <SDL2/SDL.h>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include "video/RenderTypes.h"
+#include "video/ScalerPolicy.h"
+#include "video/PresentScheduler.h"
+#include "video/FrameBufferPool.h"
+#include "video/MemoryBudget.h"
+#include "video/BoundedQueue.h"
+#include "video/CommandBus.h"
+#include "logger.h"
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+namespace video {
+
+    // 渲染后端：GL（GLRenderer）或软件友好的 SDL_Renderer（SDLRenderer）
+    // 窗口与事件在创建它的（主）线程处理，播放线程通过显示队列提交帧，
+    // 键盘与鼠标输入转换为命令投递到命令总线，由播放线程在帧边界取出执行
+    // 显示队列登记到内存预算，内存紧张时缩小队列深度
+    class VideoRenderer : public MemoryConsumer {
+    public:
+        ~VideoRenderer() override;
+
+        size_t memory_usage() const override;
+        void on_memory_pressure(int level) override;
+
+        // 提交一帧到显示队列，接管 frame 的所有权；frame 为 nullptr 时只以新的 UI 状态重绘上一帧
+        // 队列满时阻塞；渲染器已停止时返回 false
+        bool submit_frame(AVFrame* frame, const OverlayState& state);
+        // 拼接模式：提交各分块的新帧（nullptr 表示该分块沿用上一帧），按 columns 列排布并立即显示
+        // 显示节奏由调用方决定；接管所有帧的所有权
+        bool submit_tiles(std::vector<AVFrame*> frames, int columns, const OverlayState& state);
+        // 停止接收新帧，阻塞在 submit_frame 中的调用方立即返回
+        void close() { present_queue->close(); }
+        // 丢弃尚未显示的帧，跳转后旧位置的帧不再显示
+        void discard_queued();
+        // 显示队列深度（默认 PresentQueueDepth），直播时减到 1 以降低延迟
+        void set_queue_depth(size_t depth);
+        size_t queued_frames() const { return present_queue->size(); }
+
+        // 在主线程采集窗口事件并投递命令，收到退出事件时返回 false
+        virtual bool handle_events() = 0;
+        // 输入命令；点击或拖动进度条投递 Seek（拖动中为预览），按键见 command_for_key
+        CommandBus& commands() { return command_bus; }
+
+        // 左上角显示渲染统计
+        virtual void set_show_stats(bool show) { show_stats = show; }
+        virtual bool is_showing_stats() const { return show_stats; }
+
+        // 解码器可直接写入的帧缓冲池，后端不支持时为 nullptr
+        virtual FrameBufferPool* frame_buffer_pool() const { return nullptr; }
+
+        // 视频缩放方式，下一帧生效；不支持的后端忽略
+        virtual void set_scaler(ScaleFilter filter, bool allow_prescale) { (void)filter; (void)allow_prescale; }
+        virtual ScaleFilter scaler() const { return ScaleFilter::Bilinear; }
+
+        // 录制屏幕画面到文件；不支持的后端只给出提示
+        virtual void start_recording(const RecordOptions& options);
+        virtual void stop_recording() {}
+        virtual bool is_recording() const { return false; }
+        // 渲染线程已成功开始的录制次数
+        virtual int recordings_started() const { return 0; }
+
+    protected:
+        static constexpr size_t PresentQueueDepth = 3;
+
+        // 显示队列中的一项
+        struct PresentItem {
+            AVFrame* frame = nullptr;
+            OverlayState state;
+            std::vector<AVFrame*> tiles;    // 拼接模式下各分块的帧
+            int columns = 0;
+        };
+
+        VideoRenderer();
+
+        // 按显示调度呈现一帧：未到显示时刻时重复显示上一帧，随后释放 item.frame
+        void present(PresentItem& item);
+        // 绘制并交换缓冲，record 为 false 表示为保持节奏的重复刷新
+        virtual void draw(const AVFrame* frame, const OverlayState& state, bool record) = 0;
+        // 绘制拼接画面，不支持的后端只给出提示
+        virtual void draw_tiles(const std::vector<AVFrame*>& frames, int columns, const OverlayState& state);
+        // 窗口尺寸变化，在事件线程调用
+        virtual void on_window_resized(int w, int h) { (void)w; (void)h; }
+
+        // 处理一个窗口事件，收到退出事件时返回 false
+        bool process_event(const SDL_Event& event);
+        void post_seek(float ratio, bool preview);
+        void log_pacing_stats() const;
+        // 跳转后的第一帧显示完成，记录跳转到显示的延迟
+        void report_seek(const OverlayState& state);
+        static void release(PresentItem& item);
+
+        SDL_Window* window = nullptr;
+        std::unique_ptr<PresentScheduler> scheduler;
+        std::unique_ptr<BoundedQueue<PresentItem>> present_queue;
+        std::atomic<bool> show_stats{false};
+
+    private:
+        CommandBus command_bus;
+        std::atomic<size_t> queued_frame_bytes{0};  // 最近提交的一项的帧内存，估算队列占用
+        std::atomic<size_t> queue_depth{PresentQueueDepth};
+        bool scrubbing = false;             // 正在拖动进度条，仅在事件线程访问
+        OverlayState shown_state;
+    };
+
+} // namespace video
+
+#endif //VIDEOPLAYER_VIDEORENDERER_H
@@ -0,0 +1,17 @@
+//
+// Created by WeiChuandong on 2025/3/20.
+//
+
+#ifndef VIDEOPLAYER_BUILTINFILTERS_H
+#define VIDEOPLAYER_BUILTINFILTERS_H
+
+#include "video/filters/FilterManager.h"
+
+namespace video {
+
+    // 注册内置滤镜，交互播放与离线转码共用同一套滤镜
+    void registerBuiltinFilters(FilterManager& manager);
+
+}
+
+#endif //VIDEOPLAYER_BUILTINFILTERS_H
@@ -6,12 +6,29 @@
 #define VIDEOPLAYER_FILTER_H
 
 #include <string>
+#include <vector>
 extern "C" {
 #include <libavfilter/avfilter.h>
 }
 
 namespace video {
 
+    // 可在运行时调整的滤镜参数
+    struct FilterParam {
+        std::string name;
+        float value;
+        float minValue;
+        float maxValue;
+        float step;         // 键盘每次调整的步长
+    };
+
+    // 运行时发送给滤镜图的命令，target 为滤镜描述中 "filter@tag" 的 tag
+    struct FilterCommand {
+        std::string target;
+        std::string command;
+        std::string arg;
+    };
+
     class Filter {
     public:
         virtual ~Filter() = default;
@@ -21,6 +38,13 @@ namespace video {
 
         // 获取滤镜字符串，用于FFmpeg的滤镜配置
         virtual std::string getFilterString() const = 0;
+
+        // 参数化接口，默认没有可调参数
+        virtual std::vector<FilterParam> getParams() const { return {}; }
+        virtual bool setParam(const std::string& name, float value) { return false; }
+
+        // 将当前参数转换为运行时命令；返回空表示需要重建滤镜图才能生效
+        virtual std::vector<FilterCommand> getParamCommands() const { return {}; }
     };
 
 };
@@ -18,18 +18,48 @@ extern "C" {
 #include <memory>
 #include <vector>
 #include <sstream>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
 #include "logger.h"
 
+#include "video/MemoryBudget.h"
 #include "video/filters/Filter.h"
 
 namespace video {
 
     class Filter;
 
-    class FilterManager {
+    // 一个已配置完成的滤镜图实例
+    struct FilterGraphInstance {
+        AVFilterGraph* graph = nullptr;
+        AVFilterContext* bufferSrcCtx = nullptr;
+        AVFilterContext* bufferSinkCtx = nullptr;
+        // 构建时的输入格式
+        int width = 0;
+        int height = 0;
+        int pixFormat = 0;
+
+        ~FilterGraphInstance() {
+            if (graph) avfilter_graph_free(&graph);
+        }
+    };
+
+    // 当前滤镜图登记到内存预算（按中间帧估算）
+    class FilterManager : public MemoryConsumer {
     public:
+        // 最近一次滤镜链请求的构建状态
+        enum class BuildStatus {
+            Pending,    // 尚未构建完成
+            Ready,      // 构建成功，已提交为当前滤镜链
+            Failed      // 构建失败，已回滚到之前的滤镜链
+        };
+
         FilterManager();
-        ~FilterManager();
+        ~FilterManager() override;
+
+        size_t memory_usage() const override { return graphBytes; }
 
         // 初始化滤镜管理器
         bool init(int width, int height, int pixFormat);
@@ -40,7 +70,8 @@ namespace video {
         // 注册滤镜
         void registerFilter(std::shared_ptr<Filter> filter);
 
-        // 激活/停用滤镜
+        // 激活/停用滤镜：只提交请求，返回 false 表示请求无效
+        // 构建结果通过 buildStatus()/waitForBuilds() 查询，失败时请求回滚到实际运行的滤镜链
         bool activateFilter(const std::string& filterName);
         bool deactivateFilter(const std::string& filterName);
 
@@ -49,21 +80,93 @@ namespace video {
         // 应用滤镜链处理帧
         AVFrame* applyFilters(AVFrame* frame);
 
-        // 判断该滤镜是否在使用
+        // 判断该滤镜是否在已构建成功的滤镜链中
         bool isFilterExists(const std::string& filterName);
+        // 判断该滤镜是否在最新的请求中（尚未构建完成的也算），用于按键开关
+        bool isFilterRequested(const std::string& filterName);
+
+        // 是否有构建成功的非空滤镜链（可在任意线程调用）
+        bool hasActiveChain() const { return chainActive; }
+
+        BuildStatus buildStatus();
+
+        // 运行时调整滤镜参数，通过滤镜命令下发到当前滤镜图，不触发重建
+        // animate 为 true 时在后续若干帧内平滑过渡到目标值
+        bool setFilterParam(const std::string& filterName, const std::string& paramName,
+                            float value, bool animate = false);
+        // 按参数步长调整（用于键盘连续调节）
+        bool adjustFilterParam(const std::string& filterName, const std::string& paramName, int steps);
+        // 读取参数值，尚未生效的目标值优先
+        bool getFilterParam(const std::string& filterName, const std::string& paramName, float& value);
+
+        // 等待所有已提交的滤镜链构建完成（离线处理时保证首帧即经过滤镜），返回最后一次构建是否成功
+        bool waitForBuilds();
+
+        // 滤镜图切片线程数，0 表示按 CPU 核数自动选择；修改后重建当前滤镜链
+        void setThreadCount(int threads);
+        int getThreadCount() const { return threadCount; }
 
         // 获取滤镜信息
         std::vector<std::string> getAvailableFilters() const;
         std::vector<std::string> getActiveFilters() const;
 
     private:
-        // 重建滤镜链
+        // 重建滤镜链：只提交滤镜描述，实际构建在后台线程完成
         bool rebuildFilterChain();
 
-        AVFilterGraph* filterGraph;
-        AVFilterContext* bufferSrcCtx;
-        AVFilterContext* bufferSinkCtx;
+        // 后台构建线程，首次 rebuildFilterChain() 时启动
+        void buildLoop();
+        std::unique_ptr<FilterGraphInstance> buildGraph(const std::string& filtersDescStr,
+                                                        int graphWidth, int graphHeight, int graphPixFormat);
+        bool primeGraph(FilterGraphInstance& instance);
+
+        // 在两帧之间切换到新构建好的滤镜图
+        void swapPendingGraph();
+
+        // 推进参数动画并将变化下发到当前滤镜图（与 applyFilters 同线程）
+        void updateParams();
+        void sendCommands(FilterGraphInstance& instance, const std::vector<FilterCommand>& commands);
+
+        struct ParamTarget {
+            float value;
+            bool animate;
+        };
+        // 待生效的参数目标值，由 graphMutex 保护
+        std::map<std::pair<std::string, std::string>, ParamTarget> paramTargets;
+        std::atomic<bool> hasParamTargets{false};
+        // 新图切换后需要重新下发全部参数
+        bool resendParams = false;
+
+        // 当前使用的滤镜图，仅在 applyFilters 所在线程访问
+        std::unique_ptr<FilterGraphInstance> currentGraph;
+
+        // 构建完成、等待切换的滤镜图（nullptr 表示切换为直通）
+        std::mutex graphMutex;
+        std::unique_ptr<FilterGraphInstance> pendingGraph;
+        std::atomic<bool> hasPendingGraph{false};
+
+        // 构建请求，以下成员及 activeFilters、width/height/pixFormat 由 buildMutex 保护
+        std::thread buildThread;
+        std::mutex buildMutex;
+        std::condition_variable buildCond;
+        std::vector<std::string> requestedFilters;
+        // requestedDesc 对应的滤镜列表，构建成功后提交到 activeFilters
+        std::vector<std::string> requestedChain;
+        std::string requestedDesc;
+        uint64_t requestedVersion = 0;
+        uint64_t builtVersion = 0;
+        bool lastBuildSucceeded = true;
+        bool stopBuild = false;
+        std::condition_variable buildDoneCond;
+
+        // 滤镜图切片线程数
+        std::atomic<int> threadCount{0};
+
+        std::atomic<bool> chainActive{false};
+        std::atomic<size_t> graphBytes{0};
+
         std::map<std::string, std::shared_ptr<Filter>> filters;
+        // 已构建成功的滤镜列表
         std::vector<std::string> activeFilters;
         int width, height, pixFormat;
     };
@@ -24,7 +24,14 @@ namespace video {
 
         void setIntensity(float intensity);
 
+        std::vector<FilterParam> getParams() const override;
+        bool setParam(const std::string& name, float value) override;
+        std::vector<FilterCommand> getParamCommands() const override;
+
     private:
+        // hue 滤镜的饱和度参数
+        std::string saturation() const;
+
         float intensity;
     };
 }
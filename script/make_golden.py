@@ -0,0 +1,119 @@
+# 生成离屏渲染回归测试的参考片段与各滤镜的基准图（在根目录执行）
+#
+#   python3 script/make_golden.py
+#
+# 参考片段 tests/data/pattern.y4m：64x64 YUV420P 两帧，亮度为 4x4 像素的非对称渐变块，
+# 色度整帧均匀（线性过滤不会在块边缘混色），基准图按滤镜在 YUV 上的结果和着色器的
+# YUV->RGB 公式计算，与 GPU 的输出只差舍入，比较时允许 --golden-tolerance 2。
+# 也可以用 --dump-frames 从一次确认无误的离屏渲染导出基准图。
+
+import os
+
+WIDTH = 64
+HEIGHT = 64
+BLOCK = 4
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "tests")
+
+# 每帧的亮度函数（块坐标）与均匀色度
+FRAMES = [
+    (lambda bx, by: 16 + 12 * bx + 3 * by, 100, 160),
+    (lambda bx, by: 16 + 3 * bx + 12 * by, 150, 110),
+]
+
+
+def luma_plane(fn):
+    return [[fn(x // BLOCK, y // BLOCK) for x in range(WIDTH)] for y in range(HEIGHT)]
+
+
+def hflip(p):
+    return [row[::-1] for row in p]
+
+
+def vflip(p):
+    return p[::-1]
+
+
+# 与 src/filters 中的滤镜描述一致，只作用于亮度（色度均匀，几何变换不改变它）
+def hmirror(p):
+    half = len(p[0]) // 2
+    return [row[:half] + row[:half][::-1] for row in p]
+
+
+def vmirror(p):
+    half = len(p) // 2
+    return p[:half] + p[:half][::-1]
+
+
+def quadmirror(p):
+    # 左列 [hflip; vflip]，右列 [原图; hflip+vflip]，输出为两倍尺寸
+    left = hflip(p) + vflip(p)
+    right = p + vflip(hflip(p))
+    return [l + r for l, r in zip(left, right)]
+
+
+def downscale2(p):
+    # 渲染到 64x64 时线性过滤正好取 2x2 的平均，块按 4 像素对齐，每组 2x2 都相同
+    out = []
+    for y in range(0, len(p), 2):
+        row = []
+        for x in range(0, len(p[0]), 2):
+            assert p[y][x] == p[y][x + 1] == p[y + 1][x] == p[y + 1][x + 1]
+            row.append(p[y][x])
+        out.append(row)
+    return out
+
+
+FILTERS = {
+    "none": lambda p: p,
+    "vflip": vflip,
+    "hflip": hflip,
+    "hmirror": hmirror,
+    "vmirror": vmirror,
+    "quadmirror": lambda p: downscale2(quadmirror(p)),
+    "gray": lambda p: p,
+}
+
+
+def to_rgb(y, u, v):
+    # GLFrameRenderer 片段着色器的全范围 BT.601 公式
+    yf = y / 255.0
+    uf = u / 255.0 - 0.5
+    vf = v / 255.0 - 0.5
+    rgb = (yf + 1.402 * vf, yf - 0.344136 * uf - 0.714136 * vf, yf + 1.772 * uf)
+    return bytes(int(round(min(1.0, max(0.0, c)) * 255.0)) for c in rgb)
+
+
+def write_clip(path):
+    with open(path, "wb") as f:
+        f.write(b"YUV4MPEG2 W%d H%d F25:1 Ip A1:1 C420jpeg\n" % (WIDTH, HEIGHT))
+        for fn, u, v in FRAMES:
+            f.write(b"FRAME\n")
+            for row in luma_plane(fn):
+                f.write(bytes(row))
+            chroma = (WIDTH // 2) * (HEIGHT // 2)
+            f.write(bytes([u]) * chroma)
+            f.write(bytes([v]) * chroma)
+
+
+def write_golden(directory, name):
+    os.makedirs(directory, exist_ok=True)
+    for index, (fn, u, v) in enumerate(FRAMES):
+        if name == "gray":
+            # hue 滤镜 s=0 把色度置为 128，亮度不变
+            u = v = 128
+        plane = FILTERS[name](luma_plane(fn))
+        pixels = b"".join(to_rgb(y, u, v) for row in plane for y in row)
+        with open(os.path.join(directory, "frame_%06d.ppm" % index), "wb") as f:
+            f.write(b"P6\n%d %d\n255\n" % (WIDTH, HEIGHT))
+            f.write(pixels)
+
+
+def main():
+    os.makedirs(os.path.join(ROOT, "data"), exist_ok=True)
+    write_clip(os.path.join(ROOT, "data", "pattern.y4m"))
+    for name in FILTERS:
+        write_golden(os.path.join(ROOT, "golden", name), name)
+
+
+if __name__ == "__main__":
+    main()
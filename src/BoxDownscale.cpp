@@ -0,0 +1,70 @@
+//
+// Created by Weichuandong on 2025/3/30.
+//
+
+#include "video/BoxDownscale.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VIDEOPLAYER_BOX_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define VIDEOPLAYER_BOX_NEON 1
+#endif
+
+namespace video {
+
+    // 一行输出：每次 16 个源像素得到 8 个输出像素，返回已处理的输出像素数
+    static int box_row_simd(const uint8_t* row0, const uint8_t* row1, uint8_t* out, int count) {
+        int x = 0;
+#if defined(VIDEOPLAYER_BOX_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i ones = _mm_set1_epi16(1);
+        const __m128i round = _mm_set1_epi32(2);
+        for (; x + 8 <= count; x += 8) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 2));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 2));
+            // 纵向相加（16bit），再用 madd 横向两两相加（32bit）
+            const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            const __m128i sum_lo = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(lo, ones), round), 2);
+            const __m128i sum_hi = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(hi, ones), round), 2);
+            const __m128i packed = _mm_packs_epi32(sum_lo, sum_hi);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(packed, packed));
+        }
+#elif defined(VIDEOPLAYER_BOX_NEON)
+        for (; x + 8 <= count; x += 8) {
+            // 横向两两相加并扩展到 16bit，纵向相加后四舍五入右移 2 位
+            const uint16x8_t a = vpaddlq_u8(vld1q_u8(row0 + x * 2));
+            const uint16x8_t b = vpaddlq_u8(vld1q_u8(row1 + x * 2));
+            vst1_u8(out + x, vrshrn_n_u16(vaddq_u16(a, b), 2));
+        }
+#else
+        (void)row0; (void)row1; (void)out; (void)count;
+#endif
+        return x;
+    }
+
+    void box_downscale_2x(const uint8_t* src, int src_stride, int src_width, int src_height,
+                          uint8_t* dst, int dst_stride, int dst_width, int dst_height) {
+        // 源宽度为奇数或输出向上取整时，最后一列/行需要钳位，不能走 SIMD
+        const int simd_width = std::min(dst_width, src_width / 2);
+
+        for (int y = 0; y < dst_height; y++) {
+            const uint8_t* row0 = src + static_cast<ptrdiff_t>(std::min(y * 2, src_height - 1)) * src_stride;
+            const uint8_t* row1 = src + static_cast<ptrdiff_t>(std::min(y * 2 + 1, src_height - 1)) * src_stride;
+            uint8_t* out = dst + static_cast<ptrdiff_t>(y) * dst_stride;
+
+            int x = box_row_simd(row0, row1, out, simd_width);
+            for (; x < dst_width; x++) {
+                const int x0 = std::min(x * 2, src_width - 1);
+                const int x1 = std::min(x * 2 + 1, src_width - 1);
+                out[x] = static_cast<uint8_t>((row0[x0] + row0[x1] + row1[x0] + row1[x1] + 2) >> 2);
+            }
+        }
+    }
+
+} // namespace video
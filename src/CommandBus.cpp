@@ -0,0 +1,134 @@
+//
+// Created by Weichuandong on 2025/4/4.
+//
+
+#include "video/CommandBus.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace video {
+
+    namespace {
+        // 相对跳转的有符号秒数
+        double relative_seconds(const PlayerCommand& command) {
+            return command.event == PlayerEvent::SeekForward_5 ? command.value : -command.value;
+        }
+
+        bool is_relative_seek(PlayerEvent event) {
+            return event == PlayerEvent::SeekForward_5 || event == PlayerEvent::SeekBackWard_5;
+        }
+    }
+
+    PlayerCommand command_for_key(SDL_Keycode key) {
+        PlayerCommand command;
+        switch (key) {
+            case SDLK_SPACE: command.event = PlayerEvent::PlayPause; break;
+            case SDLK_ESCAPE: command.event = PlayerEvent::Quit; break;
+            case SDLK_BACKSPACE: command.event = PlayerEvent::Restart; break;
+            case SDLK_LEFT:
+                command.event = PlayerEvent::SeekBackWard_5;
+                command.value = RelativeSeekSeconds;
+                break;
+            case SDLK_RIGHT:
+                command.event = PlayerEvent::SeekForward_5;
+                command.value = RelativeSeekSeconds;
+                break;
+            case SDLK_COMMA:
+            case SDLK_PERIOD:
+                command.event = PlayerEvent::StepFrame;
+                command.arg = key == SDLK_PERIOD ? 1 : -1;
+                break;
+            case SDLK_MINUS:
+            case SDLK_EQUALS:
+                command.event = PlayerEvent::SpeedStep;
+                command.arg = key == SDLK_EQUALS ? 1 : -1;
+                break;
+            case SDLK_1: case SDLK_2: case SDLK_3: case SDLK_4:
+            case SDLK_5: case SDLK_6: case SDLK_7:
+                command.event = PlayerEvent::ToggleFilter;
+                command.arg = static_cast<int>(key - SDLK_1);
+                break;
+            case SDLK_LEFTBRACKET:
+            case SDLK_RIGHTBRACKET:
+                command.event = PlayerEvent::AdjustFilter;
+                command.arg = key == SDLK_RIGHTBRACKET ? 1 : -1;
+                break;
+            case SDLK_0: command.event = PlayerEvent::ClearFilters; break;
+            case SDLK_s: command.event = PlayerEvent::CycleScaler; break;
+            case SDLK_i: command.event = PlayerEvent::ToggleStats; break;
+            case SDLK_r: command.event = PlayerEvent::ToggleRecording; break;
+            default: break;
+        }
+        return command;
+    }
+
+    bool CommandBus::post(const PlayerCommand& command) {
+        if (queue.try_push(command)) return true;
+        // 只在第一次和之后每 100 次提示，避免输入风暴刷屏
+        if (dropped++ % 100 == 0) {
+            LOG_WARN("命令队列已满，丢弃命令 (累计 {})", dropped.load());
+        }
+        return false;
+    }
+
+    void CommandBus::drain(std::vector<PlayerCommand>& commands) {
+        commands.clear();
+        PlayerCommand command;
+        while (queue.try_pop(command)) {
+            if (!commands.empty() && merge(commands.back(), command)) {
+                if (commands.back().event == PlayerEvent::None) commands.pop_back();
+                continue;
+            }
+            commands.push_back(command);
+        }
+
+        // 跳转在整批命令中只保留最后一次（留在原位置），中间夹着其他命令时也不会排队逐个执行
+        const auto last_seek = std::find_if(commands.rbegin(), commands.rend(), [](const PlayerCommand& c) {
+            return c.event == PlayerEvent::Seek;
+        });
+        if (last_seek != commands.rend()) {
+            const auto keep = std::prev(last_seek.base());
+            commands.erase(std::remove_if(commands.begin(), keep, [](const PlayerCommand& c) {
+                return c.event == PlayerEvent::Seek;
+            }), keep);
+        }
+    }
+
+    bool CommandBus::merge(PlayerCommand& last, const PlayerCommand& next) {
+        if (is_relative_seek(last.event) && is_relative_seek(next.event)) {
+            const double seconds = relative_seconds(last) + relative_seconds(next);
+            last.event = seconds > 0.0 ? PlayerEvent::SeekForward_5
+                       : seconds < 0.0 ? PlayerEvent::SeekBackWard_5 : PlayerEvent::None;
+            last.value = std::abs(seconds);
+            return true;
+        }
+        if (last.event != next.event) return false;
+
+        switch (next.event) {
+            case PlayerEvent::Seek:
+                // 按到达顺序保留最新的一次：松开后又重新拖动时，之后的预览代表当前意图，
+                // 随后的松开会再发出最终跳转
+                last = next;
+                return true;
+            case PlayerEvent::PlayPause:
+                last.event = PlayerEvent::None;
+                return true;
+            case PlayerEvent::StepFrame:
+            case PlayerEvent::SpeedStep:
+            case PlayerEvent::AdjustFilter:
+                last.arg += next.arg;
+                if (last.arg == 0) last.event = PlayerEvent::None;
+                return true;
+            case PlayerEvent::Quit:
+            case PlayerEvent::Restart:
+            case PlayerEvent::ClearFilters:
+                return true;    // 重复的命令只执行一次
+            default:
+                return false;
+        }
+    }
+
+} // namespace video
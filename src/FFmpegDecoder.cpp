@@ -1,12 +1,39 @@
 #include "video/FFmpegDecoder.h"
 
+#include <algorithm>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+}
+
 
 namespace video {
 
-    FFmpegDecoder::FFmpegDecoder(const std::string& filepath) {
+    FFmpegDecoder::FFmpegDecoder(const std::string& filepath, const DecoderOptions& options) {
       /* 初始化 FFmpeg 并打开文件 */
+        // 网络文件经分块预读与磁盘缓存读取，服务器不支持范围请求时直接打开
+        if (options.network.enabled && ProgressiveInput::supports(filepath)) {
+            try {
+                network_input = std::make_unique<ProgressiveInput>(filepath, options.network);
+                fmt_ctx = avformat_alloc_context();
+                fmt_ctx->pb = network_input->avio();
+            } catch (const std::exception& e) {
+                LOG_WARN("不使用网络缓存，直接打开: {}", e.what());
+            }
+        }
+
+        // 直播源不在解封装层积累数据，探测到足够的流信息就开始播放
+        AVDictionary* format_options = nullptr;
+        if (options.lowLatency) {
+            av_dict_set(&format_options, "fflags", "+nobuffer", 0);
+            av_dict_set(&format_options, "probesize", "32768", 0);
+            av_dict_set(&format_options, "analyzeduration", "500000", 0);
+        }
+
         // 打开文件并查找视频流
-        if (avformat_open_input(&fmt_ctx, filepath.c_str(), nullptr, nullptr) != 0) {
+        const int opened = avformat_open_input(&fmt_ctx, filepath.c_str(), nullptr, &format_options);
+        av_dict_free(&format_options);
+        if (opened != 0) {
             throw std::runtime_error("无法打开文件");
         }
         avformat_find_stream_info(fmt_ctx, nullptr);
@@ -35,71 +62,278 @@ namespace video {
 
         codec_ctx = avcodec_alloc_context3(codec);
         avcodec_parameters_to_context(codec_ctx, codec_params);
+
+        // 支持直接渲染到用户缓冲的解码器才接管帧缓冲分配
+        codec_ctx->opaque = this;
+        if (codec->capabilities & AV_CODEC_CAP_DR1) {
+            codec_ctx->get_buffer2 = &FFmpegDecoder::get_buffer;
+        }
+
+        codec_ctx->thread_count = options.threads;
+        if (options.lowLatency) {
+            // 帧级多线程每个线程要先积累一帧才输出，直播只用片级多线程
+            codec_ctx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+            codec_ctx->thread_type = FF_THREAD_SLICE;
+        }
+
+        // 显示尺寸远小于视频时让解码器直接输出缩小的画面，跳过不需要的重建工作
+        if (options.targetWidth > 0 && options.targetHeight > 0) {
+            int level = 0;
+            while (level < codec->max_lowres &&
+                   (codec_params->width >> (level + 1)) >= options.targetWidth &&
+                   (codec_params->height >> (level + 1)) >= options.targetHeight) {
+                level++;
+            }
+            codec_ctx->lowres = level;
+            if (level > 0) {
+                LOG_INFO("低分辨率解码: {} 1/{} ({}x{})", codec->name, 1 << level,
+                         AV_CEIL_RSHIFT(codec_params->width, level), AV_CEIL_RSHIFT(codec_params->height, level));
+            }
+        }
+
         if (avcodec_open2(codec_ctx, codec, nullptr) < 0) {
             throw std::runtime_error("无法打开解码器");
         }
 
-        // 初始化图像转换器 (YUV → RGB)
-        sws_ctx = sws_getContext(
-            codec_ctx->width, codec_ctx->height, codec_ctx->pix_fmt,
-            codec_ctx->width, codec_ctx->height, AV_PIX_FMT_RGB24,
-            SWS_BILINEAR, nullptr, nullptr, nullptr
-        );
-
         // 滤镜管理
         filterManager.init(codec_ctx->width, codec_ctx->height, codec_ctx->pix_fmt);
+
+        MemoryBudget::shared().add(this, "pipeline");
     }
 
     FFmpegDecoder::~FFmpegDecoder() {
+        MemoryBudget::shared().remove(this);
       /* 释放 FFmpeg 资源 */
-        sws_freeContext(sws_ctx);
+        stop_filter_pipeline();
         avcodec_free_context(&codec_ctx);
         avformat_close_input(&fmt_ctx);
     }
 
+    int FFmpegDecoder::get_buffer(AVCodecContext* ctx, AVFrame* frame, int flags) {
+        auto* self = static_cast<FFmpegDecoder*>(ctx->opaque);
+        FrameBufferPool* pool = self->buffer_pool.load();
+
+        // 有滤镜时上传的是滤镜输出的新帧，解码到暂存缓冲没有收益，反而长期占用槽位
+        if (pool && !self->filterManager.hasActiveChain() &&
+            pool->supports(static_cast<AVPixelFormat>(frame->format)) &&
+            self->fill_from_pool(ctx, pool, frame)) {
+            return 0;
+        }
+        return avcodec_default_get_buffer2(ctx, frame, flags);
+    }
+
+    bool FFmpegDecoder::fill_from_pool(AVCodecContext* ctx, FrameBufferPool* pool, AVFrame* frame) {
+        const auto format = static_cast<AVPixelFormat>(frame->format);
+        int w = frame->width;
+        int h = frame->height;
+        int align[AV_NUM_DATA_POINTERS];
+        avcodec_align_dimensions2(ctx, &w, &h, align);
+
+        // 与 avcodec_default_get_buffer2 相同：加宽直到每个平面的行宽满足解码器的对齐要求
+        int linesize[4];
+        bool unaligned;
+        do {
+            if (av_image_fill_linesizes(linesize, format, w) < 0) return false;
+            w += w & ~(w - 1);
+            unaligned = false;
+            for (int i = 0; i < 4; i++) {
+                unaligned = unaligned || (linesize[i] % align[i]) != 0;
+            }
+        } while (unaligned);
+
+        ptrdiff_t linesizes[4];
+        for (int i = 0; i < 4; i++) linesizes[i] = linesize[i];
+        size_t plane_sizes[4];
+        if (av_image_fill_plane_sizes(plane_sizes, format, h, linesizes) < 0) return false;
+
+        // 所有平面放在同一块缓冲中，平面起始 64 字节对齐，末尾留出 SIMD 越界读取的余量
+        size_t offsets[4];
+        size_t total = 0;
+        for (int i = 0; i < 4; i++) {
+            offsets[i] = total;
+            if (plane_sizes[i]) total += FFALIGN(plane_sizes[i] + 16, 64);
+        }
+
+        AVBufferRef* buf = pool->acquire(total);
+        if (!buf) return false;
+
+        frame->buf[0] = buf;
+        for (int i = 0; i < 4; i++) {
+            frame->data[i] = plane_sizes[i] ? buf->data + offsets[i] : nullptr;
+            frame->linesize[i] = linesize[i];
+        }
+        frame->extended_data = frame->data;
+        return true;
+    }
+
     bool FFmpegDecoder::get_next_frame(uint8_t* rgb_buffer) {
+        return get_next_frame(rgb_buffer, codec_ctx->width * 3);
+    }
+
+    bool FFmpegDecoder::get_next_frame(RGBBuffer& rgb_buffer) {
+        if (!rgb_buffer.allocate(codec_ctx->width, codec_ctx->height)) return false;
+        return get_next_frame(rgb_buffer.data(), rgb_buffer.stride());
+    }
+
+    bool FFmpegDecoder::get_next_frame(uint8_t* rgb_buffer, int stride) {
         /* 解码下一帧并转换为 RGB */
-        AVPacket pkt;
         AVFrame* frame = av_frame_alloc();
 
-        while (av_read_frame(fmt_ctx, &pkt) >= 0) {
-            if (pkt.stream_index == video_stream_idx) {
-                avcodec_send_packet(codec_ctx, &pkt);
-                if (avcodec_receive_frame(codec_ctx, frame) == 0) {
-                    // 有效帧处理：计算并存储 PTS
-                    int64_t pts = frame->pts;
-                    if (pts == AV_NOPTS_VALUE) {
-                        pts = pkt.dts;  // 回退到解码时间戳
-                    }
-                    // 转换为秒并存储
-                    if (pts != AV_NOPTS_VALUE) {
-                        last_valid_pts = pts * av_q2d(stream_time_base);
-                        LOG_DEBUG("last_valid_pts = {}", last_valid_pts);
-                    } else {
-                        // 无有效时间戳时使用解码器内部计数
-                        last_valid_pts = codec_ctx->frame_number * av_q2d(codec_ctx->time_base);
-                        LOG_DEBUG("last_valid_pts = {}", last_valid_pts);
+        if (!decode_next(frame, last_valid_pts)) {
+            av_frame_free(&frame);
+            return false; // 文件结束
+        }
+        LOG_DEBUG("last_valid_pts = {}", last_valid_pts);
+
+        // 转换为RGB：按水平条带在线程池上并行
+        if (!rgb_converter) {
+            rgb_converter = std::make_unique<RGBConverter>();
+        }
+        const bool converted = rgb_converter->convert(frame, rgb_buffer, stride);
+        av_frame_free(&frame);
+        if (!converted) {
+            LOG_ERROR("RGB 转换失败");
+        }
+        return converted;
+    }
+
+    bool FFmpegDecoder::decode_next(AVFrame* frame, double& pts_seconds) {
+        while (true) {
+            // 先取解码器中已有的帧：一个数据包可能输出多帧，帧级多线程和 B 帧会延迟输出
+            const int ret = avcodec_receive_frame(codec_ctx, frame);
+            if (ret == 0) {
+                // 有效帧处理：计算并存储 PTS
+                pts_seconds = frame_seconds(frame, frame->pkt_dts);
+                // 预解码：目标之前的帧直接丢弃，不做滤镜、上传和 UI
+                if (preroll) {
+                    if (pts_seconds < preroll_target) {
+                        av_frame_unref(frame);
+                        preroll_frames++;
+                        continue;
                     }
-                    // 转换为RGB
-                    uint8_t* dst[] = {rgb_buffer};
-                    int dst_linesize[] = {codec_ctx->width * 3};
-                    sws_scale(sws_ctx, frame->data, frame->linesize,
-                              0, codec_ctx->height, dst, dst_linesize);
-                    av_frame_free(&frame);
+                    end_preroll();
+                }
+                return true;
+            }
+            if (ret == AVERROR_EOF) {
+                return false;   // 排空完毕，文件结束
+            }
+            if (ret != AVERROR(EAGAIN)) {
+                // 单帧解码错误，跳过该帧继续
+                LOG_WARN("解码失败: {}", av_err2str(ret));
+                if (decoder_draining) return false;
+                continue;
+            }
+            if (decoder_draining) {
+                return false;
+            }
+            if (!send_next_packet()) {
+                // 输入结束：送入空包，取出解码器中延迟的剩余帧
+                avcodec_send_packet(codec_ctx, nullptr);
+                decoder_draining = true;
+            }
+        }
+    }
+
+    bool FFmpegDecoder::send_next_packet() {
+        AVPacket pkt;
+
+        while (av_read_frame(fmt_ctx, &pkt) >= 0) {
+            if (pkt.stream_index != video_stream_idx) {
+                av_packet_unref(&pkt);
+                continue;
+            }
+            if (wait_keyframe || skip_level == DecodeSkip::NonKey) {
+                // 非关键帧不送入解码器，省去解析开销，也避免恢复完整解码时引用缺失的参考帧
+                if (!(pkt.flags & AV_PKT_FLAG_KEY)) {
                     av_packet_unref(&pkt);
-                    return true;
+                    continue;
                 }
+                wait_keyframe = false;
             }
+            if (packet_callback && pkt.pts != AV_NOPTS_VALUE) {
+                packet_callback(pkt.pts * av_q2d(stream_time_base));
+            }
+            if (preroll) {
+                // 显示时间早于目标的数据包只需作为参考帧解码，不被参考的直接跳过
+                const bool before_target = pkt.pts != AV_NOPTS_VALUE && pkt.pts + pkt.duration <= preroll_target_ts;
+                codec_ctx->skip_frame = before_target ? std::max(AVDISCARD_NONREF, skip_discard()) : skip_discard();
+                if (before_target && !(pkt.flags & AV_PKT_FLAG_KEY)) preroll_nonkey++;
+            }
+            // 调用前解码器已无待取的帧，不会返回 EAGAIN；损坏的数据包跳过
+            const int ret = avcodec_send_packet(codec_ctx, &pkt);
             av_packet_unref(&pkt);
+            if (ret < 0) {
+                LOG_WARN("送入数据包失败: {}", av_err2str(ret));
+                continue;
+            }
+            return true;
         }
-        av_frame_free(&frame);
-        return false; // 文件结束
+        return false;
+    }
+
+    double FFmpegDecoder::frame_seconds(const AVFrame* frame, int64_t dts) const {
+        int64_t pts = frame->pts;
+        if (pts == AV_NOPTS_VALUE) {
+            pts = dts;  // 回退到解码时间戳
+        }
+        // 转换为秒
+        if (pts != AV_NOPTS_VALUE) {
+            return pts * av_q2d(stream_time_base);
+        }
+        // 无有效时间戳时使用解码器内部计数
+        return codec_ctx->frame_number * av_q2d(codec_ctx->time_base);
+    }
+
+    bool FFmpegDecoder::preview_frame(double seconds, YUVData& yuv_data) {
+        if (!seek(seconds)) return false;
+
+        AVFrame* frame = av_frame_alloc();
+        AVPacket pkt;
+        bool decoded = false;
+        while (!decoded && av_read_frame(fmt_ctx, &pkt) >= 0) {
+            if (pkt.stream_index == video_stream_idx && (pkt.flags & AV_PKT_FLAG_KEY)) {
+                // 送入关键帧后立即排空，多线程解码器不必等到后续数据包就输出这一帧
+                avcodec_send_packet(codec_ctx, &pkt);
+                avcodec_send_packet(codec_ctx, nullptr);
+                decoded = avcodec_receive_frame(codec_ctx, frame) == 0;
+                if (decoded) {
+                    last_valid_pts = frame_seconds(frame, pkt.dts);
+                }
+                // 结束排空状态；读取位置已越过关键帧，后续解码需从下一个关键帧开始
+                avcodec_flush_buffers(codec_ctx);
+                decoder_draining = false;
+                wait_keyframe = true;
+            }
+            av_packet_unref(&pkt);
+        }
+
+        if (!decoded) {
+            av_frame_free(&frame);
+            return false;
+        }
+        apply_filters(frame, yuv_data);
+        return true;
     }
 
     int FFmpegDecoder::width() const {
         return codec_ctx ? codec_ctx->width : 0; // 返回视频宽度
     }
 
+    int FFmpegDecoder::lowres() const {
+        return codec_ctx ? codec_ctx->lowres : 0;
+    }
+
+    void FFmpegDecoder::set_decode_skip(DecodeSkip skip) {
+        if (!codec_ctx || skip == skip_level) return;
+        if (skip_level == DecodeSkip::NonKey) {
+            wait_keyframe = true;
+        }
+        skip_level = skip;
+        // 解码器每帧读取 skip_frame，修改立即生效，无需重新打开
+        codec_ctx->skip_frame = skip_discard();
+    }
+
     int FFmpegDecoder::height() const {
         return codec_ctx ? codec_ctx->height : 0; // 返回视频高度
     }
@@ -108,12 +342,24 @@ namespace video {
         return last_valid_pts;
     }
 
-    bool FFmpegDecoder::seek(double seconds) {
+    bool FFmpegDecoder::seek(double seconds, bool accurate) {
         if (!fmt_ctx || video_stream_idx < 0) return false;
 
         // 计算目标时间戳（基于流的时间基）
         int64_t target_pts = static_cast<int64_t>(seconds / av_q2d(fmt_ctx->streams[video_stream_idx]->time_base));
 
+        // 丢弃流水线中的旧帧
+        if (pipeline_depth > 0) {
+            flush_filter_pipeline();
+        }
+        decode_eof = false;
+        decoder_draining = false;
+        wait_keyframe = false;
+        if (preroll) {
+            preroll = false;
+            codec_ctx->skip_frame = skip_discard();
+        }
+
         // 清空解码器缓冲区
         avcodec_flush_buffers(codec_ctx);
 
@@ -125,50 +371,159 @@ namespace video {
             return false;
         }
 
-        last_valid_pts = target_pts;
+        if (accurate) {
+            // 半帧容差，时间戳取整误差不会导致多解码一帧
+            const AVRational rate = frame_rate();
+            const double half_frame = rate.num > 0 ? 0.5 * av_q2d(av_inv_q(rate)) : 0.0;
+            preroll = true;
+            preroll_target = seconds - half_frame;
+            preroll_target_ts = static_cast<int64_t>(preroll_target / av_q2d(stream_time_base));
+            preroll_frames = 0;
+            preroll_nonkey = 0;
+            preroll_start = std::chrono::steady_clock::now();
+        }
+
+        last_valid_pts = seconds;
         return true;
     }
 
+    AVDiscard FFmpegDecoder::skip_discard() const {
+        static const AVDiscard discard[] = {AVDISCARD_DEFAULT, AVDISCARD_NONREF, AVDISCARD_NONKEY};
+        return discard[static_cast<int>(skip_level)];
+    }
+
+    void FFmpegDecoder::end_preroll() {
+        preroll = false;
+        codec_ctx->skip_frame = skip_discard();
+        const double elapsed_ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - preroll_start).count();
+        LOG_INFO("精确跳转: 预解码 {} 帧, 目标前非关键包 {} 个, 耗时 {:.1f}ms", preroll_frames, preroll_nonkey, elapsed_ms);
+    }
+
     double FFmpegDecoder::duration() const {
         if (!fmt_ctx || video_stream_idx < 0) return 0.0;
         return fmt_ctx->duration * av_q2d(AV_TIME_BASE_Q);
     }
 
+    AVRational FFmpegDecoder::time_base() const {
+        return stream_time_base;
+    }
+
+    AVRational FFmpegDecoder::frame_rate() const {
+        if (!fmt_ctx || video_stream_idx < 0) return {0, 1};
+        return av_guess_frame_rate(fmt_ctx, fmt_ctx->streams[video_stream_idx], nullptr);
+    }
+
+    int FFmpegDecoder::pix_format() const {
+        return codec_ctx ? codec_ctx->pix_fmt : AV_PIX_FMT_NONE;
+    }
+
     bool FFmpegDecoder::get_next_frame(YUVData& yuv_data) {
+        if (pipeline_depth > 0) {
+            return get_next_frame_pipelined(yuv_data);
+        }
+
         AVFrame* frame = av_frame_alloc();
-        AVPacket pkt;
+        if (!decode_next(frame, last_valid_pts)) {
+            av_frame_free(&frame);
+            return false;
+        }
 
-        while (av_read_frame(fmt_ctx, &pkt) >= 0) {
-            if (pkt.stream_index == video_stream_idx) {
-                avcodec_send_packet(codec_ctx, &pkt);
-                if (avcodec_receive_frame(codec_ctx, frame) == 0) {
-                    // 有效帧处理：计算并存储 PTS
-                    int64_t pts = frame->pts;
-                    if (pts == AV_NOPTS_VALUE) {
-                        pts = pkt.dts;  // 回退到解码时间戳
-                    }
-                    // 转换为秒并存储
-                    if (pts != AV_NOPTS_VALUE) {
-                        last_valid_pts = pts * av_q2d(stream_time_base);
-                    } else {
-                        // 无有效时间戳时使用解码器内部计数
-                        last_valid_pts = codec_ctx->frame_number * av_q2d(codec_ctx->time_base);
-                    }
+        apply_filters(frame, yuv_data);
+        return true;
+    }
 
-                    AVFrame* filterFrame = filterManager.applyFilters(frame);
-                    yuv_data.frame = av_frame_clone(filterFrame);
+    void FFmpegDecoder::apply_filters(AVFrame* frame, YUVData& yuv_data) {
+        AVFrame* filterFrame = filterManager.applyFilters(frame);
+        yuv_data.frame = av_frame_clone(filterFrame);
 
-                    if (filterFrame != frame) {
-                        av_frame_free(&filterFrame);
-                    }
-                    av_frame_free(&frame);
-                    av_packet_unref(&pkt);
-                    return true;
-                }
-            }
-            av_packet_unref(&pkt);
+        if (filterFrame != frame) {
+            av_frame_free(&filterFrame);
         }
         av_frame_free(&frame);
-        return false;
+    }
+
+    bool FFmpegDecoder::get_next_frame_pipelined(YUVData& yuv_data) {
+        // 保持流水线充满：滤镜线程处理前一帧的同时，这里解码后续帧
+        // 内存紧张时减少在途帧，最少一帧（仍与滤镜线程重叠）
+        const size_t limit = memory_level == 0 ? pipeline_depth
+                           : memory_level == 1 ? std::max<size_t>(1, pipeline_depth / 2) : 1;
+        while (frames_in_flight < limit && !decode_eof) {
+            StageFrame item;
+            item.frame = av_frame_alloc();
+            if (!decode_next(item.frame, item.pts)) {
+                av_frame_free(&item.frame);
+                decode_eof = true;
+                break;
+            }
+            pipeline_frame_bytes = frame_memory(item.frame);
+            filter_input->push(item);
+            ++frames_in_flight;
+        }
+
+        if (frames_in_flight == 0) return false;
+
+        StageFrame item;
+        if (!filter_output->pop(item)) return false;
+        --frames_in_flight;
+
+        last_valid_pts = item.pts;
+        yuv_data.frame = item.frame;
+        return true;
+    }
+
+    void FFmpegDecoder::filter_loop() {
+        StageFrame item;
+        while (filter_input->pop(item)) {
+            AVFrame* filterFrame = filterManager.applyFilters(item.frame);
+            if (filterFrame != item.frame) {
+                av_frame_free(&item.frame);
+                item.frame = filterFrame;
+            }
+            if (!filter_output->push(item)) {
+                av_frame_free(&item.frame);
+            }
+        }
+    }
+
+    void FFmpegDecoder::setFilterPipeline(bool enable, size_t depth) {
+        stop_filter_pipeline();
+        if (!enable || depth == 0) return;
+
+        pipeline_depth = depth;
+        filter_input = std::make_unique<BoundedQueue<StageFrame>>(depth);
+        filter_output = std::make_unique<BoundedQueue<StageFrame>>(depth);
+        filter_thread = std::thread(&FFmpegDecoder::filter_loop, this);
+        LOG_INFO("Filter pipeline enabled, depth = {}", depth);
+    }
+
+    void FFmpegDecoder::flush_filter_pipeline() {
+        // 取回所有在途帧，滤镜线程处理完后即为空
+        while (frames_in_flight > 0) {
+            StageFrame item;
+            if (!filter_output->pop(item)) break;
+            av_frame_free(&item.frame);
+            --frames_in_flight;
+        }
+        frames_in_flight = 0;
+    }
+
+    void FFmpegDecoder::stop_filter_pipeline() {
+        if (pipeline_depth == 0) return;
+
+        flush_filter_pipeline();
+        filter_input->close();
+        filter_output->close();
+        if (filter_thread.joinable()) {
+            filter_thread.join();
+        }
+
+        StageFrame item;
+        while (filter_input->tryPop(item)) av_frame_free(&item.frame);
+        while (filter_output->tryPop(item)) av_frame_free(&item.frame);
+
+        filter_input.reset();
+        filter_output.reset();
+        pipeline_depth = 0;
     }
 } // namespace video
\ No newline at end of file
@@ -0,0 +1,453 @@
+//
+// Created by Weichuandong on 2025/3/29.
+//
+
+#include "video/GLFrameRenderer.h"
+
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+
+namespace video {
+
+// Vertex Shader（传递纹理坐标）
+    const char* vs_source = R"(
+#version 330 core
+layout(location = 0) in vec2 aPos;
+layout(location = 1) in vec2 aTexCoord;
+out vec2 TexCoord;
+void main() {
+    gl_Position = vec4(aPos, 0.0, 1.0);
+    TexCoord = aTexCoord;
+}
+)";
+
+// Fragment Shader（YUV→RGB转换），按平面布局和缩放卷积核通过宏选择变体
+    const char* fs_source = R"(
+in vec2 TexCoord;
+out vec4 FragColor;
+
+uniform sampler2D y_tex;
+uniform sampler2D u_tex;
+uniform sampler2D v_tex;
+uniform float sample_scale;     // 位深归一化系数
+uniform vec4 plane_xform[3];    // 各平面纹理坐标变换：xy 缩放，zw 偏移（裁剪 padding / 负跨度翻转）
+uniform float plane_limit[3];   // 各平面 u 坐标上限，避免线性过滤采到 padding
+
+vec2 plane_coord(int i) {
+    vec2 tc = TexCoord * plane_xform[i].xy + plane_xform[i].zw;
+    return vec2(min(tc.x, plane_limit[i]), tc.y);
+}
+
+#if defined(SCALER_BICUBIC) || defined(SCALER_LANCZOS)
+float kernel_weight(float x) {
+    x = abs(x);
+#if defined(SCALER_BICUBIC)
+    // Catmull-Rom
+    if (x < 1.0) return (1.5 * x - 2.5) * x * x + 1.0;
+    if (x < 2.0) return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+    return 0.0;
+#else
+    // Lanczos2
+    if (x < 1e-5) return 1.0;
+    if (x >= 2.0) return 0.0;
+    float px = 3.14159265 * x;
+    return 2.0 * sin(px) * sin(px * 0.5) / (px * px);
+#endif
+}
+
+// 4x4 邻域加权，逐纹素读取，列钳位在有效宽度内（不采到 padding）
+vec4 sample_plane(sampler2D tex, int i) {
+    vec2 tc = TexCoord * plane_xform[i].xy + plane_xform[i].zw;
+    ivec2 size = textureSize(tex, 0);
+    vec2 pos = tc * vec2(size) - 0.5;
+    vec2 base = floor(pos);
+    vec2 f = pos - base;
+    ivec2 max_texel = ivec2(int(plane_limit[i] * float(size.x)), size.y - 1);
+
+    float wx[4];
+    float wy[4];
+    for (int k = 0; k < 4; k++) {
+        wx[k] = kernel_weight(float(k - 1) - f.x);
+        wy[k] = kernel_weight(float(k - 1) - f.y);
+    }
+
+    vec4 sum = vec4(0.0);
+    float weight = 0.0;
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            ivec2 texel = clamp(ivec2(base) + ivec2(x - 1, y - 1), ivec2(0), max_texel);
+            float w = wx[x] * wy[y];
+            sum += texelFetch(tex, texel, 0) * w;
+            weight += w;
+        }
+    }
+    return sum / weight;
+}
+#else
+vec4 sample_plane(sampler2D tex, int i) {
+    return texture(tex, plane_coord(i));
+}
+#endif
+
+void main() {
+    float y = sample_plane(y_tex, 0).r * sample_scale;
+#if defined(LAYOUT_GRAY)
+    float u = 0.0;
+    float v = 0.0;
+#elif defined(LAYOUT_SEMI_PLANAR)
+    vec2 uv = sample_plane(u_tex, 1).rg * sample_scale - 0.5;
+    float u = uv.x;
+    float v = uv.y;
+#else
+    float u = sample_plane(u_tex, 1).r * sample_scale - 0.5;
+    float v = sample_plane(v_tex, 2).r * sample_scale - 0.5;
+#endif
+
+    float r = y + 1.402 * v;
+    float g = y - 0.344136 * u - 0.714136 * v;
+    float b = y + 1.772 * u;
+
+    FragColor = vec4(r, g, b, 1.0);
+}
+)";
+
+    GLFrameRenderer::GLFrameRenderer() {
+        // 编译着色器
+        compile_shaders();
+
+        // 创建平面顶点数据
+        float vertices[] = {
+                // 位置       // 纹理坐标
+                -1.0f,  1.0f, 0.0f, 0.0f, // 左上
+                1.0f,  1.0f, 1.0f, 0.0f, // 右上
+                -1.0f, -1.0f, 0.0f, 1.0f, // 左下
+                1.0f, -1.0f, 1.0f, 1.0f  // 右下
+        };
+
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+        // 位置属性
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)nullptr);
+        glEnableVertexAttribArray(0);
+        // 纹理坐标属性
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        // 创建 YUV 纹理
+        uploader = std::make_unique<GLFrameUploader>();
+
+        // 支持持久映射时，解码器可直接解码到上传暂存缓冲
+        if (GLStagingPool::is_available()) {
+            staging = std::make_unique<GLStagingPool>();
+            uploader->set_staging_pool(staging.get());
+        }
+
+        glGenQueries(TimerQueries, timer_queries);
+
+        init_ui_resources();
+    }
+
+    GLFrameRenderer::~GLFrameRenderer() {
+        // 清理UI资源
+        overlay.reset();
+        text_atlas.reset();
+
+        // 清理视频纹理
+        uploader.reset();
+        tiles.clear();
+        staging.reset();
+        for (auto& kernel_programs : video_programs) {
+            for (auto& vp : kernel_programs) {
+                glDeleteProgram(vp.program);
+            }
+        }
+        glDeleteQueries(TimerQueries, timer_queries);
+        glDeleteVertexArrays(1, &vao);
+        glDeleteBuffers(1, &vbo);
+    }
+
+    std::string GLFrameRenderer::format_time(double seconds) {
+        int total_seconds = static_cast<int>(seconds);
+        int hours = total_seconds / 3600;
+        int minutes = (total_seconds % 3600) / 60;
+        int secs = total_seconds % 60;
+
+        std::stringstream ss;
+        if (hours > 0) {
+            ss << hours << ":";
+        }
+        ss << std::setfill('0') << std::setw(2) << minutes << ":"
+           << std::setfill('0') << std::setw(2) << secs;
+        return ss.str();
+    }
+
+    void GLFrameRenderer::compile_shaders() {
+        GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex_shader, 1, &vs_source, nullptr);
+        glCompileShader(vertex_shader);
+
+        // 验证着色器编译是否成功
+        GLint success;
+        glGetShaderiv(vertex_shader, GL_COMPILE_STATUS, &success);
+        if(!success) {
+            char infoLog[512];
+            glGetShaderInfoLog(vertex_shader, 512, NULL, infoLog);
+            LOG_ERROR("顶点着色器编译失败: {}", infoLog);
+        }
+
+        // 每种卷积核 x 平面布局编译一个片段着色器变体
+        const char* kernel_defines[KernelCount] = {
+                "#version 330 core\n",
+                "#version 330 core\n#define SCALER_BICUBIC\n",
+                "#version 330 core\n#define SCALER_LANCZOS\n"
+        };
+        const char* layout_defines[] = {
+                "#define LAYOUT_PLANAR\n",
+                "#define LAYOUT_SEMI_PLANAR\n",
+                "#define LAYOUT_GRAY\n"
+        };
+        for (int k = 0; k < KernelCount; k++) {
+            for (int i = 0; i < static_cast<int>(ShaderLayout::Count); i++) {
+                const char* sources[] = {kernel_defines[k], layout_defines[i], fs_source};
+                GLuint fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+                glShaderSource(fragment_shader, 3, sources, nullptr);
+                glCompileShader(fragment_shader);
+
+                glGetShaderiv(fragment_shader, GL_COMPILE_STATUS, &success);
+                if(!success) {
+                    char infoLog[512];
+                    glGetShaderInfoLog(fragment_shader, 512, NULL, infoLog);
+                    LOG_ERROR("片段着色器编译失败: {}", infoLog);
+                }
+
+                GLuint program = glCreateProgram();
+                glAttachShader(program, vertex_shader);
+                glAttachShader(program, fragment_shader);
+                glLinkProgram(program);
+                glDeleteShader(fragment_shader);
+
+                // 采样器绑定固定的纹理单元，只需设置一次
+                glUseProgram(program);
+                glUniform1i(glGetUniformLocation(program, "y_tex"), 0);
+                glUniform1i(glGetUniformLocation(program, "u_tex"), 1);
+                glUniform1i(glGetUniformLocation(program, "v_tex"), 2);
+
+                VideoProgram& vp = video_programs[k][i];
+                vp.program = program;
+                vp.scale_loc = glGetUniformLocation(program, "sample_scale");
+                vp.xform_loc = glGetUniformLocation(program, "plane_xform");
+                vp.limit_loc = glGetUniformLocation(program, "plane_limit");
+            }
+        }
+        glUseProgram(0);
+
+        glDeleteShader(vertex_shader);
+    }
+
+    int GLFrameRenderer::kernel_index(ScaleFilter filter) {
+        switch (filter) {
+            case ScaleFilter::Bicubic: return 1;
+            case ScaleFilter::Lanczos: return 2;
+            default: return 0;
+        }
+    }
+
+    void GLFrameRenderer::poll_gpu_timer() {
+        // 只取已完成的结果，结果通常晚一到两帧
+        for (int i = 0; i < TimerQueries; i++) {
+            if (!timer_pending[i]) continue;
+            GLint available = 0;
+            glGetQueryObjectiv(timer_queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) continue;
+            GLuint64 elapsed_ns = 0;
+            glGetQueryObjectui64v(timer_queries[i], GL_QUERY_RESULT, &elapsed_ns);
+            gpu_ms = elapsed_ns / 1.0e6;
+            timer_pending[i] = false;
+        }
+    }
+
+    bool GLFrameRenderer::begin_gpu_timer() {
+        // 上一个查询仍未完成时跳过本帧计时，不等待
+        poll_gpu_timer();
+        const bool timing = !timer_pending[timer_index];
+        if (timing) glBeginQuery(GL_TIME_ELAPSED, timer_queries[timer_index]);
+        return timing;
+    }
+
+    void GLFrameRenderer::end_gpu_timer(bool timing) {
+        if (timing) {
+            glEndQuery(GL_TIME_ELAPSED);
+            timer_pending[timer_index] = true;
+            timer_index = (timer_index + 1) % TimerQueries;
+        }
+    }
+
+    void GLFrameRenderer::render_frame(const AVFrame* frame, int view_w, int view_h) {
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        const bool timing = begin_gpu_timer();
+
+        // 按原始像素布局上传，无需 CPU 转换；frame 为空时重绘上一帧
+        // 缩放方式只在新帧上切换，重绘沿用上一帧的纹理
+        bool ok = true;
+        if (frame) {
+            drawn = scaler_policy.update(requested_filter, prescale_enabled,
+                                         frame->width, frame->height, view_w, view_h,
+                                         gpu_ms, frame_budget_ms);
+            uploader->set_prescale(drawn.prescale_shift);
+            uploader->set_mipmaps(drawn.filter == ScaleFilter::Mipmap);
+            ok = uploader->upload(frame);
+            has_video = has_video || ok;
+        }
+        if (ok && has_video) {
+            draw_video(*uploader, drawn);
+        }
+
+        end_gpu_timer(timing);
+    }
+
+    void GLFrameRenderer::render_tiles(const std::vector<AVFrame*>& frames, int columns, int view_w, int view_h) {
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        const bool timing = begin_gpu_timer();
+
+        // 各分块共用着色器，每个分块有自己的纹理与缩放选择
+        const int count = static_cast<int>(frames.size());
+        const int rows = (count + columns - 1) / columns;
+        while (static_cast<int>(tiles.size()) < count) {
+            tiles.push_back(std::make_unique<Tile>());
+        }
+
+        for (int i = 0; i < count; i++) {
+            Tile& tile = *tiles[i];
+            // 分块边界按整数像素划分，GL 视口原点在左下角
+            const int col = i % columns;
+            const int row = i / columns;
+            const int x0 = col * view_w / columns;
+            const int x1 = (col + 1) * view_w / columns;
+            const int y0 = view_h - (row + 1) * view_h / rows;
+            const int y1 = view_h - row * view_h / rows;
+            glViewport(x0, y0, x1 - x0, y1 - y0);
+
+            const AVFrame* frame = frames[i];
+            if (frame) {
+                if (!tile.uploader) {
+                    tile.uploader = std::make_unique<GLFrameUploader>();
+                }
+                tile.drawn = tile.policy.update(requested_filter, prescale_enabled,
+                                                frame->width, frame->height, x1 - x0, y1 - y0,
+                                                gpu_ms / count, frame_budget_ms / count);
+                tile.uploader->set_prescale(tile.drawn.prescale_shift);
+                tile.uploader->set_mipmaps(tile.drawn.filter == ScaleFilter::Mipmap);
+                tile.has_video = tile.uploader->upload(frame) || tile.has_video;
+            }
+            if (tile.has_video) {
+                draw_video(*tile.uploader, tile.drawn);
+            }
+        }
+        glViewport(0, 0, view_w, view_h);
+
+        end_gpu_timer(timing);
+    }
+
+    void GLFrameRenderer::draw_video(const GLFrameUploader& source, const ScalerChoice& choice) {
+        const VideoProgram& vp = video_programs[kernel_index(choice.filter)][static_cast<int>(source.layout())];
+        glUseProgram(vp.program);
+        glUniform1f(vp.scale_loc, source.sample_scale());
+        glUniform4fv(vp.xform_loc, GLFrameUploader::MaxPlanes, source.plane_transforms());
+        glUniform1fv(vp.limit_loc, GLFrameUploader::MaxPlanes, source.plane_u_limits());
+        source.bind();
+
+        // 绘制全屏四边形
+        glBindVertexArray(vao);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+
+    void GLFrameRenderer::init_ui_resources() {
+        // 加载字体并预先光栅化常用字形 - 确保路径正确，这里使用默认大小14pt
+        try {
+            text_atlas = std::make_unique<GlyphAtlas>("./fonts/Roboto-Regular.ttf", 14);
+        } catch (const std::exception& e) {
+            LOG_ERROR("无法加载字体: {} ({})", e.what(), TTF_GetError());
+        }
+        overlay = std::make_unique<GLOverlay>(text_atlas.get());
+    }
+
+    void GLFrameRenderer::render_ui(const OverlayState& state, int w, int h, const PacingStats* pacing) {
+        const float progress = state.progress;
+        overlay->begin(w, h);
+
+        if (state.show_timeline) {
+            // 计算进度条位置
+            float bar_y = progress_bar_top(h);
+
+            // 进度条：宽度取整到像素，进度变化不足一个像素时叠加层无需重绘
+            overlay->add_rect(0.0f, bar_y, static_cast<float>(w), progress_style.height,
+                              progress_style.background_color);
+            overlay->add_rect(0.0f, bar_y, std::floor(w * progress), progress_style.height,
+                              progress_style.progress_color);
+
+            // 格式化并渲染时间文本
+            std::string time_text = format_time(state.current_time) + "/" + format_time(state.total_time) +
+                    speed_label(state.speed);
+            overlay->add_text(time_text, 10.0f, bar_y + progress_style.height + 5.0f, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+        } else if (state.live_latency >= 0.0) {
+            overlay->add_text(live_label(state.live_latency, state.speed), 10.0f,
+                              progress_bar_top(h) + progress_style.height + 5.0f, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+        }
+
+        // 上传统计，每 500ms 刷新一次文本，避免叠加层每帧重绘
+        if (show_stats) {
+            const auto now = std::chrono::steady_clock::now();
+            if (stats_text.empty() || now - stats_updated >= std::chrono::milliseconds(500)) {
+                const UploadStats& stats = uploader->stats();
+                std::stringstream ss;
+                ss << std::fixed << std::setprecision(2) << "upload " << stats.upload_ms << " ms  "
+                   << "gl calls " << stats.gl_calls << "  tex " << stats.tex_uploads
+                   << (stats.zero_copy ? "  zero-copy" : stats.pbo ? "  pbo" : "  direct")
+                   << "  ui redraws " << overlay->redraw_count()
+                   << "  |  " << scale_filter_name(drawn.filter);
+                if (uploader->prescaled() > 0) {
+                    ss << " (cpu 1/" << (1 << uploader->prescaled()) << ")";
+                }
+                ss << " gpu " << gpu_ms << " ms";
+                if (pacing) {
+                    ss << "  |  " << pacing->refresh_hz << " Hz  jitter " << pacing->jitter_ms
+                       << " ms  late " << pacing->late_frames << "  drop " << pacing->dropped_frames
+                       << "  repeat " << pacing->repeated_refreshes
+                       << "  seek " << pacing->seek_latency_ms << " ms";
+                }
+                stats_text = ss.str();
+                memory_text = MemoryBudget::shared().summary();
+                stats_updated = now;
+            }
+            overlay->add_text(stats_text, 10.0f, 10.0f, glm::vec4(1.0f, 1.0f, 0.0f, 1.0f));
+            overlay->add_text(memory_text, 10.0f, 30.0f, glm::vec4(1.0f, 1.0f, 0.0f, 1.0f));
+        }
+
+        // 添加调试坐标系参考
+        if (state.show_debug) {
+            // 四角红、绿、蓝、黄色矩形
+            overlay->add_rect(0.0f, 0.0f, 30.0f, 30.0f, glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+            overlay->add_rect(w - 30.0f, 0.0f, 30.0f, 30.0f, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f));
+            overlay->add_rect(0.0f, h - 30.0f, 30.0f, 30.0f, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+            overlay->add_rect(w - 30.0f, h - 30.0f, 30.0f, 30.0f, glm::vec4(1.0f, 1.0f, 0.0f, 1.0f));
+
+            // 屏幕中央十字参考线
+            overlay->add_rect(w / 2 - 1, 0, 2, h, glm::vec4(0.5f, 0.5f, 0.5f, 0.5f)); // 垂直线
+            overlay->add_rect(0, h / 2 - 1, w, 2, glm::vec4(0.5f, 0.5f, 0.5f, 0.5f)); // 水平线
+        }
+
+        // 所有 UI 一次合成
+        overlay->draw();
+    }
+
+} // namespace video
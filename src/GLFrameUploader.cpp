@@ -0,0 +1,496 @@
+//
+// Created by Weichuandong on 2025/3/24.
+//
+
+#include "video/GLFrameUploader.h"
+#include "video/BoxDownscale.h"
+
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+#include <libavutil/common.h>
+}
+
+namespace video {
+
+    GLFrameUploader::GLFrameUploader() {
+        // glTexStorage2D 分配不可变纹理，驱动无需在每次上传时检查重新分配
+        immutable_storage = GLEW_ARB_texture_storage || GLEW_VERSION_4_2;
+
+        glGenBuffers(PboCount, pbos);
+        LOG_INFO("纹理上传: PBO x{}, {}", PboCount, immutable_storage ? "immutable storage" : "glTexImage2D storage");
+        MemoryBudget::shared().add(this, "textures");
+    }
+
+    GLFrameUploader::~GLFrameUploader() {
+        MemoryBudget::shared().remove(this);
+        for (auto& set : storages) {
+            for (auto& storage : set) {
+                if (storage.texture) glDeleteTextures(1, &storage.texture);
+            }
+        }
+        glDeleteBuffers(PboCount, pbos);
+        sws_freeContext(fallback_sws);
+        av_frame_free(&fallback_frame);
+        av_frame_free(&prescale_frames[0]);
+        av_frame_free(&prescale_frames[1]);
+    }
+
+    bool GLFrameUploader::upload(const AVFrame* frame) {
+        if (!frame) return false;
+
+        auto start = std::chrono::steady_clock::now();
+
+        // 回收 GPU 已读取完毕的暂存槽位
+        if (staging) staging->recycle();
+
+        // 行宽不一定是 4 字节对齐（奇数宽度的色度平面）
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        // 窗口远小于视频时先缩小再上传，减少传输量
+        applied_prescale = 0;
+        if (prescale_shift > 0) {
+            if (const AVFrame* scaled = prescale(frame, prescale_shift)) {
+                frame = scaled;
+                applied_prescale = prescale_shift;
+            }
+        }
+
+        switch (frame->format) {
+            case AV_PIX_FMT_YUV420P:
+            case AV_PIX_FMT_YUVJ420P:
+                upload_frame<AV_PIX_FMT_YUV420P>(frame);
+                break;
+            case AV_PIX_FMT_YUV422P:
+            case AV_PIX_FMT_YUVJ422P:
+                upload_frame<AV_PIX_FMT_YUV422P>(frame);
+                break;
+            case AV_PIX_FMT_YUV444P:
+            case AV_PIX_FMT_YUVJ444P:
+                upload_frame<AV_PIX_FMT_YUV444P>(frame);
+                break;
+            case AV_PIX_FMT_YUV420P10LE:
+                upload_frame<AV_PIX_FMT_YUV420P10LE>(frame);
+                break;
+            case AV_PIX_FMT_YUV422P10LE:
+                upload_frame<AV_PIX_FMT_YUV422P10LE>(frame);
+                break;
+            case AV_PIX_FMT_YUV444P10LE:
+                upload_frame<AV_PIX_FMT_YUV444P10LE>(frame);
+                break;
+            case AV_PIX_FMT_NV12:
+                upload_frame<AV_PIX_FMT_NV12>(frame);
+                break;
+            case AV_PIX_FMT_P010LE:
+                upload_frame<AV_PIX_FMT_P010LE>(frame);
+                break;
+            case AV_PIX_FMT_GRAY8:
+                upload_frame<AV_PIX_FMT_GRAY8>(frame);
+                break;
+            default: {
+                const AVFrame* converted = convert_fallback(frame);
+                if (!converted) return false;
+                upload_frame<AV_PIX_FMT_YUV420P>(converted);
+                break;
+            }
+        }
+
+        upload_stats.upload_ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    bool GLFrameUploader::is_native_format(int format) {
+        switch (format) {
+            case AV_PIX_FMT_YUV420P:
+            case AV_PIX_FMT_YUVJ420P:
+            case AV_PIX_FMT_YUV422P:
+            case AV_PIX_FMT_YUVJ422P:
+            case AV_PIX_FMT_YUV444P:
+            case AV_PIX_FMT_YUVJ444P:
+            case AV_PIX_FMT_YUV420P10LE:
+            case AV_PIX_FMT_YUV422P10LE:
+            case AV_PIX_FMT_YUV444P10LE:
+            case AV_PIX_FMT_NV12:
+            case AV_PIX_FMT_P010LE:
+            case AV_PIX_FMT_GRAY8:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    template <AVPixelFormat Format>
+    void GLFrameUploader::upload_frame(const AVFrame* frame) {
+        using Traits = GLPixelFormatTraits<Format>;
+
+        const int chroma_width = AV_CEIL_RSHIFT(frame->width, Traits::chromaShiftW);
+        const int chroma_height = AV_CEIL_RSHIFT(frame->height, Traits::chromaShiftH);
+
+        PlaneUpload planes[MaxPlanes];
+        planes[0] = {frame->data[0], frame->width, frame->height, frame->linesize[0], Traits::luma};
+        for (int i = 1; i < Traits::planeCount; i++) {
+            planes[i] = {frame->data[i], chroma_width, chroma_height, frame->linesize[i], Traits::chroma};
+        }
+        upload_planes(planes, Traits::planeCount);
+
+        current_layout = Traits::layout;
+        current_scale = Traits::sampleScale;
+    }
+
+    GLFrameUploader::PlaneLayout GLFrameUploader::plan_plane(const PlaneUpload& plane, bool allow_padding) {
+        PlaneLayout layout;
+        const int bpp = plane.format.bytesPerPixel;
+        const int abs_stride = std::abs(plane.stride);
+        const size_t row_bytes = static_cast<size_t>(plane.width) * bpp;
+
+        // 负跨度（如 vflip 输出）时最低地址是最后一行，整块上传后在着色器中翻转
+        layout.contiguous = abs_stride % bpp == 0;
+        layout.flipped = layout.contiguous && plane.stride < 0;
+        layout.base = plane.stride >= 0 ? plane.data
+                                        : plane.data + static_cast<ptrdiff_t>(plane.height - 1) * plane.stride;
+        layout.bytes = layout.contiguous ? static_cast<size_t>(abs_stride) * (plane.height - 1) + row_bytes
+                                         : row_bytes * plane.height;
+        layout.row_length = layout.contiguous ? abs_stride / bpp : plane.width;
+        layout.tex_width = plane.width;
+
+        // padding 不大时直接把带 padding 的整行作为纹理宽度，传输为纯线性拷贝，着色器中裁掉多余部分
+        if (allow_padding && layout.contiguous && layout.row_length > plane.width &&
+            (layout.row_length - plane.width) * 4 <= plane.width) {
+            layout.tex_width = layout.row_length;
+        }
+        return layout;
+    }
+
+    void GLFrameUploader::upload_planes(const PlaneUpload* planes, int count) {
+        upload_stats.gl_calls = 1;      // upload() 中的 glPixelStorei
+        upload_stats.tex_uploads = 0;
+
+        // 切换到另一组纹理，避免覆盖仍在绘制中的纹理
+        current_set = (current_set + 1) % TextureSets;
+
+        PlaneLayout layouts[MaxPlanes];
+        // mipmap 会把 padding 列混入低层级，此时纹理宽度取实际宽度
+        for (int i = 0; i < count; i++) {
+            layouts[i] = plan_plane(planes[i], !mipmaps);
+            ensure_storage(storages[current_set][i], planes[i], layouts[i].tex_width);
+        }
+
+        // 超出内存预算时不再使用 PBO
+        const bool use_pbo = memory_level < 2;
+        if (!use_pbo && std::any_of(std::begin(pbo_sizes), std::end(pbo_sizes), [](size_t size) { return size > 0; })) {
+            release_pbos();
+        }
+
+        upload_stats.zero_copy = upload_from_staging(planes, layouts, count);
+        upload_stats.pbo = upload_stats.zero_copy || (use_pbo && upload_via_pbo(planes, layouts, count));
+        if (!upload_stats.pbo) {
+            // 客户端内存路径不能越界读取最后一行的 padding，纹理宽度取实际宽度
+            for (int i = 0; i < count; i++) {
+                layouts[i] = plan_plane(planes[i], false);
+                ensure_storage(storages[current_set][i], planes[i], layouts[i].tex_width);
+            }
+            upload_direct(planes, layouts, count);
+        }
+
+        if (mipmaps) {
+            for (int i = 0; i < count; i++) {
+                glBindTexture(GL_TEXTURE_2D, storages[current_set][i].texture);
+                glGenerateMipmap(GL_TEXTURE_2D);
+            }
+            upload_stats.gl_calls += count * 2;
+        }
+
+        // 每个平面的纹理坐标变换：裁掉 padding、处理翻转
+        for (int i = 0; i < MaxPlanes; i++) {
+            float* xform = plane_xforms[i];
+            if (i >= count) {
+                xform[0] = 1.0f; xform[1] = 1.0f; xform[2] = 0.0f; xform[3] = 0.0f;
+                plane_limits[i] = 1.0f;
+                continue;
+            }
+            const float tex_width = static_cast<float>(layouts[i].tex_width);
+            xform[0] = planes[i].width / tex_width;
+            xform[1] = layouts[i].flipped ? -1.0f : 1.0f;
+            xform[2] = 0.0f;
+            xform[3] = layouts[i].flipped ? 1.0f : 0.0f;
+            // 线性过滤时不采样到 padding 列
+            plane_limits[i] = xform[0] - 0.5f / tex_width;
+        }
+    }
+
+    void GLFrameUploader::ensure_storage(TextureStorage& storage, const PlaneUpload& plane, int tex_width) {
+        if (storage.texture && storage.width == tex_width && storage.height == plane.height &&
+            storage.internalFormat == plane.format.internalFormat && storage.mipmapped == mipmaps) {
+            return;
+        }
+
+        int levels = 1;
+        if (mipmaps) {
+            for (int size = std::max(tex_width, plane.height); size > 1; size >>= 1) levels++;
+        }
+
+        // 不可变纹理无法重新指定尺寸，需要重建纹理对象
+        if (storage.texture) glDeleteTextures(1, &storage.texture);
+        glGenTextures(1, &storage.texture);
+        glBindTexture(GL_TEXTURE_2D, storage.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+        if (immutable_storage) {
+            glTexStorage2D(GL_TEXTURE_2D, levels, plane.format.internalFormat, tex_width, plane.height);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, 0, plane.format.internalFormat, tex_width, plane.height, 0,
+                         plane.format.format, plane.format.type, nullptr);
+        }
+
+        storage.width = tex_width;
+        storage.height = plane.height;
+        storage.internalFormat = plane.format.internalFormat;
+        storage.mipmapped = mipmaps;
+        // mipmap 链约为基础层的 4/3
+        storage.bytes = static_cast<size_t>(tex_width) * plane.height * plane.format.bytesPerPixel;
+        if (mipmaps) storage.bytes += storage.bytes / 3;
+        update_memory_usage();
+    }
+
+    void GLFrameUploader::release_pbos() {
+        glDeleteBuffers(PboCount, pbos);
+        glGenBuffers(PboCount, pbos);
+        for (size_t& size : pbo_sizes) size = 0;
+        update_memory_usage();
+        LOG_INFO("内存紧张，释放上传 PBO");
+    }
+
+    void GLFrameUploader::update_memory_usage() {
+        size_t bytes = 0;
+        for (const auto& set : storages) {
+            for (const auto& storage : set) bytes += storage.bytes;
+        }
+        for (size_t size : pbo_sizes) bytes += size;
+        gpu_bytes = bytes;
+    }
+
+    bool GLFrameUploader::upload_from_staging(const PlaneUpload* planes, const PlaneLayout* layouts, int count) {
+        if (!staging) return false;
+
+        // 所有平面都必须位于暂存缓冲中（经过滤镜的帧不满足）
+        size_t offsets[MaxPlanes];
+        for (int i = 0; i < count; i++) {
+            if (!layouts[i].contiguous || !staging->offset_of(layouts[i].base, offsets[i])) return false;
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging->buffer());
+        upload_stats.gl_calls++;
+        for (int i = 0; i < count; i++) {
+            const PlaneUpload& plane = planes[i];
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, layouts[i].row_length);
+            glBindTexture(GL_TEXTURE_2D, storages[current_set][i].texture);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, layouts[i].tex_width, plane.height,
+                            plane.format.format, plane.format.type,
+                            reinterpret_cast<const void*>(offsets[i]));
+            upload_stats.gl_calls += 3;
+            upload_stats.tex_uploads++;
+        }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        // GPU 读取完成前，解码器不能复用该槽位
+        staging->fence(layouts[0].base);
+        upload_stats.gl_calls += 3;
+        return true;
+    }
+
+    bool GLFrameUploader::upload_via_pbo(const PlaneUpload* planes, const PlaneLayout* layouts, int count) {
+        // 计算各平面在 PBO 中的偏移（按原始跨度整行排列，16 字节对齐）
+        size_t offsets[MaxPlanes];
+        size_t total = 0;
+        for (int i = 0; i < count; i++) {
+            offsets[i] = total;
+            total += FFALIGN(static_cast<size_t>(layouts[i].row_length) * planes[i].format.bytesPerPixel *
+                             planes[i].height, 16);
+        }
+
+        current_pbo = (current_pbo + 1) % PboCount;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[current_pbo]);
+        upload_stats.gl_calls++;
+        if (pbo_sizes[current_pbo] < total) {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, total, nullptr, GL_STREAM_DRAW);
+            pbo_sizes[current_pbo] = total;
+            update_memory_usage();
+            upload_stats.gl_calls++;
+        }
+
+        // INVALIDATE 让驱动在缓冲仍被 GPU 使用时分配新存储，而不是等待
+        auto* dst = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total,
+                                                           GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        upload_stats.gl_calls++;
+        if (!dst) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            upload_stats.gl_calls++;
+            return false;
+        }
+
+        for (int i = 0; i < count; i++) {
+            const PlaneUpload& plane = planes[i];
+            const PlaneLayout& layout = layouts[i];
+            if (layout.contiguous) {
+                // 连同行尾 padding 整块拷贝
+                memcpy(dst + offsets[i], layout.base, layout.bytes);
+            } else {
+                const size_t row_bytes = static_cast<size_t>(plane.width) * plane.format.bytesPerPixel;
+                for (int y = 0; y < plane.height; y++) {
+                    memcpy(dst + offsets[i] + y * row_bytes, plane.data + y * plane.stride, row_bytes);
+                }
+            }
+        }
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        upload_stats.gl_calls++;
+
+        // 从 PBO 上传：每个平面一次调用，立即返回，数据传输由驱动异步完成
+        for (int i = 0; i < count; i++) {
+            const PlaneUpload& plane = planes[i];
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, layouts[i].row_length);
+            glBindTexture(GL_TEXTURE_2D, storages[current_set][i].texture);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, layouts[i].tex_width, plane.height,
+                            plane.format.format, plane.format.type,
+                            reinterpret_cast<const void*>(offsets[i]));
+            upload_stats.gl_calls += 3;
+            upload_stats.tex_uploads++;
+        }
+
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        upload_stats.gl_calls += 2;
+        return true;
+    }
+
+    void GLFrameUploader::upload_direct(const PlaneUpload* planes, const PlaneLayout* layouts, int count) {
+        for (int i = 0; i < count; i++) {
+            const PlaneUpload& plane = planes[i];
+            const PlaneLayout& layout = layouts[i];
+            glBindTexture(GL_TEXTURE_2D, storages[current_set][i].texture);
+            upload_stats.gl_calls++;
+
+            if (layout.contiguous) {
+                // 由 GL_UNPACK_ROW_LENGTH 跳过行尾 padding，整个平面一次上传
+                glPixelStorei(GL_UNPACK_ROW_LENGTH, layout.row_length);
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, plane.width, plane.height,
+                                plane.format.format, plane.format.type, layout.base);
+                upload_stats.gl_calls += 2;
+                upload_stats.tex_uploads++;
+            } else {
+                // 跨度不是像素大小的整数倍，只能逐行上传
+                glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+                upload_stats.gl_calls++;
+                for (int y = 0; y < plane.height; y++) {
+                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, plane.width, 1,
+                                    plane.format.format, plane.format.type, plane.data + y * plane.stride);
+                }
+                upload_stats.gl_calls += plane.height;
+                upload_stats.tex_uploads += plane.height;
+            }
+        }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        upload_stats.gl_calls++;
+    }
+
+    void GLFrameUploader::bind() const {
+        for (int i = 0; i < MaxPlanes; i++) {
+            glActiveTexture(GL_TEXTURE0 + i);
+            glBindTexture(GL_TEXTURE_2D, storages[current_set][i].texture);
+        }
+    }
+
+    const AVFrame* GLFrameUploader::prescale(const AVFrame* frame, int shift) {
+        int chroma_shift_w = 0, chroma_shift_h = 0, plane_count = 0;
+        switch (frame->format) {
+            case AV_PIX_FMT_YUV420P:
+            case AV_PIX_FMT_YUVJ420P:
+                chroma_shift_w = 1; chroma_shift_h = 1; plane_count = 3;
+                break;
+            case AV_PIX_FMT_YUV422P:
+            case AV_PIX_FMT_YUVJ422P:
+                chroma_shift_w = 1; plane_count = 3;
+                break;
+            case AV_PIX_FMT_YUV444P:
+            case AV_PIX_FMT_YUVJ444P:
+                plane_count = 3;
+                break;
+            case AV_PIX_FMT_GRAY8:
+                plane_count = 1;
+                break;
+            default:
+                return nullptr;
+        }
+
+        // 每一级输入为上一级输出，两个缓冲帧交替使用
+        const AVFrame* src = frame;
+        for (int level = 0; level < shift && level < 2; level++) {
+            const int width = AV_CEIL_RSHIFT(src->width, 1);
+            const int height = AV_CEIL_RSHIFT(src->height, 1);
+            AVFrame*& dst = prescale_frames[level];
+            if (!dst || dst->width != width || dst->height != height || dst->format != frame->format) {
+                av_frame_free(&dst);
+                dst = av_frame_alloc();
+                dst->width = width;
+                dst->height = height;
+                dst->format = frame->format;
+                if (av_frame_get_buffer(dst, 0) < 0) {
+                    av_frame_free(&dst);
+                    return nullptr;
+                }
+            }
+
+            for (int i = 0; i < plane_count; i++) {
+                const int sw = i == 0 ? 0 : chroma_shift_w;
+                const int sh = i == 0 ? 0 : chroma_shift_h;
+                box_downscale_2x(src->data[i], src->linesize[i],
+                                 AV_CEIL_RSHIFT(src->width, sw), AV_CEIL_RSHIFT(src->height, sh),
+                                 dst->data[i], dst->linesize[i],
+                                 AV_CEIL_RSHIFT(width, sw), AV_CEIL_RSHIFT(height, sh));
+            }
+            dst->pts = frame->pts;
+            src = dst;
+        }
+        return src;
+    }
+
+    const AVFrame* GLFrameUploader::convert_fallback(const AVFrame* frame) {
+        if (warned_format != frame->format) {
+            warned_format = frame->format;
+            const char* name = av_get_pix_fmt_name(static_cast<AVPixelFormat>(frame->format));
+            LOG_WARN("像素格式 {} 无原生上传路径，回退到 CPU 转换", name ? name : "unknown");
+        }
+
+        if (!fallback_frame || fallback_frame->width != frame->width || fallback_frame->height != frame->height) {
+            av_frame_free(&fallback_frame);
+            fallback_frame = av_frame_alloc();
+            fallback_frame->width = frame->width;
+            fallback_frame->height = frame->height;
+            fallback_frame->format = AV_PIX_FMT_YUV420P;
+            if (av_frame_get_buffer(fallback_frame, 0) < 0) {
+                av_frame_free(&fallback_frame);
+                return nullptr;
+            }
+        }
+
+        fallback_sws = sws_getCachedContext(fallback_sws, frame->width, frame->height,
+                                            static_cast<AVPixelFormat>(frame->format),
+                                            frame->width, frame->height, AV_PIX_FMT_YUV420P,
+                                            SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!fallback_sws) return nullptr;
+
+        sws_scale(fallback_sws, frame->data, frame->linesize, 0, frame->height,
+                  fallback_frame->data, fallback_frame->linesize);
+        return fallback_frame;
+    }
+
+} // namespace video
@@ -0,0 +1,302 @@
+//
+// Created by WeiChuandong on 2025/3/26.
+//
+
+#include "video/GLOverlay.h"
+#include "logger.h"
+
+#include <cstddef>
+#include <cstring>
+#include <glm/ext/matrix_clip_space.hpp>
+
+namespace video {
+
+    namespace {
+        const char* batch_vertex_shader = R"(
+#version 330 core
+layout(location=0) in vec2 aPos;
+layout(location=1) in vec2 aTexCoord;
+layout(location=2) in vec4 aColor;
+uniform mat4 projection;
+out vec2 TexCoord;
+out vec4 Color;
+void main() {
+    gl_Position = projection * vec4(aPos, 0.0, 1.0);
+    TexCoord = aTexCoord;
+    Color = aColor;
+}
+)";
+
+        // 图集只用 alpha：文字为覆盖率，白色像素处为 1（纯色矩形）
+        const char* batch_fragment_shader = R"(
+#version 330 core
+in vec2 TexCoord;
+in vec4 Color;
+out vec4 FragColor;
+uniform sampler2D atlas;
+void main() {
+    FragColor = vec4(Color.rgb, Color.a * texture(atlas, TexCoord).a);
+}
+)";
+
+        // 全屏三角形，顶点由 gl_VertexID 生成，无需顶点缓冲
+        const char* blit_vertex_shader = R"(
+#version 330 core
+out vec2 TexCoord;
+void main() {
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+    gl_Position = vec4(pos, 0.0, 1.0);
+    TexCoord = pos * 0.5 + 0.5;
+}
+)";
+
+        const char* blit_fragment_shader = R"(
+#version 330 core
+in vec2 TexCoord;
+out vec4 FragColor;
+uniform sampler2D overlay;
+void main() {
+    FragColor = texture(overlay, TexCoord);
+}
+)";
+
+        GLuint compile_program(const char* vs_source, const char* fs_source, const char* name) {
+            GLint success;
+            char infoLog[512];
+
+            GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+            glShaderSource(vs, 1, &vs_source, nullptr);
+            glCompileShader(vs);
+            glGetShaderiv(vs, GL_COMPILE_STATUS, &success);
+            if (!success) {
+                glGetShaderInfoLog(vs, 512, nullptr, infoLog);
+                LOG_ERROR("{}顶点着色器编译失败: {}", name, infoLog);
+            }
+
+            GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+            glShaderSource(fs, 1, &fs_source, nullptr);
+            glCompileShader(fs);
+            glGetShaderiv(fs, GL_COMPILE_STATUS, &success);
+            if (!success) {
+                glGetShaderInfoLog(fs, 512, nullptr, infoLog);
+                LOG_ERROR("{}片段着色器编译失败: {}", name, infoLog);
+            }
+
+            GLuint program = glCreateProgram();
+            glAttachShader(program, vs);
+            glAttachShader(program, fs);
+            glLinkProgram(program);
+            glGetProgramiv(program, GL_LINK_STATUS, &success);
+            if (!success) {
+                glGetProgramInfoLog(program, 512, nullptr, infoLog);
+                LOG_ERROR("{}着色器程序链接失败: {}", name, infoLog);
+            }
+
+            glDeleteShader(vs);
+            glDeleteShader(fs);
+            return program;
+        }
+    }
+
+    GLOverlay::GLOverlay(GlyphAtlas* atlas) : atlas(atlas) {
+        // 采样器和 uniform 位置只需获取/设置一次
+        batch_program = compile_program(batch_vertex_shader, batch_fragment_shader, "UI");
+        projection_loc = glGetUniformLocation(batch_program, "projection");
+        glUseProgram(batch_program);
+        glUniform1i(glGetUniformLocation(batch_program, "atlas"), 0);
+
+        blit_program = compile_program(blit_vertex_shader, blit_fragment_shader, "UI合成");
+        glUseProgram(blit_program);
+        glUniform1i(glGetUniformLocation(blit_program, "overlay"), 0);
+        glUseProgram(0);
+
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, u));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, r));
+        glEnableVertexAttribArray(2);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glGenVertexArrays(1, &blit_vao);
+        glBindVertexArray(0);
+
+        // 图集纹理只分配一次，之后只上传新增字形所在的行
+        glGenTextures(1, &atlas_texture);
+        glBindTexture(GL_TEXTURE_2D, atlas_texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        if (atlas) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, GlyphAtlas::AtlasSize, GlyphAtlas::AtlasSize, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        } else {
+            // 没有字体时用 1x1 白色纹理绘制矩形
+            const uint8_t white[4] = {255, 255, 255, 255};
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &fbo);
+    }
+
+    GLOverlay::~GLOverlay() {
+        glDeleteProgram(batch_program);
+        glDeleteProgram(blit_program);
+        glDeleteVertexArrays(1, &vao);
+        glDeleteVertexArrays(1, &blit_vao);
+        glDeleteBuffers(1, &vbo);
+        glDeleteTextures(1, &atlas_texture);
+        glDeleteTextures(1, &target_texture);
+        glDeleteFramebuffers(1, &fbo);
+    }
+
+    void GLOverlay::begin(int w, int h) {
+        width = w;
+        height = h;
+        vertices.clear();
+    }
+
+    void GLOverlay::push_quad(float x0, float y0, float x1, float y1,
+                              float u0, float v0, float u1, float v1, const glm::vec4& color) {
+        const Vertex quad[6] = {
+                {x0, y0, u0, v0, color.r, color.g, color.b, color.a},
+                {x1, y0, u1, v0, color.r, color.g, color.b, color.a},
+                {x0, y1, u0, v1, color.r, color.g, color.b, color.a},
+
+                {x0, y1, u0, v1, color.r, color.g, color.b, color.a},
+                {x1, y0, u1, v0, color.r, color.g, color.b, color.a},
+                {x1, y1, u1, v1, color.r, color.g, color.b, color.a}
+        };
+        vertices.insert(vertices.end(), quad, quad + 6);
+    }
+
+    void GLOverlay::add_rect(float x, float y, float w, float h, const glm::vec4& color) {
+        if (w <= 0.0f || h <= 0.0f) return;
+        const float u = atlas ? GlyphAtlas::WhiteU : 0.5f;
+        const float v = atlas ? GlyphAtlas::WhiteV : 0.5f;
+        push_quad(x, y, x + w, y + h, u, v, u, v, color);
+    }
+
+    float GLOverlay::add_text(const std::string& text, float x, float y, const glm::vec4& color) {
+        if (!atlas) return 0.0f;
+        quads.clear();
+        const float text_width = atlas->layout(text, x, y, quads);
+        for (const auto& q : quads) {
+            push_quad(q.x0, q.y0, q.x1, q.y1, q.u0, q.v0, q.u1, q.v1, color);
+        }
+        return text_width;
+    }
+
+    void GLOverlay::draw() {
+        if (width <= 0 || height <= 0) return;
+
+        ensure_target(width, height);
+
+        // 顶点完全相同说明画面不变，直接复用缓存纹理
+        const bool changed = !target_valid || vertices.size() != drawn_vertices.size() ||
+                             std::memcmp(vertices.data(), drawn_vertices.data(),
+                                         vertices.size() * sizeof(Vertex)) != 0;
+        if (changed) {
+            redraw();
+            drawn_vertices.swap(vertices);
+            target_valid = true;
+        }
+
+        // 缓存纹理为预乘 alpha，按预乘方式合成到视频画面上
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        glUseProgram(blit_program);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, target_texture);
+        glBindVertexArray(blit_vao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glDisable(GL_BLEND);
+    }
+
+    void GLOverlay::ensure_target(int w, int h) {
+        if (target_texture && target_width == w && target_height == h) return;
+
+        if (target_texture) glDeleteTextures(1, &target_texture);
+        glGenTextures(1, &target_texture);
+        glBindTexture(GL_TEXTURE_2D, target_texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+        // 绘制目标可能是离屏帧缓冲，完成后恢复原绑定
+        GLint previous_fbo = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target_texture, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            LOG_ERROR("UI 缓存帧缓冲不完整");
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, previous_fbo);
+
+        target_width = w;
+        target_height = h;
+        target_valid = false;
+    }
+
+    void GLOverlay::upload_atlas() {
+        int y0, y1;
+        if (!atlas || !atlas->take_dirty_rows(y0, y1)) return;
+        glBindTexture(GL_TEXTURE_2D, atlas_texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y0, GlyphAtlas::AtlasSize, y1 - y0,
+                        GL_RGBA, GL_UNSIGNED_BYTE, atlas->pixels() + y0 * GlyphAtlas::AtlasSize * 4);
+    }
+
+    void GLOverlay::redraw() {
+        ++redraws;
+
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        GLint previous_fbo = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, target_width, target_height);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        if (!vertices.empty()) {
+            glActiveTexture(GL_TEXTURE0);
+            upload_atlas();
+            glBindTexture(GL_TEXTURE_2D, atlas_texture);
+
+            // 流式顶点缓冲：容量不足时重新分配，否则孤立旧存储后写入
+            const size_t bytes = vertices.size() * sizeof(Vertex);
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            if (bytes > vbo_capacity) {
+                vbo_capacity = bytes * 2;
+            }
+            glBufferData(GL_ARRAY_BUFFER, vbo_capacity, nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices.data());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+            // 写入缓存纹理时得到预乘 alpha 结果
+            glEnable(GL_BLEND);
+            glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+            glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(target_width),
+                                              static_cast<float>(target_height), 0.0f);
+            glUseProgram(batch_program);
+            glUniformMatrix4fv(projection_loc, 1, GL_FALSE, &projection[0][0]);
+            glBindVertexArray(vao);
+            glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices.size()));
+            glBindVertexArray(0);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, previous_fbo);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    }
+
+} // namespace video
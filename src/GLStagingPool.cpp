@@ -0,0 +1,142 @@
+//
+// Created by WeiChuandong on 2025/3/25.
+//
+
+#include "video/GLStagingPool.h"
+#include "video/GLFrameUploader.h"
+
+extern "C" {
+#include <libavutil/common.h>
+}
+
+namespace video {
+
+    GLStagingPool::GLStagingPool(int slot_count) : slots(slot_count) {
+        // 存储在首次 acquire 得知帧大小后，由 recycle() 在 GL 线程分配
+        MemoryBudget::shared().add(this, "staging");
+    }
+
+    GLStagingPool::~GLStagingPool() {
+        MemoryBudget::shared().remove(this);
+        for (auto& slot : slots) {
+            if (slot.fence) glDeleteSync(slot.fence);
+        }
+        free_storage();
+    }
+
+    bool GLStagingPool::is_available() {
+        return GLEW_ARB_buffer_storage || GLEW_VERSION_4_4;
+    }
+
+    bool GLStagingPool::supports(AVPixelFormat format) const {
+        // 只有上传端能直接使用的格式才值得解码到暂存缓冲
+        return GLFrameUploader::is_native_format(format);
+    }
+
+    AVBufferRef* GLStagingPool::acquire(size_t size) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (disabled) return nullptr;
+        if (!mapped || size > slot_size) {
+            requested_size = std::max(requested_size, size);
+            return nullptr;
+        }
+
+        for (size_t i = 0; i < slots.size(); i++) {
+            Slot& slot = slots[i];
+            if (slot.referenced || slot.fence) continue;
+
+            AVBufferRef* buf = av_buffer_create(mapped + i * slot_size, size,
+                                                &GLStagingPool::release_buffer, this, 0);
+            if (!buf) return nullptr;
+            slot.referenced = true;
+            return buf;
+        }
+        return nullptr;
+    }
+
+    void GLStagingPool::release_buffer(void* opaque, uint8_t* data) {
+        // 可能在解码线程、滤镜线程或 FFmpeg 帧线程上调用
+        auto* pool = static_cast<GLStagingPool*>(opaque);
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->slots[(data - pool->mapped) / pool->slot_size].referenced = false;
+    }
+
+    void GLStagingPool::recycle() {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        bool all_free = true;
+        for (auto& slot : slots) {
+            if (slot.fence) {
+                GLenum status = glClientWaitSync(slot.fence, 0, 0);
+                if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+                    glDeleteSync(slot.fence);
+                    slot.fence = nullptr;
+                }
+            }
+            all_free = all_free && !slot.referenced && !slot.fence;
+        }
+
+        // 重新分配会使已发出的指针失效，只能在没有任何槽位被使用时进行
+        if (!disabled && requested_size > slot_size && all_free) {
+            disabled = !reallocate(requested_size);
+        }
+    }
+
+    bool GLStagingPool::reallocate(size_t size) {
+        free_storage();
+
+        slot_size = FFALIGN(size, 4096);
+        const size_t total = slot_size * slots.size();
+
+        // CLIENT_STORAGE 倾向于放在可缓存的系统内存中：解码器会回读参考帧，写合并内存上读取很慢
+        const GLbitfield map_flags = GL_MAP_WRITE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &gl_buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl_buffer);
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, total, nullptr, map_flags | GL_CLIENT_STORAGE_BIT);
+        mapped = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total, map_flags));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        if (!mapped) {
+            LOG_WARN("暂存缓冲映射失败，解码回退到默认内存");
+            free_storage();
+            return false;
+        }
+        LOG_INFO("解码暂存缓冲: {} x {:.1f} MB", slots.size(), slot_size / (1024.0 * 1024.0));
+        storage_bytes = total;
+        return true;
+    }
+
+    void GLStagingPool::free_storage() {
+        if (gl_buffer) {
+            if (mapped) {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl_buffer);
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            }
+            glDeleteBuffers(1, &gl_buffer);
+        }
+        gl_buffer = 0;
+        mapped = nullptr;
+        slot_size = 0;
+        storage_bytes = 0;
+    }
+
+    bool GLStagingPool::offset_of(const uint8_t* ptr, size_t& offset) const {
+        // mapped 只在 GL 线程上修改，这里无需加锁
+        if (!mapped || ptr < mapped || ptr >= mapped + slot_size * slots.size()) return false;
+        offset = ptr - mapped;
+        return true;
+    }
+
+    void GLStagingPool::fence(const uint8_t* ptr) {
+        size_t offset;
+        if (!offset_of(ptr, offset)) return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        Slot& slot = slots[offset / slot_size];
+        // 同一帧重复上传时只需等待最后一次
+        if (slot.fence) glDeleteSync(slot.fence);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+} // namespace video
@@ -0,0 +1,152 @@
+//
+// Created by WeiChuandong on 2025/3/26.
+//
+
+#include "video/GlyphAtlas.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace video {
+
+    namespace {
+        // 解码一个 UTF-8 字符，基本多文种平面之外的字符替换为 '?'（TTF 字形接口只接受 16 位码点）
+        uint16_t next_codepoint(const std::string& text, size_t& i) {
+            const auto c = static_cast<unsigned char>(text[i++]);
+            int extra = 0;
+            uint32_t cp = c;
+            if (c >= 0xF0) { extra = 3; cp = c & 0x07; }
+            else if (c >= 0xE0) { extra = 2; cp = c & 0x0F; }
+            else if (c >= 0xC0) { extra = 1; cp = c & 0x1F; }
+            else if (c >= 0x80) return '?';
+
+            for (int k = 0; k < extra; k++) {
+                if (i >= text.size()) return '?';
+                cp = (cp << 6) | (static_cast<unsigned char>(text[i++]) & 0x3F);
+            }
+            return cp > 0xFFFF ? '?' : static_cast<uint16_t>(cp);
+        }
+    }
+
+    GlyphAtlas::GlyphAtlas(const char* font_path, int font_size)
+        : atlas(AtlasSize * AtlasSize * 4, 0) {
+        if (TTF_Init() != 0) {
+            throw std::runtime_error("TTF_Init failed");
+        }
+        font = TTF_OpenFont(font_path, font_size);
+        if (!font) {
+            TTF_Quit();
+            throw std::runtime_error("无法加载字体文件");
+        }
+        font_height = TTF_FontHeight(font);
+
+        // (0,0) 处放一个不透明白色像素，纯色矩形可与文字共用同一张纹理批量绘制
+        std::memset(atlas.data(), 255, 4);
+        dirty_y0 = 0;
+        dirty_y1 = 1;
+
+        // 预先光栅化可打印 ASCII，时间、统计文本不会在播放中途触发光栅化
+        for (uint16_t cp = 32; cp < 127; cp++) {
+            glyph(cp);
+        }
+        MemoryBudget::shared().add(this, "glyphs");
+    }
+
+    GlyphAtlas::~GlyphAtlas() {
+        MemoryBudget::shared().remove(this);
+        if (font) TTF_CloseFont(font);
+        TTF_Quit();
+    }
+
+    float GlyphAtlas::layout(const std::string& text, float x, float y, std::vector<GlyphQuad>& quads) {
+        const float start_x = x;
+        x = static_cast<float>(static_cast<int>(x));
+        y = static_cast<float>(static_cast<int>(y));
+
+        uint16_t prev = 0;
+        size_t i = 0;
+        while (i < text.size()) {
+            const uint16_t cp = next_codepoint(text, i);
+            if (prev) x += TTF_GetFontKerningSizeGlyphs(font, prev, cp);
+            prev = cp;
+
+            const Glyph& g = glyph(cp);
+            if (g.drawable) {
+                quads.push_back({x, y, x + g.width, y + g.height, g.u0, g.v0, g.u1, g.v1});
+            }
+            x += g.advance;
+        }
+        return x - start_x;
+    }
+
+    bool GlyphAtlas::take_dirty_rows(int& y0, int& y1) {
+        if (dirty_y0 >= dirty_y1) return false;
+        y0 = dirty_y0;
+        y1 = dirty_y1;
+        dirty_y0 = AtlasSize;
+        dirty_y1 = 0;
+        return true;
+    }
+
+    const GlyphAtlas::Glyph& GlyphAtlas::glyph(uint16_t codepoint) {
+        auto it = glyphs.find(codepoint);
+        if (it != glyphs.end()) return it->second;
+        return glyphs.emplace(codepoint, rasterize(codepoint)).first->second;
+    }
+
+    GlyphAtlas::Glyph GlyphAtlas::rasterize(uint16_t codepoint) {
+        Glyph g;
+        int minx, maxx, miny, maxy;
+        if (TTF_GlyphMetrics(font, codepoint, &minx, &maxx, &miny, &maxy, &g.advance) != 0) {
+            return g;
+        }
+
+        SDL_Surface* surface = TTF_RenderGlyph_Blended(font, codepoint, SDL_Color{255, 255, 255, 255});
+        if (!surface) return g;
+        SDL_Surface* rgba = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+        SDL_FreeSurface(surface);
+        if (!rgba) return g;
+
+        const int w = rgba->w;
+        const int h = rgba->h;
+
+        // 当前行放不下则换行，图集满时该字形不绘制
+        if (pen_x + w + 1 > AtlasSize) {
+            pen_x = 1;
+            pen_y += shelf_height + 1;
+            shelf_height = 0;
+        }
+        if (pen_y + h + 1 > AtlasSize || w + 2 > AtlasSize) {
+            LOG_WARN("字形图集已满，跳过字符 U+{:04X}", codepoint);
+            SDL_FreeSurface(rgba);
+            return g;
+        }
+
+        SDL_LockSurface(rgba);
+        for (int row = 0; row < h; row++) {
+            const auto* src = static_cast<const uint8_t*>(rgba->pixels) + row * rgba->pitch;
+            uint8_t* dst = atlas.data() + ((pen_y + row) * AtlasSize + pen_x) * 4;
+            std::memcpy(dst, src, w * 4);
+        }
+        SDL_UnlockSurface(rgba);
+        SDL_FreeSurface(rgba);
+
+        g.width = w;
+        g.height = h;
+        g.u0 = static_cast<float>(pen_x) / AtlasSize;
+        g.v0 = static_cast<float>(pen_y) / AtlasSize;
+        g.u1 = static_cast<float>(pen_x + w) / AtlasSize;
+        g.v1 = static_cast<float>(pen_y + h) / AtlasSize;
+        g.drawable = w > 0 && h > 0;
+
+        dirty_y0 = std::min(dirty_y0, pen_y);
+        dirty_y1 = std::max(dirty_y1, pen_y + h);
+
+        pen_x += w + 1;
+        shelf_height = std::max(shelf_height, h);
+        return g;
+    }
+
+} // namespace video
@@ -0,0 +1,196 @@
+//
+// Created by Weichuandong on 2025/3/29.
+//
+
+#include "video/HeadlessRunner.h"
+#include "video/filters/BuiltinFilters.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+
+namespace video {
+
+    HeadlessRunner::HeadlessRunner(const HeadlessOptions& options) : options(options) {
+        if (this->options.dumpEvery < 1) this->options.dumpEvery = 1;
+    }
+
+    HeadlessRunner::~HeadlessRunner() {
+        // 解码器持有的帧可能位于渲染器的暂存缓冲中，必须先于渲染器释放
+        decoder.reset();
+        renderer.reset();
+    }
+
+    bool HeadlessRunner::run() {
+        decoder = std::make_unique<FFmpegDecoder>(options.input);
+
+        // 与交互播放使用同一套滤镜
+        FilterManager& filterManager = decoder->getFilterManager();
+        registerBuiltinFilters(filterManager);
+        filterManager.setThreadCount(options.filterThreads);
+        for (const auto& name : options.filters) {
+            if (!filterManager.activateFilter(name)) {
+                return false;
+            }
+        }
+        if (!filterManager.waitForBuilds()) {
+            LOG_ERROR("滤镜链构建失败");
+            return false;
+        }
+
+        const int width = options.width > 0 ? options.width : decoder->width();
+        const int height = options.height > 0 ? options.height : decoder->height();
+        renderer = std::make_unique<OffscreenRenderer>(width, height, options.asyncReadback);
+        renderer->frame_renderer().set_scaler(options.scaleFilter, options.prescale);
+        if (options.zeroCopyDecode) {
+            decoder->setFrameBufferPool(renderer->frame_renderer().staging_pool());
+        }
+
+        if (!options.dumpDir.empty()) {
+            std::filesystem::create_directories(options.dumpDir);
+        }
+        const bool readback = !options.dumpDir.empty() || !options.goldenDir.empty();
+        const double duration = decoder->duration();
+
+        const auto start = std::chrono::steady_clock::now();
+        FFmpegDecoder::YUVData yuvData{};
+        while ((options.maxFrames <= 0 || frames_rendered < options.maxFrames) &&
+               decoder->get_next_frame(yuvData)) {
+            OverlayState state;
+            state.current_time = decoder->get_current_pts();
+            state.total_time = duration;
+            state.progress = duration > 0.0 ? static_cast<float>(state.current_time / duration) : 0.0f;
+
+            const bool read_this = readback && frames_rendered % options.dumpEvery == 0;
+            renderer->render(yuvData.frame, state, options.drawUi, read_this);
+            upload_ms_total += renderer->frame_renderer().upload_stats().upload_ms;
+            if (read_this) {
+                readback_frames.push_back(frames_rendered);
+            }
+            ++frames_rendered;
+
+            // 上传已完成，帧可立即归还解码器
+            av_frame_free(&yuvData.frame);
+
+            collect_readbacks(false);
+        }
+        collect_readbacks(true);
+        renderer->finish();
+
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        LOG_INFO("离屏渲染完成: {} 帧, {:.2f}s, {:.1f} fps, 平均上传 {:.3f}ms, 平均读回 {:.3f}ms ({} 帧)",
+                 frames_rendered, seconds, seconds > 0.0 ? frames_rendered / seconds : 0.0,
+                 frames_rendered > 0 ? upload_ms_total / frames_rendered : 0.0,
+                 frames_read > 0 ? readback_ms_total / frames_read : 0.0, frames_read);
+
+        if (!options.goldenDir.empty()) {
+            // 没有渲染出任何帧（解码失败、空输入）不能算通过；没有对应渲染帧的基准图按缺失计
+            if (frames_read == 0) {
+                LOG_ERROR("基准图比较: 没有读回任何帧");
+                return false;
+            }
+            std::error_code ec;
+            for (const auto& entry : std::filesystem::directory_iterator(options.goldenDir, ec)) {
+                const std::string name = entry.path().filename().string();
+                if (entry.path().extension() == ".ppm" && golden_compared.count(name) == 0) {
+                    LOG_WARN("基准图没有对应的渲染帧: {}", name);
+                    ++golden_missing;
+                }
+            }
+            LOG_INFO("基准图比较: {} 帧, 不一致 {}, 缺失 {}", frames_read, golden_mismatches, golden_missing);
+            return golden_mismatches == 0 && golden_missing == 0;
+        }
+        return true;
+    }
+
+    void HeadlessRunner::collect_readbacks(bool drain) {
+        while (!readback_frames.empty() && renderer->take_pixels(pixels, drain)) {
+            const int64_t index = readback_frames.front();
+            readback_frames.pop_front();
+            readback_ms_total += renderer->last_readback_ms();
+            ++frames_read;
+            handle_pixels(index, pixels);
+        }
+    }
+
+    std::string HeadlessRunner::frame_name(int64_t index) const {
+        std::stringstream ss;
+        ss << "frame_" << std::setfill('0') << std::setw(6) << index << ".ppm";
+        return ss.str();
+    }
+
+    bool HeadlessRunner::handle_pixels(int64_t index, const std::vector<uint8_t>& rgba) {
+        // 转为 PPM（P6，RGB）格式的完整文件内容，写出与比较都基于它
+        const int w = renderer->width();
+        const int h = renderer->height();
+        const std::string header = "P6\n" + std::to_string(w) + " " + std::to_string(h) + "\n255\n";
+        std::string image(header.size() + static_cast<size_t>(w) * h * 3, '\0');
+        memcpy(&image[0], header.data(), header.size());
+        uint8_t* rgb = reinterpret_cast<uint8_t*>(&image[header.size()]);
+        for (size_t i = 0, n = static_cast<size_t>(w) * h; i < n; i++) {
+            rgb[i * 3 + 0] = rgba[i * 4 + 0];
+            rgb[i * 3 + 1] = rgba[i * 4 + 1];
+            rgb[i * 3 + 2] = rgba[i * 4 + 2];
+        }
+
+        const std::string name = frame_name(index);
+        bool ok = true;
+
+        if (!options.dumpDir.empty()) {
+            std::ofstream out(std::filesystem::path(options.dumpDir) / name, std::ios::binary);
+            out.write(image.data(), static_cast<std::streamsize>(image.size()));
+            if (!out) {
+                LOG_ERROR("写入帧失败: {}", name);
+                ok = false;
+            }
+        }
+
+        if (!options.goldenDir.empty()) {
+            std::ifstream in(std::filesystem::path(options.goldenDir) / name, std::ios::binary);
+            if (!in) {
+                LOG_WARN("缺少基准图: {}", name);
+                ++golden_missing;
+                return false;
+            }
+            golden_compared.insert(name);
+            std::string golden((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            if (golden != image) {
+                if (golden.size() != image.size() || golden.compare(0, header.size(), header) != 0) {
+                    LOG_ERROR("帧 {} 与基准图尺寸不一致", index);
+                    ++golden_mismatches;
+                    return false;
+                }
+
+                // 统计超出容差的像素数便于定位
+                size_t differing = 0;
+                int max_error = 0;
+                const size_t pixel_count = static_cast<size_t>(w) * h;
+                for (size_t i = 0; i < pixel_count; i++) {
+                    int pixel_error = 0;
+                    for (size_t c = 0; c < 3; c++) {
+                        const size_t offset = header.size() + i * 3 + c;
+                        pixel_error = std::max(pixel_error, std::abs(static_cast<uint8_t>(golden[offset]) -
+                                                                     static_cast<uint8_t>(image[offset])));
+                    }
+                    max_error = std::max(max_error, pixel_error);
+                    if (pixel_error > options.goldenTolerance) ++differing;
+                }
+                if (differing > 0) {
+                    LOG_ERROR("帧 {} 与基准图不一致: {} / {} 个像素不同, 最大误差 {}",
+                              index, differing, pixel_count, max_error);
+                    ++golden_mismatches;
+                    ok = false;
+                }
+            }
+        }
+        return ok;
+    }
+
+} // namespace video
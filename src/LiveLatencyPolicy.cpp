@@ -0,0 +1,73 @@
+//
+// Created by Weichuandong on 2025/4/4.
+//
+
+#include "video/LiveLatencyPolicy.h"
+
+#include <algorithm>
+
+namespace video {
+
+    namespace {
+        // 追赶档位：平滑后的延迟超出目标 Enter 时升档，低于 Leave 时降档
+        constexpr double CatchUpSpeeds[] = {1.0, 1.05, 1.1, 1.25};
+        constexpr double Enter[] = {0.0, 0.03, 0.15, 0.3};
+        constexpr double Leave[] = {0.0, 0.01, 0.08, 0.2};
+        constexpr int LevelCount = sizeof(CatchUpSpeeds) / sizeof(CatchUpSpeeds[0]);
+        // 超出目标这么多时丢帧，余下部分交给加速
+        constexpr double DropExcess = 0.5;
+        // 基准每秒上调的量，跟随发送端与本机的时钟漂移
+        constexpr double BaselineDrift = 0.001;
+        // 时间戳跳跃超过该值认为源重新开始或切换
+        constexpr double DiscontinuitySeconds = 5.0;
+
+        const char* const LiveSchemes[] = {"udp://", "rtp://", "rtsp://", "rtsps://", "rtmp://", "srt://"};
+    }
+
+    bool is_live_url(const std::string& url) {
+        return std::any_of(std::begin(LiveSchemes), std::end(LiveSchemes),
+                           [&](const char* scheme) { return url.rfind(scheme, 0) == 0; });
+    }
+
+    LiveLatencyPolicy::LiveLatencyPolicy(double target_seconds)
+        : target_latency(std::max(0.0, target_seconds)) {
+    }
+
+    void LiveLatencyPolicy::on_packet(double pts) {
+        const double now = seconds(Clock::now());
+        const double arrival = now - pts;
+        const bool discontinuity = pts < last_packet_pts - 1.0 || pts > last_packet_pts + DiscontinuitySeconds;
+        if (!has_baseline || discontinuity) {
+            baseline = arrival;
+            has_baseline = true;
+            smoothed_latency = -1.0;
+        } else {
+            baseline = std::min(baseline + BaselineDrift * (now - last_packet_time), arrival);
+        }
+        last_packet_pts = pts;
+        last_packet_time = now;
+    }
+
+    bool LiveLatencyPolicy::update(double pts, double queued_seconds) {
+        if (!has_baseline) return true;
+
+        current_latency = std::max(0.0, seconds(Clock::now()) - pts - baseline + queued_seconds);
+        smoothed_latency = smoothed_latency < 0.0 ? current_latency
+                                                  : smoothed_latency + 0.1 * (current_latency - smoothed_latency);
+
+        if (current_latency - target_latency > DropExcess) {
+            dropped_frames++;
+            return false;
+        }
+
+        const double excess = smoothed_latency - target_latency;
+        while (level + 1 < LevelCount && excess > Enter[level + 1]) level++;
+        while (level > 0 && excess < Leave[level]) level--;
+        return true;
+    }
+
+    double LiveLatencyPolicy::speed() const {
+        return CatchUpSpeeds[level];
+    }
+
+} // namespace video
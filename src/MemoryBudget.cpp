@@ -0,0 +1,142 @@
+//
+// Created by Weichuandong on 2025/4/3.
+//
+
+#include "video/MemoryBudget.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+namespace video {
+
+    namespace {
+        constexpr double MB = 1024.0 * 1024.0;
+        // 进入各压力等级的占用比例，回落到更低的比例才退出，避免在阈值附近来回切换
+        constexpr double EnterRatio[MemoryBudget::PressureLevels] = {0.0, 0.85, 1.0};
+        constexpr double LeaveRatio[MemoryBudget::PressureLevels] = {0.0, 0.75, 0.9};
+    }
+
+    size_t frame_memory(const AVFrame* frame) {
+        if (!frame) return 0;
+        size_t bytes = 0;
+        for (const AVBufferRef* buf : frame->buf) {
+            if (buf) bytes += buf->size;
+        }
+        return bytes;
+    }
+
+    MemoryBudget& MemoryBudget::shared() {
+        static MemoryBudget budget;
+        return budget;
+    }
+
+    void MemoryBudget::set_limit(size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        limit_bytes = bytes;
+        last_update = {};
+        if (bytes > 0) {
+            LOG_INFO("内存预算: {:.0f} MB", bytes / MB);
+        }
+    }
+
+    size_t MemoryBudget::limit() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return limit_bytes;
+    }
+
+    void MemoryBudget::add(MemoryConsumer* consumer, const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.push_back(Entry{consumer, name});
+        // 预算已紧张时新登记的子系统直接按当前等级工作
+        if (level > 0) {
+            consumer->on_memory_pressure(level);
+        }
+    }
+
+    void MemoryBudget::remove(MemoryConsumer* consumer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [consumer](const Entry& entry) { return entry.consumer == consumer; }),
+                      entries.end());
+    }
+
+    size_t MemoryBudget::total_locked() const {
+        size_t total = 0;
+        for (const Entry& entry : entries) {
+            total += entry.consumer->memory_usage();
+        }
+        return total;
+    }
+
+    void MemoryBudget::update() {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto now = std::chrono::steady_clock::now();
+        if (limit_bytes == 0 || now - last_update < std::chrono::milliseconds(100)) return;
+        last_update = now;
+
+        const size_t total = total_locked();
+        const double ratio = static_cast<double>(total) / limit_bytes;
+
+        int target = 0;
+        while (target < PressureLevels - 1 && ratio > EnterRatio[target + 1]) target++;
+        if (target < level && ratio > LeaveRatio[level]) target = level;
+        if (target == level) return;
+
+        if (target > level) {
+            LOG_WARN("内存占用 {:.0f}/{:.0f} MB，压力等级 {}", total / MB, limit_bytes / MB, target);
+        } else {
+            LOG_INFO("内存占用回落 {:.0f}/{:.0f} MB，压力等级 {}", total / MB, limit_bytes / MB, target);
+        }
+        level = target;
+        for (const Entry& entry : entries) {
+            entry.consumer->on_memory_pressure(level);
+        }
+    }
+
+    int MemoryBudget::pressure() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return level;
+    }
+
+    std::vector<MemoryBudget::Usage> MemoryBudget::usage() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<Usage> result;
+        for (const Entry& entry : entries) {
+            auto it = std::find_if(result.begin(), result.end(),
+                                   [&entry](const Usage& usage) { return usage.name == entry.name; });
+            if (it == result.end()) {
+                result.push_back(Usage{entry.name, 0});
+                it = result.end() - 1;
+            }
+            it->bytes += entry.consumer->memory_usage();
+        }
+        std::sort(result.begin(), result.end(),
+                  [](const Usage& a, const Usage& b) { return a.bytes > b.bytes; });
+        return result;
+    }
+
+    std::string MemoryBudget::summary() const {
+        const std::vector<Usage> items = usage();
+        size_t total = 0;
+        for (const Usage& item : items) total += item.bytes;
+
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(0) << "mem " << total / MB;
+        const size_t budget = limit();
+        if (budget > 0) {
+            ss << "/" << budget / MB;
+        }
+        ss << " MB";
+        for (const Usage& item : items) {
+            ss << "  " << item.name << " " << std::setprecision(1) << item.bytes / MB;
+        }
+        return ss.str();
+    }
+
+} // namespace video
@@ -0,0 +1,213 @@
+//
+// Created by Weichuandong on 2025/4/2.
+//
+
+#include "video/MosaicPlayer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace video {
+
+    MosaicPlayer::MosaicPlayer(const std::vector<std::string>& files, const PlayerOptions& options)
+        : pool(ThreadPool::shared()) {
+        if (files.empty()) {
+            throw std::runtime_error("拼接播放需要至少一个视频文件");
+        }
+
+        // 接近正方形的网格
+        const int count = static_cast<int>(files.size());
+        columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+        const int rows = (count + columns - 1) / columns;
+
+        // 解码器单线程，由共享线程池并行各路；按分块尺寸低分辨率解码
+        DecoderOptions decoder_options;
+        decoder_options.threads = 1;
+        decoder_options.targetWidth = WindowWidth / columns;
+        decoder_options.targetHeight = WindowHeight / rows;
+        decoder_options.network.enabled = options.networkCache;
+        decoder_options.network.cacheDir = options.cacheDir;
+        decoder_options.network.cacheLimit = options.cacheLimit;
+
+        for (const auto& file : files) {
+            auto tile = std::make_unique<Tile>();
+            tile->path = file;
+            try {
+                tile->decoder = std::make_unique<FFmpegDecoder>(file, decoder_options);
+            } catch (const std::exception& e) {
+                // 单路打不开不影响其他路，该分块保持黑色
+                LOG_ERROR("无法打开 {}: {}", file, e.what());
+            }
+            tiles.push_back(std::move(tile));
+        }
+
+        renderer = std::make_unique<GLRenderer>(WindowWidth, WindowHeight, options.swapMode);
+        renderer->set_scaler(options.scaleFilter, options.prescale);
+        allowPrescale = options.prescale;
+
+        LOG_INFO("拼接播放: {} 路, {}x{} 网格, 解码线程池 {} 个线程", count, columns, rows, pool.size());
+    }
+
+    MosaicPlayer::~MosaicPlayer() {
+        // 等待池中的解码任务结束后再释放解码器
+        {
+            std::unique_lock<std::mutex> lock(task_mutex);
+            task_done.wait(lock, [this] { return tasks_in_flight == 0; });
+        }
+        for (auto& tile : tiles) {
+            for (auto& decoded : tile->ready) {
+                av_frame_free(&decoded.frame);
+            }
+        }
+        tiles.clear();
+        renderer.reset();
+    }
+
+    void MosaicPlayer::run() {
+        /* 主线程只处理窗口事件，选帧在播放线程，解码在线程池，绘制在渲染线程 */
+        std::thread playback(&MosaicPlayer::compose_loop, this);
+
+        while (!shouldQuit && renderer->handle_events()) {
+        }
+        shouldQuit = true;
+        renderer->close();
+
+        playback.join();
+    }
+
+    void MosaicPlayer::compose_loop() {
+        OverlayState state;
+        state.show_timeline = false;
+
+        while (!shouldQuit && apply_commands()) {
+            MemoryBudget::shared().update();
+            const Clock::time_point now = Clock::now();
+            // 最多睡眠 10ms，及时处理输入和新解码的帧
+            Clock::time_point next_due = now + std::chrono::milliseconds(10);
+
+            std::vector<AVFrame*> frames(tiles.size(), nullptr);
+            bool updated = needs_redraw;
+            needs_redraw = false;
+
+            for (size_t i = 0; i < tiles.size(); i++) {
+                Tile& tile = *tiles[i];
+                if (!is_paused) {
+                    std::lock_guard<std::mutex> lock(tile.mutex);
+                    // 取出已到显示时刻的帧，只显示最新的一帧，落后的帧直接丢弃
+                    while (!tile.ready.empty()) {
+                        const DecodedFrame& next = tile.ready.front();
+                        // 首帧、循环回到开头或时间戳跳跃时重新对齐时钟
+                        if (!tile.has_origin || next.pts < tile.last_pts || next.pts - tile.last_pts > 1.0) {
+                            tile.origin_pts = next.pts;
+                            tile.origin_time = now;
+                            tile.has_origin = true;
+                        }
+                        const auto due = tile.origin_time + std::chrono::duration_cast<Clock::duration>(
+                                std::chrono::duration<double>(next.pts - tile.origin_pts));
+                        if (due > now) {
+                            next_due = std::min(next_due, due);
+                            break;
+                        }
+                        av_frame_free(&frames[i]);
+                        frames[i] = next.frame;
+                        tile.last_pts = next.pts;
+                        tile.ready.pop_front();
+                    }
+                }
+                updated = updated || frames[i];
+                schedule_decode(tile);
+            }
+
+            if (updated) {
+                state.is_paused = is_paused;
+                // 显示队列满时在此阻塞，拼接画面的刷新不超过显示器刷新率
+                if (!renderer->submit_tiles(std::move(frames), columns, state)) break;
+            }
+            std::this_thread::sleep_until(next_due);
+        }
+        shouldQuit = true;
+    }
+
+    void MosaicPlayer::schedule_decode(Tile& tile) {
+        {
+            std::lock_guard<std::mutex> lock(tile.mutex);
+            if (!tile.decoder || tile.failed || tile.decoding || tile.ready.size() >= ReadyDepth) return;
+            tile.decoding = true;
+        }
+        {
+            std::lock_guard<std::mutex> lock(task_mutex);
+            ++tasks_in_flight;
+        }
+        pool.submit([this, &tile] {
+            decode_one(tile);
+            std::lock_guard<std::mutex> lock(task_mutex);
+            if (--tasks_in_flight == 0) task_done.notify_all();
+        });
+    }
+
+    void MosaicPlayer::decode_one(Tile& tile) {
+        FFmpegDecoder::YUVData yuvData{};
+        bool ok = tile.decoder->get_next_frame(yuvData);
+        if (!ok && !shouldQuit) {
+            // 到达结尾，从头循环
+            ok = tile.decoder->seek(0.0) && tile.decoder->get_next_frame(yuvData);
+        }
+
+        std::lock_guard<std::mutex> lock(tile.mutex);
+        if (ok) {
+            tile.ready.push_back(DecodedFrame{yuvData.frame, tile.decoder->get_current_pts()});
+            yuvData.frame = nullptr;
+        } else if (!shouldQuit) {
+            LOG_WARN("{} 无法继续解码，停止该路", tile.path);
+            tile.failed = true;
+        }
+        tile.decoding = false;
+    }
+
+    bool MosaicPlayer::apply_commands() {
+        // 拼接模式只响应暂停、缩放方式与统计，其余命令忽略
+        renderer->commands().drain(pending_commands);
+        for (const PlayerCommand& command : pending_commands) {
+            switch (command.event) {
+                case PlayerEvent::Quit: {
+                    LOG_INFO("退出拼接播放");
+                    return false;
+                }
+                case PlayerEvent::PlayPause: {
+                    is_paused = !is_paused;
+                    if (is_paused) {
+                        pause_start = Clock::now();
+                        LOG_INFO("拼接播放暂停");
+                    } else {
+                        // 各路时钟顺延暂停的时长
+                        const Clock::duration paused = Clock::now() - pause_start;
+                        for (auto& tile : tiles) {
+                            tile->origin_time += paused;
+                        }
+                        LOG_INFO("继续播放");
+                    }
+                    needs_redraw = true;
+                    break;
+                }
+                // 依次切换缩放方式
+                case PlayerEvent::CycleScaler: {
+                    const int next = (static_cast<int>(renderer->scaler()) + 1) % static_cast<int>(ScaleFilter::Count);
+                    renderer->set_scaler(static_cast<ScaleFilter>(next), allowPrescale);
+                    LOG_INFO("缩放方式: {}", scale_filter_name(static_cast<ScaleFilter>(next)));
+                    break;
+                }
+                // 显示/隐藏上传统计
+                case PlayerEvent::ToggleStats: {
+                    renderer->set_show_stats(!renderer->is_showing_stats());
+                    needs_redraw = true;
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+        return true;
+    }
+
+} // namespace video
@@ -0,0 +1,248 @@
+//
+// Created by Weichuandong on 2025/3/29.
+//
+
+#include "video/OffscreenRenderer.h"
+
+#include <EGL/eglext.h>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace video {
+
+    OffscreenRenderer::OffscreenRenderer(int width, int height, bool async_readback)
+        : target_width(width), target_height(height), async(async_readback) {
+        if (width <= 0 || height <= 0) {
+            throw std::runtime_error("离屏渲染尺寸无效");
+        }
+        init_egl();
+
+        // GLEW 按 GLX 构建时在 EGL 上下文里会报告 GLEW_ERROR_NO_GLX_DISPLAY，但核心函数已加载
+        glewExperimental = GL_TRUE;
+        const GLenum glew_status = glewInit();
+        if (glew_status != GLEW_OK && glew_status != GLEW_ERROR_NO_GLX_DISPLAY) {
+            throw std::runtime_error(std::string("GLEW 初始化失败: ") +
+                                     reinterpret_cast<const char*>(glewGetErrorString(glew_status)));
+        }
+        // 核心模式下 glewInit 会留下 GL_INVALID_ENUM
+        while (glGetError() != GL_NO_ERROR) {}
+
+        LOG_INFO("离屏渲染: {} / {}, {}x{}, {}读回",
+                 reinterpret_cast<const char*>(glGetString(GL_RENDERER)),
+                 reinterpret_cast<const char*>(glGetString(GL_VERSION)),
+                 width, height, async ? "PBO 异步" : "同步");
+
+        init_target();
+        renderer = std::make_unique<GLFrameRenderer>();
+    }
+
+    OffscreenRenderer::~OffscreenRenderer() {
+        renderer.reset();
+        release_target();
+
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+        if (surface != EGL_NO_SURFACE) eglDestroySurface(display, surface);
+        if (display != EGL_NO_DISPLAY) eglTerminate(display);
+    }
+
+    void OffscreenRenderer::init_egl() {
+        // 优先使用 Mesa surfaceless 平台，不依赖 X11/Wayland 和 DRM 设备
+        const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (get_platform_display && client_extensions &&
+            strstr(client_extensions, "EGL_MESA_platform_surfaceless")) {
+            display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+        if (display == EGL_NO_DISPLAY) {
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+
+        EGLint major = 0, minor = 0;
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+            throw std::runtime_error("无法初始化 EGL 显示");
+        }
+        if (!eglBindAPI(EGL_OPENGL_API)) {
+            throw std::runtime_error("EGL 不支持桌面 OpenGL");
+        }
+
+        const char* display_extensions = eglQueryString(display, EGL_EXTENSIONS);
+        const bool surfaceless = display_extensions && strstr(display_extensions, "EGL_KHR_surfaceless_context");
+
+        // 实际绘制目标是 FBO，窗口系统表面只在不支持 surfaceless 时创建一个 1x1 pbuffer
+        const EGLint config_attribs[] = {
+                EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+                EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                EGL_RED_SIZE, 8,
+                EGL_GREEN_SIZE, 8,
+                EGL_BLUE_SIZE, 8,
+                EGL_ALPHA_SIZE, 8,
+                EGL_NONE
+        };
+        EGLConfig config = nullptr;
+        EGLint config_count = 0;
+        if (!eglChooseConfig(display, config_attribs, &config, 1, &config_count) || config_count == 0) {
+            throw std::runtime_error("找不到可用的 EGL 配置");
+        }
+
+        const EGLint context_attribs[] = {
+                EGL_CONTEXT_MAJOR_VERSION, 3,
+                EGL_CONTEXT_MINOR_VERSION, 3,
+                EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                EGL_NONE
+        };
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attribs);
+        if (context == EGL_NO_CONTEXT) {
+            throw std::runtime_error("无法创建 OpenGL 3.3 核心模式上下文");
+        }
+
+        if (!surfaceless) {
+            const EGLint pbuffer_attribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+            surface = eglCreatePbufferSurface(display, config, pbuffer_attribs);
+            if (surface == EGL_NO_SURFACE) {
+                throw std::runtime_error("无法创建 EGL pbuffer");
+            }
+        }
+        if (!eglMakeCurrent(display, surface, surface, context)) {
+            throw std::runtime_error("无法激活 EGL 上下文");
+        }
+
+        LOG_INFO("EGL {}.{} ({}), {}", major, minor,
+                 eglQueryString(display, EGL_VENDOR), surfaceless ? "surfaceless" : "pbuffer");
+    }
+
+    void OffscreenRenderer::init_target() {
+        glGenRenderbuffers(1, &color_buffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, color_buffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, target_width, target_height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_buffer);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            throw std::runtime_error("离屏帧缓冲不完整");
+        }
+        // 之后始终绘制到该 FBO
+        glViewport(0, 0, target_width, target_height);
+
+        if (async) {
+            const GLsizeiptr bytes = static_cast<GLsizeiptr>(target_width) * target_height * 4;
+            for (auto& slot : slots) {
+                glGenBuffers(1, &slot.pbo);
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+                glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+    }
+
+    void OffscreenRenderer::release_target() {
+        for (auto& slot : slots) {
+            if (slot.fence) glDeleteSync(slot.fence);
+            if (slot.pbo) glDeleteBuffers(1, &slot.pbo);
+            slot = ReadbackSlot();
+        }
+        pending.clear();
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        if (color_buffer) glDeleteRenderbuffers(1, &color_buffer);
+        fbo = 0;
+        color_buffer = 0;
+    }
+
+    void OffscreenRenderer::render(const AVFrame* frame, const OverlayState& state, bool draw_ui, bool readback) {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+        renderer->render_frame(frame, target_width, target_height);
+        if (draw_ui) {
+            renderer->render_ui(state, target_width, target_height);
+        }
+
+        if (!readback) return;
+
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        if (!async) {
+            // 同步读回：等待绘制完成并拷贝到内存
+            const auto start = std::chrono::steady_clock::now();
+            std::vector<uint8_t> raw(static_cast<size_t>(target_width) * target_height * 4);
+            glReadPixels(0, 0, target_width, target_height, GL_RGBA, GL_UNSIGNED_BYTE, raw.data());
+            copy_flipped(raw.data(), sync_pixels);
+            sync_ready = true;
+            readback_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            return;
+        }
+
+        // 环形缓冲已满时先取走最早的一帧，由调用方保证及时 take_pixels
+        if (pending.size() == ReadbackSlots) {
+            LOG_WARN("读回缓冲已满，丢弃最早的一帧");
+            std::vector<uint8_t> discarded;
+            take_pixels(discarded, true);
+        }
+
+        // 读回到 PBO 立即返回，拷贝由 GPU/驱动异步完成
+        ReadbackSlot& slot = slots[next_slot];
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glReadPixels(0, 0, target_width, target_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+
+        pending.push_back(next_slot);
+        next_slot = (next_slot + 1) % ReadbackSlots;
+    }
+
+    bool OffscreenRenderer::take_pixels(std::vector<uint8_t>& rgba, bool drain) {
+        if (!async) {
+            if (!sync_ready) return false;
+            rgba.swap(sync_pixels);
+            sync_ready = false;
+            return true;
+        }
+
+        // 保持环形缓冲中有帧在途，读回与下一帧的绘制重叠
+        if (pending.empty()) return false;
+        if (!drain && pending.size() < ReadbackSlots - 1) return false;
+
+        const auto start = std::chrono::steady_clock::now();
+        ReadbackSlot& slot = slots[pending.front()];
+        pending.pop_front();
+
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        const GLsizeiptr bytes = static_cast<GLsizeiptr>(target_width) * target_height * 4;
+        const auto* mapped = static_cast<const uint8_t*>(
+                glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT));
+        bool ok = mapped != nullptr;
+        if (ok) {
+            copy_flipped(mapped, rgba);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        } else {
+            LOG_ERROR("映射读回缓冲失败");
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        readback_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return ok;
+    }
+
+    void OffscreenRenderer::finish() {
+        glFinish();
+    }
+
+    void OffscreenRenderer::copy_flipped(const uint8_t* src, std::vector<uint8_t>& rgba) const {
+        // GL 帧缓冲第 0 行在底部，翻转为与屏幕显示一致的自上而下顺序
+        const size_t row_bytes = static_cast<size_t>(target_width) * 4;
+        rgba.resize(row_bytes * target_height);
+        for (int y = 0; y < target_height; y++) {
+            memcpy(rgba.data() + y * row_bytes, src + (target_height - 1 - y) * row_bytes, row_bytes);
+        }
+    }
+
+} // namespace video
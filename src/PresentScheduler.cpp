@@ -0,0 +1,144 @@
+//
+// Created by WeiChuandong on 2025/3/28.
+//
+
+#include "video/PresentScheduler.h"
+#include "logger.h"
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace video {
+
+    namespace {
+        constexpr size_t IntervalWindow = 120;
+        // 新帧在理想时刻前 1/4 周期以内的刷新即可显示，避免理想时刻恰好落在两次刷新中间时节奏来回跳
+        constexpr double PhaseMargin = 0.25;
+        // 偏离超过该值认为时钟不连续
+        constexpr double ResyncSeconds = 0.25;
+
+        double seconds_between(PresentScheduler::Clock::time_point a, PresentScheduler::Clock::time_point b) {
+            return std::chrono::duration<double>(b - a).count();
+        }
+    }
+
+    PresentScheduler::PresentScheduler(SwapMode mode, double nominal_hz)
+        : swap_mode(mode),
+          nominal_period(1.0 / (nominal_hz > 0 ? nominal_hz : 60.0)),
+          period(nominal_period) {
+        intervals.reserve(IntervalWindow);
+        pacing.refresh_hz = 1.0 / period;
+    }
+
+    void PresentScheduler::apply_swap_interval() {
+        int interval = swap_mode == SwapMode::Off ? 0 : swap_mode == SwapMode::Adaptive ? -1 : 1;
+        if (SDL_GL_SetSwapInterval(interval) != 0) {
+            if (swap_mode == SwapMode::Adaptive && SDL_GL_SetSwapInterval(1) == 0) {
+                LOG_WARN("不支持自适应垂直同步，改用垂直同步");
+                swap_mode = SwapMode::VSync;
+            } else {
+                LOG_WARN("设置交换间隔失败: {}，按不同步调度", SDL_GetError());
+                swap_mode = SwapMode::Off;
+            }
+        }
+        const char* names[] = {"vsync", "adaptive", "off"};
+        LOG_INFO("显示调度: {}，标称刷新率 {:.2f}Hz", names[static_cast<int>(swap_mode)], 1.0 / nominal_period);
+    }
+
+    void PresentScheduler::begin_frame(double pts, double playback_speed) {
+        const Clock::time_point now = Clock::now();
+
+        // 首帧、跳转、时间戳回退、大幅跳跃或速度改变时重新对齐；快进时相邻帧的时间戳间隔按速度折算
+        bool resync = !has_origin || pts < last_pts || (pts - last_pts) / playback_speed > 1.0 ||
+                      playback_speed != speed;
+        if (!resync) {
+            const double offset = seconds_between(now, origin_time) + (pts - origin_pts) / playback_speed;
+            // 暂停恢复或解码卡顿导致严重滞后，不再追赶
+            resync = offset < -ResyncSeconds || offset > 1.0;
+        }
+        if (resync) {
+            origin_time = now;
+            origin_pts = pts;
+            has_origin = true;
+        }
+
+        speed = playback_speed;
+        last_pts = pts;
+        due_time = origin_time + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>((pts - origin_pts) / playback_speed));
+    }
+
+    bool PresentScheduler::is_late() const {
+        return has_origin && seconds_between(due_time, Clock::now()) > period;
+    }
+
+    bool PresentScheduler::should_hold() const {
+        if (swap_mode == SwapMode::Off || !has_swap) return false;
+        const double next_refresh = seconds_between(due_time, last_swap) + period;
+        return next_refresh < -PhaseMargin * period;
+    }
+
+    void PresentScheduler::wait_until_due() const {
+        if (swap_mode != SwapMode::Off) return;
+        std::this_thread::sleep_until(due_time);
+    }
+
+    void PresentScheduler::on_swap(bool new_frame) {
+        const Clock::time_point now = Clock::now();
+        if (has_swap && swap_mode != SwapMode::Off) {
+            update_period(seconds_between(last_swap, now));
+        }
+        last_swap = now;
+        has_swap = true;
+
+        if (!new_frame) return;
+
+        pacing.frames++;
+        const double error = seconds_between(due_time, now);
+        const double late_threshold = swap_mode == SwapMode::Off ? 0.005 : period;
+        if (error > late_threshold) pacing.late_frames++;
+
+        // 指数滑动平均估计偏差的均值和方差
+        const double alpha = 0.05;
+        const double delta = error - error_mean;
+        error_mean += alpha * delta;
+        error_var = (1.0 - alpha) * (error_var + alpha * delta * delta);
+        pacing.jitter_ms = std::sqrt(error_var) * 1000.0;
+    }
+
+    void PresentScheduler::on_repeat_swap() {
+        pacing.repeated_refreshes++;
+        on_swap(false);
+    }
+
+    void PresentScheduler::update_period(double interval) {
+        // 交换持续不阻塞说明垂直同步实际未生效，改为按时间睡眠，避免重复刷新时空转
+        short_swaps = interval < 0.25 * nominal_period ? short_swaps + 1 : 0;
+        if (short_swaps > 8) {
+            LOG_WARN("交换缓冲未按刷新率阻塞，改为按时间调度");
+            swap_mode = SwapMode::Off;
+            return;
+        }
+
+        // 只统计接近一个刷新周期的间隔，排除被阻塞或合并的交换
+        if (interval < 0.5 * nominal_period || interval > 1.5 * nominal_period) return;
+
+        if (intervals.size() < IntervalWindow) {
+            intervals.push_back(interval);
+        } else {
+            intervals[interval_pos] = interval;
+            interval_pos = (interval_pos + 1) % IntervalWindow;
+        }
+
+        // 取中位数，对个别抖动不敏感
+        if (intervals.size() >= 16 && ++samples % 16 == 0) {
+            std::vector<double> sorted(intervals);
+            std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+            period = sorted[sorted.size() / 2];
+            pacing.refresh_hz = 1.0 / period;
+        }
+    }
+
+} // namespace video
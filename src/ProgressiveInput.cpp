@@ -0,0 +1,439 @@
+//
+// Created by Weichuandong on 2025/4/4.
+//
+
+#include "video/ProgressiveInput.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "logger.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/mem.h>
+#include <libavutil/opt.h>
+}
+
+namespace video {
+
+    namespace {
+        // 下载标记文件头，源文件长度、内容类型、开头内容或块大小变化时旧缓存作废
+        // FFmpeg 的 http 协议不提供 ETag/Last-Modified，以开头内容的哈希代替
+        struct CacheHeader {
+            char magic[4];
+            uint32_t version;
+            int64_t size;
+            int64_t chunk_size;
+            uint64_t fingerprint;
+            char mime_type[64];
+        };
+        constexpr char CacheMagic[4] = {'G', 'P', 'C', 'C'};
+        constexpr uint32_t CacheVersion = 2;
+        constexpr uint8_t ChunkMark = 1;
+        // 计算校验哈希的文件开头字节数，不超过 avio 缓冲，读完后可在缓冲内退回开头
+        constexpr int FingerprintBytes = 4096;
+
+        uint64_t fnv1a(const uint8_t* data, size_t size) {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (size_t i = 0; i < size; i++) {
+                hash = (hash ^ data[i]) * 0x100000001b3ull;
+            }
+            return hash;
+        }
+
+        // 缓存文件实际占用的磁盘空间（稀疏文件未下载的部分不计）
+        int64_t allocated_bytes(const std::filesystem::path& path) {
+            struct stat st{};
+            if (::stat(path.c_str(), &st) != 0) return 0;
+            return static_cast<int64_t>(st.st_blocks) * 512;
+        }
+
+        // 按最后修改时间从旧到新删除其他 URL 的缓存，直到为即将写入的 reserve 字节腾出空间
+        void evict_cache(const std::filesystem::path& dir, const std::string& keep, int64_t limit, int64_t reserve) {
+            namespace fs = std::filesystem;
+            struct Entry {
+                fs::path data;
+                fs::file_time_type time;
+                int64_t bytes;
+            };
+            std::vector<Entry> entries;
+            int64_t used = 0;
+            std::error_code ec;
+            for (const auto& file : fs::directory_iterator(dir, ec)) {
+                const fs::path& path = file.path();
+                if (path.extension() != ".data" || path.stem() == keep) continue;
+                fs::path map = path;
+                map.replace_extension(".chunks");
+                const int64_t bytes = allocated_bytes(path) + allocated_bytes(map);
+                entries.push_back({path, fs::last_write_time(path, ec), bytes});
+                used += bytes;
+            }
+            if (used + reserve <= limit) return;
+
+            std::sort(entries.begin(), entries.end(),
+                      [](const Entry& a, const Entry& b) { return a.time < b.time; });
+            for (const auto& entry : entries) {
+                if (used + reserve <= limit) break;
+                fs::path map = entry.data;
+                map.replace_extension(".chunks");
+                fs::remove(map, ec);
+                if (fs::remove(entry.data, ec)) {
+                    used -= entry.bytes;
+                    LOG_INFO("网络缓存超出上限，删除 {} ({:.1f} MB)", entry.data.string(), entry.bytes / 1048576.0);
+                }
+            }
+        }
+
+        std::string cache_key(const std::string& url) {
+            char key[32];
+            snprintf(key, sizeof(key), "%016llx",
+                     static_cast<unsigned long long>(std::hash<std::string>{}(url)));
+            return key;
+        }
+    }
+
+    bool ProgressiveInput::supports(const std::string& url) {
+        return url.rfind("http://", 0) == 0 || url.rfind("https://", 0) == 0;
+    }
+
+    ProgressiveInput::ProgressiveInput(const std::string& url, const ProgressiveOptions& options)
+        : url(url), options(options) {
+        this->options.fetchThreads = std::max(1, options.fetchThreads);
+        this->options.readAheadChunks = std::max(1, options.readAheadChunks);
+        this->options.chunkSize = std::max<int64_t>(IOBufferSize, options.chunkSize);
+        interrupt_cb.callback = &ProgressiveInput::interrupt;
+        interrupt_cb.opaque = this;
+        avformat_network_init();
+
+        try {
+            // 探测长度与是否支持范围请求，这个连接留给第一个下载线程
+            AVIOContext* probe = connect(0);
+            if (!probe) {
+                throw std::runtime_error("无法连接 " + url);
+            }
+            total_size = avio_size(probe);
+            if (total_size <= 0 || !(probe->seekable & AVIO_SEEKABLE_NORMAL)) {
+                avio_closep(&probe);
+                throw std::runtime_error("服务器不支持范围请求");
+            }
+            if (!read_validator(probe)) {
+                avio_closep(&probe);
+                throw std::runtime_error("无法读取 " + url);
+            }
+            // 校验读取的数据还在 avio 缓冲内，退回开头不会重新请求；退不回时这个连接不交给下载线程
+            if (avio_seek(probe, 0, SEEK_SET) != 0) {
+                avio_closep(&probe);
+            }
+            chunk_count = (total_size + this->options.chunkSize - 1) / this->options.chunkSize;
+            chunks.assign(chunk_count, Missing);
+            attempts.assign(chunk_count, 0);
+
+            try {
+                open_cache();
+            } catch (...) {
+                avio_closep(&probe);
+                throw;
+            }
+
+            auto* buffer = static_cast<unsigned char*>(av_malloc(IOBufferSize));
+            io = buffer ? avio_alloc_context(buffer, IOBufferSize, 0, this,
+                                             &ProgressiveInput::read_packet, nullptr,
+                                             &ProgressiveInput::seek_packet) : nullptr;
+            if (!io) {
+                av_free(buffer);
+                avio_closep(&probe);
+                throw std::runtime_error("无法创建网络输入上下文");
+            }
+
+            for (int i = 0; i < this->options.fetchThreads; i++) {
+                workers.emplace_back(&ProgressiveInput::fetch_loop, this, i == 0 ? probe : nullptr);
+            }
+        } catch (...) {
+            release();
+            throw;
+        }
+
+        LOG_INFO("渐进式网络输入: {} ({:.1f} MB, {} 块, 缓存已有 {} 块, {} 个下载连接)",
+                 url, total_size / 1048576.0, chunk_count, cached_chunks, this->options.fetchThreads);
+    }
+
+    ProgressiveInput::~ProgressiveInput() {
+        release();
+        LOG_INFO("网络输入: 下载 {:.1f} MB, 缓存命中 {}/{} 块, 等待数据 {} 次共 {:.0f}ms",
+                 downloaded_bytes.load() / 1048576.0, cached_chunks, chunk_count, stalls, stall_ms);
+    }
+
+    void ProgressiveInput::release() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        fetch_cv.notify_all();
+        ready_cv.notify_all();
+        // 阻塞中的网络读取由 interrupt 回调中断
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+
+        if (io) {
+            av_freep(&io->buffer);
+            avio_context_free(&io);
+        }
+        if (data_fd >= 0) ::close(data_fd);
+        if (map_fd >= 0) ::close(map_fd);
+        data_fd = map_fd = -1;
+        avformat_network_deinit();
+    }
+
+    AVIOContext* ProgressiveInput::connect(int64_t offset) {
+        // offset 让 http 协议直接发送 Range 请求，不必先从文件开头建立连接
+        AVDictionary* opts = nullptr;
+        if (offset > 0) av_dict_set_int(&opts, "offset", offset, 0);
+        AVIOContext* conn = nullptr;
+        const int ret = avio_open2(&conn, url.c_str(), AVIO_FLAG_READ, &interrupt_cb, &opts);
+        av_dict_free(&opts);
+        return ret < 0 ? nullptr : conn;
+    }
+
+    bool ProgressiveInput::read_validator(AVIOContext* probe) {
+        uint8_t* value = nullptr;
+        if (av_opt_get(probe, "mime_type", AV_OPT_SEARCH_CHILDREN, &value) >= 0 && value) {
+            mime_type = reinterpret_cast<const char*>(value);
+        }
+        av_free(value);
+
+        uint8_t head[FingerprintBytes];
+        const int wanted = static_cast<int>(std::min<int64_t>(sizeof(head), total_size));
+        if (avio_read(probe, head, wanted) != wanted) return false;
+        fingerprint = fnv1a(head, static_cast<size_t>(wanted));
+        return true;
+    }
+
+    void ProgressiveInput::open_cache() {
+        namespace fs = std::filesystem;
+        const fs::path dir = options.cacheDir.empty() ? fs::temp_directory_path() / "glitchplayer-cache"
+                                                      : fs::path(options.cacheDir);
+        fs::create_directories(dir);
+        const std::string key = cache_key(url);
+        if (options.cacheLimit > 0) {
+            evict_cache(dir, key, options.cacheLimit, total_size);
+        }
+        data_fd = ::open((dir / (key + ".data")).c_str(), O_RDWR | O_CREAT, 0644);
+        map_fd = ::open((dir / (key + ".chunks")).c_str(), O_RDWR | O_CREAT, 0644);
+        if (data_fd < 0 || map_fd < 0) {
+            throw std::runtime_error("无法创建网络缓存文件: " + dir.string());
+        }
+        // 更新修改时间，按最近使用淘汰时不先删掉刚打开的缓存
+        futimens(data_fd, nullptr);
+
+        char current_mime[sizeof(CacheHeader::mime_type)] = {};
+        snprintf(current_mime, sizeof(current_mime), "%s", mime_type.c_str());
+
+        CacheHeader header{};
+        const bool valid = pread(map_fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                           memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) == 0 &&
+                           header.version == CacheVersion &&
+                           header.size == total_size && header.chunk_size == options.chunkSize &&
+                           header.fingerprint == fingerprint &&
+                           memcmp(header.mime_type, current_mime, sizeof(current_mime)) == 0;
+        if (valid) {
+            // 沿用上次打开时已下载的块
+            std::vector<uint8_t> marks(chunk_count, 0);
+            if (pread(map_fd, marks.data(), marks.size(), sizeof(header)) < 0) marks.assign(chunk_count, 0);
+            for (int64_t i = 0; i < chunk_count; i++) {
+                if (marks[i] == ChunkMark) {
+                    chunks[i] = Ready;
+                    cached_chunks++;
+                }
+            }
+        } else {
+            // 首次打开或源文件已变化，清空旧缓存
+            header = CacheHeader{};
+            memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+            header.version = CacheVersion;
+            header.size = total_size;
+            header.chunk_size = options.chunkSize;
+            header.fingerprint = fingerprint;
+            memcpy(header.mime_type, current_mime, sizeof(current_mime));
+            if (ftruncate(data_fd, 0) != 0 || ftruncate(map_fd, 0) != 0 ||
+                pwrite(map_fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+                throw std::runtime_error("无法写入网络缓存文件");
+            }
+        }
+
+        // 稀疏文件：未下载的区域不占用磁盘空间
+        if (ftruncate(data_fd, total_size) != 0 ||
+            ftruncate(map_fd, static_cast<off_t>(sizeof(header) + chunk_count)) != 0) {
+            throw std::runtime_error("无法写入网络缓存文件");
+        }
+    }
+
+    int64_t ProgressiveInput::chunk_bytes(int64_t chunk) const {
+        return std::min(options.chunkSize, total_size - chunk * options.chunkSize);
+    }
+
+    int64_t ProgressiveInput::next_chunk() const {
+        const int64_t end = std::min(chunk_count, playhead + options.readAheadChunks);
+        for (int64_t i = playhead; i < end; i++) {
+            if (chunks[i] == Missing) return i;
+        }
+        return -1;
+    }
+
+    void ProgressiveInput::move_playhead(int64_t chunk) {
+        if (chunk == playhead) return;
+        playhead = chunk;
+        // 跳到之前下载失败的位置时重新尝试
+        if (chunks[chunk] == Failed) {
+            chunks[chunk] = Missing;
+            attempts[chunk] = 0;
+        }
+        fetch_cv.notify_all();
+    }
+
+    void ProgressiveInput::fetch_loop(AVIOContext* conn) {
+        int64_t conn_offset = 0;
+        std::vector<uint8_t> buffer(options.chunkSize);
+
+        while (true) {
+            int64_t chunk = -1;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                fetch_cv.wait(lock, [&] { return stopping || (chunk = next_chunk()) >= 0; });
+                if (stopping) break;
+                chunks[chunk] = Fetching;
+            }
+
+            const bool ok = fetch_chunk(conn, conn_offset, chunk, buffer);
+            if (stopping) break;
+            if (ok && pwrite(map_fd, &ChunkMark, 1, static_cast<off_t>(sizeof(CacheHeader) + chunk)) != 1) {
+                LOG_WARN("无法写入网络缓存标记，块 {}", chunk);
+            }
+
+            bool failed = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (ok) {
+                    chunks[chunk] = Ready;
+                } else {
+                    failed = ++attempts[chunk] >= MaxAttempts;
+                    chunks[chunk] = failed ? Failed : Missing;
+                }
+            }
+            ready_cv.notify_all();
+            if (failed) {
+                LOG_ERROR("网络数据块 {} 下载失败 {} 次", chunk, MaxAttempts);
+            } else if (!ok) {
+                // 稍后重试，避免断网时反复重连
+                fetch_cv.notify_one();
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            }
+        }
+        avio_closep(&conn);
+    }
+
+    bool ProgressiveInput::fetch_chunk(AVIOContext*& conn, int64_t& conn_offset, int64_t chunk,
+                                       std::vector<uint8_t>& buffer) {
+        const int64_t offset = chunk * options.chunkSize;
+        const int64_t length = chunk_bytes(chunk);
+
+        // 顺序下载时沿用同一个连接，不连续时从块开头重新发起范围请求
+        if (conn && conn_offset != offset) avio_closep(&conn);
+        if (!conn) {
+            conn = connect(offset);
+            if (!conn) return false;
+            conn_offset = offset;
+        }
+
+        int64_t got = 0;
+        while (got < length) {
+            const int n = avio_read(conn, buffer.data() + got, static_cast<int>(length - got));
+            if (n <= 0) {
+                avio_closep(&conn);
+                return false;
+            }
+            got += n;
+        }
+        conn_offset = offset + length;
+
+        int64_t written = 0;
+        while (written < length) {
+            const ssize_t n = pwrite(data_fd, buffer.data() + written, length - written, offset + written);
+            if (n <= 0) {
+                LOG_ERROR("写入网络缓存失败: {}", strerror(errno));
+                return false;
+            }
+            written += n;
+        }
+        downloaded_bytes += length;
+        return true;
+    }
+
+    int ProgressiveInput::read(uint8_t* buf, int size) {
+        if (position >= total_size) return AVERROR_EOF;
+        const int64_t chunk = position / options.chunkSize;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            move_playhead(chunk);
+            if (chunks[chunk] != Ready && chunks[chunk] != Failed) {
+                const auto start = std::chrono::steady_clock::now();
+                ready_cv.wait(lock, [&] { return stopping || chunks[chunk] == Ready || chunks[chunk] == Failed; });
+                stalls++;
+                stall_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            }
+            if (stopping) return AVERROR_EXIT;
+            if (chunks[chunk] == Failed) return AVERROR(EIO);
+        }
+
+        // 块已在本地磁盘上，不跨块读取
+        const int64_t chunk_end = chunk * options.chunkSize + chunk_bytes(chunk);
+        const auto n = static_cast<size_t>(std::min<int64_t>(size, chunk_end - position));
+        const ssize_t got = pread(data_fd, buf, n, position);
+        if (got <= 0) return AVERROR(EIO);
+        position += got;
+        return static_cast<int>(got);
+    }
+
+    int64_t ProgressiveInput::seek(int64_t offset, int whence) {
+        if (whence == AVSEEK_SIZE) return total_size;
+
+        int64_t target = 0;
+        switch (whence & ~AVSEEK_FORCE) {
+            case SEEK_SET: target = offset; break;
+            case SEEK_CUR: target = position + offset; break;
+            case SEEK_END: target = total_size + offset; break;
+            default: return AVERROR(EINVAL);
+        }
+        if (target < 0) return AVERROR(EINVAL);
+        position = target;
+
+        // 不等下一次读取，立即从新位置开始下载
+        if (target < total_size) {
+            std::lock_guard<std::mutex> lock(mutex);
+            move_playhead(target / options.chunkSize);
+        }
+        return position;
+    }
+
+    int ProgressiveInput::read_packet(void* opaque, uint8_t* buf, int size) {
+        return static_cast<ProgressiveInput*>(opaque)->read(buf, size);
+    }
+
+    int64_t ProgressiveInput::seek_packet(void* opaque, int64_t offset, int whence) {
+        return static_cast<ProgressiveInput*>(opaque)->seek(offset, whence);
+    }
+
+    int ProgressiveInput::interrupt(void* opaque) {
+        return static_cast<ProgressiveInput*>(opaque)->stopping ? 1 : 0;
+    }
+
+} // namespace video
@@ -0,0 +1,129 @@
+//
+// Created by Weichuandong on 2025/4/2.
+//
+
+#include "video/RGBConverter.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <chrono>
+
+extern "C" {
+#include <libavutil/mem.h>
+#include <libavutil/pixdesc.h>
+}
+
+namespace video {
+
+    RGBBuffer::~RGBBuffer() {
+        av_freep(&pixels);
+    }
+
+    bool RGBBuffer::allocate(int width, int height) {
+        if (pixels && width == buffer_width && height == buffer_height) return true;
+        av_freep(&pixels);
+        buffer_width = buffer_height = line_size = 0;
+        if (width <= 0 || height <= 0) return false;
+
+        const int stride = FFALIGN(width * 3, Alignment);
+        pixels = static_cast<uint8_t*>(av_malloc(static_cast<size_t>(stride) * height));
+        if (!pixels) return false;
+        line_size = stride;
+        buffer_width = width;
+        buffer_height = height;
+        return true;
+    }
+
+    RGBConverter::RGBConverter(ThreadPool* pool)
+        : pool(pool ? pool : &ThreadPool::shared()) {
+    }
+
+    RGBConverter::~RGBConverter() {
+        release();
+    }
+
+    void RGBConverter::release() {
+        for (auto& slice : slices) {
+            sws_freeContext(slice.ctx);
+        }
+        slices.clear();
+        src_format = -1;
+    }
+
+    bool RGBConverter::prepare(const AVFrame* frame) {
+        // 未标注颜色矩阵时按分辨率选择，YUVJ 格式和 JPEG 范围为全范围输入
+        const int colorspace = frame->colorspace != AVCOL_SPC_UNSPECIFIED ? frame->colorspace
+                             : frame->height > 576 ? SWS_CS_ITU709 : SWS_CS_ITU601;
+        const auto format = static_cast<AVPixelFormat>(frame->format);
+        const int range = frame->color_range == AVCOL_RANGE_JPEG || format == AV_PIX_FMT_YUVJ420P ||
+                          format == AV_PIX_FMT_YUVJ422P || format == AV_PIX_FMT_YUVJ444P ? 1 : 0;
+
+        if (!slices.empty() && frame->format == src_format && frame->width == src_width &&
+            frame->height == src_height && colorspace == src_colorspace && range == src_range) {
+            return true;
+        }
+        release();
+
+        const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+        if (!desc || frame->width <= 0 || frame->height <= 0) return false;
+
+        // 条带数不超过线程数，也不让条带太矮而增加调度开销
+        const int max_slices = std::max(1, std::min({pool->size() + 1, MaxSlices, frame->height / MinSliceRows}));
+        const int rows = FFALIGN((frame->height + max_slices - 1) / max_slices, 16);
+
+        // 每个条带是一个独立的同尺寸转换，上下文按条带高度创建，swscale 无需跨条带状态
+        for (int y = 0; y < frame->height; y += rows) {
+            Slice slice;
+            slice.y = y;
+            slice.height = std::min(rows, frame->height - y);
+            slice.ctx = sws_getContext(frame->width, slice.height, format,
+                                       frame->width, slice.height, AV_PIX_FMT_RGB24,
+                                       SWS_BILINEAR, nullptr, nullptr, nullptr);
+            if (!slice.ctx) {
+                release();
+                return false;
+            }
+            sws_setColorspaceDetails(slice.ctx, sws_getCoefficients(colorspace), range,
+                                     sws_getCoefficients(SWS_CS_DEFAULT), 1, 0, 1 << 16, 1 << 16);
+            slices.push_back(slice);
+        }
+
+        src_format = frame->format;
+        src_width = frame->width;
+        src_height = frame->height;
+        src_colorspace = colorspace;
+        src_range = range;
+        chroma_shift = desc->log2_chroma_h;
+        has_palette = desc->flags & AV_PIX_FMT_FLAG_PAL;
+        LOG_INFO("RGB 转换: {} {}x{}, {} 个条带", desc->name, frame->width, frame->height, slices.size());
+        return true;
+    }
+
+    bool RGBConverter::convert(const AVFrame* frame, uint8_t* dst, int dst_stride) {
+        if (!frame || !dst || !prepare(frame)) return false;
+        const auto start = std::chrono::steady_clock::now();
+
+        pool->parallel_for(static_cast<int>(slices.size()), [&](int index) {
+            const Slice& slice = slices[index];
+            // 色度平面（1、2）按垂直采样比例偏移，亮度与 alpha 平面按行偏移，调色板不偏移
+            const uint8_t* src[4];
+            for (int p = 0; p < 4; p++) {
+                const int row = p == 1 || p == 2 ? slice.y >> chroma_shift : slice.y;
+                src[p] = frame->data[p] && !(has_palette && p == 1)
+                         ? frame->data[p] + static_cast<ptrdiff_t>(row) * frame->linesize[p] : frame->data[p];
+            }
+            uint8_t* const out[] = {dst + static_cast<ptrdiff_t>(slice.y) * dst_stride, nullptr, nullptr, nullptr};
+            const int out_stride[] = {dst_stride, 0, 0, 0};
+            sws_scale(slice.ctx, src, frame->linesize, 0, slice.height, out, out_stride);
+        });
+
+        convert_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    bool RGBConverter::convert(const AVFrame* frame, RGBBuffer& dst) {
+        if (!frame || !dst.allocate(frame->width, frame->height)) return false;
+        return convert(frame, dst.data(), dst.stride());
+    }
+
+} // namespace video
@@ -4,12 +4,28 @@
 
 #include "video/SDLRenderer.h"
 
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+
 namespace video {
 
-    SDLRenderer::SDLRenderer(int width, int height) :
-        width(width),
-        height(height){
-        /* 初始化 SDL 窗口和渲染器 */
+    namespace {
+        // 逐行拷贝一个平面，src_stride 可以为负（上下翻转存储的帧）
+        void copy_plane(uint8_t* dst, int dst_stride, const uint8_t* src, int src_stride, int row_bytes, int rows) {
+            for (int y = 0; y < rows; y++) {
+                memcpy(dst + static_cast<ptrdiff_t>(y) * dst_stride, src + static_cast<ptrdiff_t>(y) * src_stride, row_bytes);
+            }
+        }
+    }
+
+    SDLRenderer::SDLRenderer(int width, int height, SwapMode swap_mode) {
+        /* 初始化 SDL 窗口和渲染器（窗口、事件与绘制都在主线程） */
         if (SDL_Init(SDL_INIT_VIDEO) != 0) {
             throw std::runtime_error(SDL_GetError());
         }
@@ -18,109 +34,322 @@ namespace video {
             "视频播放器",
             SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
             width, height,
-            SDL_WINDOW_SHOWN
+            SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE
         );
+        // 构造函数抛出时析构函数不会执行，已创建的资源在抛出前释放
         if (!window) {
-            throw std::runtime_error(SDL_GetError());
+            const std::string error = SDL_GetError();
+            SDL_Quit();
+            throw std::runtime_error("无法创建窗口: " + error);
         }
 
-        renderer = SDL_CreateRenderer(window, -1, 0);
+        // SDL_Renderer 只能开关垂直同步
+        if (swap_mode == SwapMode::Adaptive) {
+            LOG_WARN("SDL 渲染器不支持自适应垂直同步，改用垂直同步");
+            swap_mode = SwapMode::VSync;
+        }
+        renderer = SDL_CreateRenderer(window, -1, swap_mode == SwapMode::VSync ? SDL_RENDERER_PRESENTVSYNC : 0);
         if (!renderer) {
-            throw std::runtime_error(SDL_GetError());
+            const std::string error = SDL_GetError();
+            SDL_DestroyWindow(window);
+            SDL_Quit();
+            throw std::runtime_error("无法创建 SDL 渲染器: " + error);
         }
 
-        texture = SDL_CreateTexture(
-            renderer, SDL_PIXELFORMAT_RGB24,
-            SDL_TEXTUREACCESS_STREAMING,
-            width, height
-        );
-        if (!texture) {
-            throw std::runtime_error(SDL_GetError());
+        SDL_RendererInfo info;
+        if (SDL_GetRendererInfo(renderer, &info) == 0) {
+            renderer_name = info.name;
+            if (swap_mode == SwapMode::VSync && !(info.flags & SDL_RENDERER_PRESENTVSYNC)) {
+                LOG_WARN("渲染器 {} 不支持垂直同步，按不同步调度", renderer_name);
+                swap_mode = SwapMode::Off;
+            }
         }
 
-        text_renderer = std::make_unique<TextRenderer>("fonts/Roboto-Regular.ttf", 20);
+        // 显示器标称刷新率，实际周期由调度器在播放中测量
+        SDL_DisplayMode display_mode;
+        int refresh_rate = 0;
+        if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(window), &display_mode) == 0) {
+            refresh_rate = display_mode.refresh_rate;
+        }
+        scheduler = std::make_unique<PresentScheduler>(swap_mode, refresh_rate);
+        LOG_INFO("SDL 渲染器: {}，显示调度: {}", renderer_name, swap_mode == SwapMode::VSync ? "vsync" : "off");
+
+        try {
+            text_renderer = std::make_unique<TextRenderer>(renderer, "./fonts/Roboto-Regular.ttf", 14);
+        } catch (const std::exception& e) {
+            LOG_ERROR("无法加载字体: {} ({})", e.what(), TTF_GetError());
+        }
     }
 
     SDLRenderer::~SDLRenderer() {
+        log_pacing_stats();
+
         /* 释放 SDL 资源 */
-        SDL_DestroyTexture(texture);
+        sws_freeContext(fallback_sws);
+        av_frame_free(&fallback_frame);
+        text_renderer.reset();
+        if (texture) SDL_DestroyTexture(texture);
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         SDL_Quit();
     }
 
-    void SDLRenderer::render_frame(const uint8_t* rgb_data, double current_time, double duration) {
-        /* 更新纹理并渲染到屏幕 */
-        SDL_UpdateTexture(texture, nullptr, rgb_data, width * 3);
-        SDL_RenderClear(renderer);
-        SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+    bool SDLRenderer::handle_events() {
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_RENDER_DEVICE_RESET) {
+                // 设备丢失时纹理已被 SDL 释放，下一帧重建
+                texture = nullptr;
+                texture_format = SDL_PIXELFORMAT_UNKNOWN;
+                has_video = false;
+            }
+            if (!process_event(event)) return false;
+        }
 
-        // 绘制进度条
-        draw_progress_bar(current_time, duration);
+        // 绘制也在本线程：队列为空时的等待同时作为事件轮询间隔
+        PresentItem item;
+        if (present_queue->popFor(item, std::chrono::milliseconds(10))) {
+            present(item);
+        }
+        return true;
+    }
+
+    void SDLRenderer::draw(const AVFrame* frame, const OverlayState& state, bool record) {
+        (void)record;   // 该后端不支持录制
+
+        if (frame) {
+            has_video = upload_frame(frame);
+        }
+
+        // UI 使用窗口坐标，高 DPI 下由渲染器缩放到输出像素
+        int w = 0, h = 0, output_w = 0, output_h = 0;
+        SDL_GetWindowSize(window, &w, &h);
+        SDL_GetRendererOutputSize(renderer, &output_w, &output_h);
+        if (w > 0 && h > 0) {
+            SDL_RenderSetScale(renderer, output_w / static_cast<float>(w), output_h / static_cast<float>(h));
+        }
+
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+        if (has_video) {
+            SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+        }
+        draw_ui(state, w, h);
 
         SDL_RenderPresent(renderer);
     }
 
-    PlayerEvent SDLRenderer::handle_events() {
-        /* 处理关闭窗口等事件 */
-        SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) {
-                return PlayerEvent::Quit;
-            } else if (event.type == SDL_KEYDOWN) {
-                switch (event.key.keysym.sym) {
-                    case SDLK_SPACE : return PlayerEvent::PlayPause;
-                    case SDLK_LEFT : return PlayerEvent::SeekBackWard_5;
-                    case SDLK_RIGHT : return PlayerEvent::SeekForward_5;
-                    case SDLK_ESCAPE : return PlayerEvent::Quit;
-                    case SDLK_BACKSPACE : return PlayerEvent::Restart;
-                    default: break;
+    bool SDLRenderer::upload_frame(const AVFrame* frame) {
+        const auto start = std::chrono::steady_clock::now();
+
+        // 解码平面直接对应的纹理格式，其余格式先转换为 YUV420P
+        const AVFrame* src = frame;
+        Uint32 format = SDL_PIXELFORMAT_IYUV;
+        switch (frame->format) {
+            case AV_PIX_FMT_YUV420P:
+            case AV_PIX_FMT_YUVJ420P:
+                break;
+            case AV_PIX_FMT_NV12:
+                format = SDL_PIXELFORMAT_NV12;
+                break;
+            case AV_PIX_FMT_NV21:
+                format = SDL_PIXELFORMAT_NV21;
+                break;
+            default:
+                src = convert_frame(frame);
+                if (!src) return false;
+                break;
+        }
+
+        // 颜色矩阵与范围取自帧属性，未标注时按分辨率选择
+        SDL_YUV_CONVERSION_MODE mode;
+        if (frame->color_range == AVCOL_RANGE_JPEG || frame->format == AV_PIX_FMT_YUVJ420P) {
+            mode = SDL_YUV_CONVERSION_JPEG;
+        } else if (frame->colorspace == AVCOL_SPC_BT709) {
+            mode = SDL_YUV_CONVERSION_BT709;
+        } else if (frame->colorspace == AVCOL_SPC_UNSPECIFIED) {
+            mode = SDL_GetYUVConversionModeForResolution(frame->width, frame->height);
+        } else {
+            mode = SDL_YUV_CONVERSION_BT601;
+        }
+
+        if (!ensure_texture(format, src->width, src->height, mode)) return false;
+
+        const bool planar = format == SDL_PIXELFORMAT_IYUV;
+        const bool positive_strides = src->linesize[0] > 0 && src->linesize[1] > 0 && (!planar || src->linesize[2] > 0);
+        bool ok;
+        if (positive_strides) {
+            // 按解码器的行距直接更新，SDL 内部只做一次拷贝
+            ok = planar ? SDL_UpdateYUVTexture(texture, nullptr,
+                                               src->data[0], src->linesize[0],
+                                               src->data[1], src->linesize[1],
+                                               src->data[2], src->linesize[2]) == 0
+                        : SDL_UpdateNVTexture(texture, nullptr,
+                                              src->data[0], src->linesize[0],
+                                              src->data[1], src->linesize[1]) == 0;
+        } else {
+            // 负行距（上下翻转存储）时逐行拷贝到锁定的纹理内存，布局为连续的 Y、U、V（或交错 UV）平面
+            void* pixels = nullptr;
+            int pitch = 0;
+            ok = SDL_LockTexture(texture, nullptr, &pixels, &pitch) == 0;
+            if (ok) {
+                auto* dst = static_cast<uint8_t*>(pixels);
+                const int chroma_w = (src->width + 1) / 2;
+                const int chroma_h = (src->height + 1) / 2;
+                copy_plane(dst, pitch, src->data[0], src->linesize[0], src->width, src->height);
+                dst += static_cast<ptrdiff_t>(pitch) * src->height;
+                if (planar) {
+                    const int chroma_pitch = (pitch + 1) / 2;
+                    copy_plane(dst, chroma_pitch, src->data[1], src->linesize[1], chroma_w, chroma_h);
+                    dst += static_cast<ptrdiff_t>(chroma_pitch) * chroma_h;
+                    copy_plane(dst, chroma_pitch, src->data[2], src->linesize[2], chroma_w, chroma_h);
+                } else {
+                    copy_plane(dst, 2 * ((pitch + 1) / 2), src->data[1], src->linesize[1], chroma_w * 2, chroma_h);
                 }
+                SDL_UnlockTexture(texture);
             }
         }
-        return PlayerEvent::None;
-    }
+        if (!ok) {
+            LOG_WARN("更新纹理失败: {}", SDL_GetError());
+        }
 
-    // 辅助函数：格式化时间（秒 → "MM:SS"）
-    std::string SDLRenderer::format_time(double seconds) {
-        int mins = static_cast<int>(seconds) / 60;
-        int secs = static_cast<int>(seconds) % 60;
-        char buffer[16];
-        snprintf(buffer, sizeof(buffer), "%02d:%02d", mins, secs);
-        return buffer;
+        locked_upload = !positive_strides;
+        upload_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return ok;
     }
 
-    void SDLRenderer::draw_progress_bar(double current_time, double duration) {
-        int window_width, window_height;
-        SDL_GetWindowSize(window, &window_width, &window_height);
+    bool SDLRenderer::ensure_texture(Uint32 format, int w, int h, SDL_YUV_CONVERSION_MODE mode) {
+        if (texture && format == texture_format && w == texture_width && h == texture_height && mode == texture_mode) {
+            return true;
+        }
+
+        if (texture) SDL_DestroyTexture(texture);
+        // 转换矩阵在创建纹理时确定
+        SDL_SetYUVConversionMode(mode);
+        texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STREAMING, w, h);
+        if (!texture) {
+            LOG_ERROR("无法创建 {} 纹理: {}", SDL_GetPixelFormatName(format), SDL_GetError());
+            texture_format = SDL_PIXELFORMAT_UNKNOWN;
+            return false;
+        }
 
-        // ---------- 绘制进度条背景 ----------
-        SDL_Rect progress_bar_rect = {0, window_height - 40, window_width, 4};
-        SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255); // 灰色背景
-        SDL_RenderFillRect(renderer, &progress_bar_rect);
+        texture_format = format;
+        texture_width = w;
+        texture_height = h;
+        texture_mode = mode;
+        LOG_INFO("流式纹理: {} {}x{}", SDL_GetPixelFormatName(format), w, h);
+        return true;
+    }
+
+    const AVFrame* SDLRenderer::convert_frame(const AVFrame* frame) {
+        if (warned_format != frame->format) {
+            warned_format = frame->format;
+            const char* name = av_get_pix_fmt_name(static_cast<AVPixelFormat>(frame->format));
+            LOG_WARN("像素格式 {} 无对应的 SDL 纹理格式，回退到 CPU 转换", name ? name : "unknown");
+        }
 
-        // ---------- 绘制进度条前景 ----------
-        if (duration > 0) {
-            double progress = current_time / duration;
-            int progress_width = static_cast<int>(window_width * progress);
-            SDL_Rect progress_rect = {0, window_height - 40, progress_width, 4};
-            SDL_SetRenderDrawColor(renderer, 0, 200, 0, 255); // 绿色进度条
-            SDL_RenderFillRect(renderer, &progress_rect);
+        if (!fallback_frame || fallback_frame->width != frame->width || fallback_frame->height != frame->height) {
+            av_frame_free(&fallback_frame);
+            fallback_frame = av_frame_alloc();
+            fallback_frame->width = frame->width;
+            fallback_frame->height = frame->height;
+            fallback_frame->format = AV_PIX_FMT_YUV420P;
+            if (av_frame_get_buffer(fallback_frame, 0) < 0) {
+                av_frame_free(&fallback_frame);
+                return nullptr;
+            }
         }
 
-        // ---------- 绘制时间文本 ----------
-        SDL_Color text_color = {255, 255, 255, 255}; // 白色文本
-        std::string time_text = format_time(current_time) + " / " + format_time(duration);
-        SDL_Texture* text_texture = text_renderer->render_text(renderer, time_text, text_color);
+        fallback_sws = sws_getCachedContext(fallback_sws, frame->width, frame->height,
+                                            static_cast<AVPixelFormat>(frame->format),
+                                            frame->width, frame->height, AV_PIX_FMT_YUV420P,
+                                            SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!fallback_sws) return nullptr;
 
-        if (text_texture) {
-            int text_width, text_height;
-            SDL_QueryTexture(text_texture, nullptr, nullptr, &text_width, &text_height);
-            SDL_Rect text_rect = {10, window_height - 35, text_width, text_height};
-            SDL_RenderCopy(renderer, text_texture, nullptr, &text_rect);
-            SDL_DestroyTexture(text_texture);
+        sws_scale(fallback_sws, frame->data, frame->linesize, 0, frame->height,
+                  fallback_frame->data, fallback_frame->linesize);
+        return fallback_frame;
+    }
+
+    // 辅助函数：格式化时间（秒 → "MM:SS"，超过一小时为 "H:MM:SS"）
+    std::string SDLRenderer::format_time(double seconds) {
+        int total_seconds = static_cast<int>(seconds);
+        int hours = total_seconds / 3600;
+        int minutes = (total_seconds % 3600) / 60;
+        int secs = total_seconds % 60;
+
+        std::stringstream ss;
+        if (hours > 0) {
+            ss << hours << ":";
         }
+        ss << std::setfill('0') << std::setw(2) << minutes << ":"
+           << std::setfill('0') << std::setw(2) << secs;
+        return ss.str();
     }
 
+    void SDLRenderer::draw_ui(const OverlayState& state, int w, int h) {
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+        // ---------- 进度条（与 GL 后端相同的位置和颜色） ----------
+        const float bar_y = progress_bar_top(h);
+        if (state.show_timeline) {
+            SDL_FRect bar = {0.0f, bar_y, static_cast<float>(w), ProgressBarHeight};
+            SDL_SetRenderDrawColor(renderer, 51, 51, 51, 179);
+            SDL_RenderFillRectF(renderer, &bar);
+            bar.w = std::floor(w * state.progress);
+            SDL_SetRenderDrawColor(renderer, 219, 31, 31, 255);
+            SDL_RenderFillRectF(renderer, &bar);
+        }
+
+        // ---------- 时间与统计文本 ----------
+        if (text_renderer) {
+            if (state.show_timeline) {
+                const std::string time_text = format_time(state.current_time) + "/" + format_time(state.total_time) +
+                        speed_label(state.speed);
+                text_renderer->draw_text(time_text, 10.0f, bar_y + ProgressBarHeight + 5.0f, SDL_Color{255, 255, 255, 255});
+            } else if (state.live_latency >= 0.0) {
+                text_renderer->draw_text(live_label(state.live_latency, state.speed), 10.0f,
+                                         bar_y + ProgressBarHeight + 5.0f, SDL_Color{255, 255, 255, 255});
+            }
+
+            // 每 500ms 刷新一次文本
+            if (show_stats) {
+                const auto now = std::chrono::steady_clock::now();
+                if (stats_text.empty() || now - stats_updated >= std::chrono::milliseconds(500)) {
+                    const PacingStats& pacing = scheduler->stats();
+                    std::stringstream ss;
+                    ss << std::fixed << std::setprecision(2) << "upload " << upload_ms << " ms  "
+                       << (texture_format != SDL_PIXELFORMAT_UNKNOWN ? SDL_GetPixelFormatName(texture_format) : "none")
+                       << (locked_upload ? " lock" : " update") << "  " << renderer_name
+                       << "  |  " << pacing.refresh_hz << " Hz  jitter " << pacing.jitter_ms
+                       << " ms  late " << pacing.late_frames << "  drop " << pacing.dropped_frames
+                       << "  repeat " << pacing.repeated_refreshes
+                       << "  seek " << pacing.seek_latency_ms << " ms";
+                    stats_text = ss.str();
+                    memory_text = MemoryBudget::shared().summary();
+                    stats_updated = now;
+                }
+                text_renderer->draw_text(stats_text, 10.0f, 10.0f, SDL_Color{255, 255, 0, 255});
+                text_renderer->draw_text(memory_text, 10.0f, 30.0f, SDL_Color{255, 255, 0, 255});
+            }
+        }
+
+        // ---------- 调试坐标系参考 ----------
+        if (state.show_debug) {
+            const SDL_Color colors[] = {{255, 0, 0, 255}, {0, 255, 0, 255}, {0, 0, 255, 255}, {255, 255, 0, 255}};
+            const SDL_FRect corners[] = {
+                    {0.0f, 0.0f, 30.0f, 30.0f}, {w - 30.0f, 0.0f, 30.0f, 30.0f},
+                    {0.0f, h - 30.0f, 30.0f, 30.0f}, {w - 30.0f, h - 30.0f, 30.0f, 30.0f}
+            };
+            for (int i = 0; i < 4; i++) {
+                SDL_SetRenderDrawColor(renderer, colors[i].r, colors[i].g, colors[i].b, colors[i].a);
+                SDL_RenderFillRectF(renderer, &corners[i]);
+            }
+            const SDL_FRect cross[] = {{w / 2 - 1.0f, 0.0f, 2.0f, static_cast<float>(h)},
+                                       {0.0f, h / 2 - 1.0f, static_cast<float>(w), 2.0f}};
+            SDL_SetRenderDrawColor(renderer, 128, 128, 128, 128);
+            SDL_RenderFillRectsF(renderer, cross, 2);
+        }
+    }
 
-} // namespace video
\ No newline at end of file
+} // namespace video
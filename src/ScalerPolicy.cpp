@@ -0,0 +1,86 @@
+//
+// Created by Weichuandong on 2025/3/30.
+//
+
+#include "video/ScalerPolicy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace video {
+
+    const char* scale_filter_name(ScaleFilter filter) {
+        switch (filter) {
+            case ScaleFilter::Auto: return "auto";
+            case ScaleFilter::Bilinear: return "bilinear";
+            case ScaleFilter::Bicubic: return "bicubic";
+            case ScaleFilter::Lanczos: return "lanczos";
+            case ScaleFilter::Mipmap: return "mipmap";
+            default: return "unknown";
+        }
+    }
+
+    bool parse_scale_filter(const char* name, ScaleFilter& filter) {
+        for (int i = 0; i < static_cast<int>(ScaleFilter::Count); i++) {
+            if (strcmp(name, scale_filter_name(static_cast<ScaleFilter>(i))) == 0) {
+                filter = static_cast<ScaleFilter>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    ScalerChoice ScalerPolicy::update(ScaleFilter requested, bool allow_prescale,
+                                      int video_width, int video_height, int view_width, int view_height,
+                                      double gpu_ms, double budget_ms) {
+        if (video_width <= 0 || video_height <= 0 || view_width <= 0 || view_height <= 0) {
+            return choice;
+        }
+
+        // 缩小后仍不小于窗口，保证不会因预缩放而变成放大
+        int shift = 0;
+        if (allow_prescale) {
+            while (shift < MaxPrescaleShift &&
+                   (video_width >> (shift + 1)) >= view_width &&
+                   (video_height >> (shift + 1)) >= view_height) {
+                shift++;
+            }
+        }
+        choice.prescale_shift = shift;
+
+        if (requested != ScaleFilter::Auto) {
+            choice.filter = requested;
+            return choice;
+        }
+
+        // 平滑 GPU 耗时，按预算调整允许的最高质量，变化后至少观察一段时间再调整
+        smoothed_gpu_ms = smoothed_gpu_ms == 0.0 ? gpu_ms : smoothed_gpu_ms * 0.9 + gpu_ms * 0.1;
+        frames_since_change++;
+        if (budget_ms > 0.0 && gpu_ms > 0.0) {
+            if (smoothed_gpu_ms > budget_ms * 0.5 && quality_cap > 0 && frames_since_change >= 30) {
+                quality_cap--;
+                frames_since_change = 0;
+                smoothed_gpu_ms = 0.0;
+            } else if (smoothed_gpu_ms < budget_ms * 0.2 && quality_cap < 2 && frames_since_change >= 240) {
+                quality_cap++;
+                frames_since_change = 0;
+                smoothed_gpu_ms = 0.0;
+            }
+        }
+
+        const double ratio = std::min(static_cast<double>(view_width) / (video_width >> shift),
+                                      static_cast<double>(view_height) / (video_height >> shift));
+        if (ratio < 0.5) {
+            choice.filter = ScaleFilter::Mipmap;
+        } else if (std::abs(ratio - 1.0) < 0.01) {
+            // 1:1 显示时线性过滤即为原样采样
+            choice.filter = ScaleFilter::Bilinear;
+        } else {
+            static const ScaleFilter ladder[] = {ScaleFilter::Bilinear, ScaleFilter::Bicubic, ScaleFilter::Lanczos};
+            choice.filter = ladder[quality_cap];
+        }
+        return choice;
+    }
+
+} // namespace video
@@ -0,0 +1,279 @@
+//
+// Created by Weichuandong on 2025/3/31.
+//
+
+#include "video/ScreenRecorder.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace video {
+
+    ScreenRecorder::ScreenRecorder(const RecordOptions& options, int width, int height, double nominal_fps)
+        : options(options), width(width & ~1), height(height & ~1) {
+        if (this->width <= 0 || this->height <= 0) {
+            throw std::runtime_error("录制尺寸无效");
+        }
+
+        // 时间基为微秒，pts 直接取显示时刻
+        EncoderConfig config;
+        config.path = options.path;
+        config.codecName = options.codec;
+        config.preset = options.preset;
+        config.width = this->width;
+        config.height = this->height;
+        config.inputFormat = AV_PIX_FMT_RGBA;
+        config.outputFormat = AV_PIX_FMT_YUV420P;
+        config.timeBase = {1, 1000000};
+        config.frameRate = {nominal_fps > 0.0 ? static_cast<int>(std::lround(nominal_fps)) : 60, 1};
+        config.bitRate = options.bitRate;
+        encoder = std::make_unique<VideoEncoder>(config);
+
+        // 录制 FBO：窗口尺寸变化时缩放复制，同时上下翻转，读回的行序即为自上而下
+        glGenRenderbuffers(1, &color_buffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, color_buffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, this->width, this->height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_buffer);
+        const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!complete) {
+            glDeleteFramebuffers(1, &fbo);
+            glDeleteRenderbuffers(1, &color_buffer);
+            throw std::runtime_error("录制帧缓冲不完整");
+        }
+
+        // 支持持久映射时编码线程直接读取 PBO 内存
+        persistent = GLEW_ARB_buffer_storage || GLEW_VERSION_4_4;
+        const GLsizeiptr bytes = static_cast<GLsizeiptr>(this->width) * this->height * 4;
+        for (auto& slot : slots) {
+            glGenBuffers(1, &slot.pbo);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            if (persistent) {
+                const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+                glBufferStorage(GL_PIXEL_PACK_BUFFER, bytes, nullptr, flags | GL_CLIENT_STORAGE_BIT);
+                slot.mapped = static_cast<const uint8_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, flags));
+                if (!slot.mapped) persistent = false;
+            } else {
+                glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+            }
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (!persistent) {
+            // 部分槽位映射失败时统一退回到映射拷贝路径
+            for (auto& slot : slots) {
+                if (slot.mapped) {
+                    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+                    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+                    slot.mapped = nullptr;
+                }
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+
+        encode_queue = std::make_unique<BoundedQueue<EncodeItem>>(Slots);
+        encode_thread = std::thread(&ScreenRecorder::encode_loop, this);
+        MemoryBudget::shared().add(this, "recorder");
+
+        LOG_INFO("开始录制: {} ({}x{}, {})", options.path, this->width, this->height,
+                 persistent ? "持久映射读回" : "PBO 读回");
+    }
+
+    ScreenRecorder::~ScreenRecorder() {
+        MemoryBudget::shared().remove(this);
+        // 等待所有读回完成并交给编码线程，编码线程写完文件尾后退出
+        while (!reading.empty()) {
+            hand_off(reading.front(), true);
+        }
+        encode_queue->close();
+        if (encode_thread.joinable()) {
+            encode_thread.join();
+        }
+
+        for (auto& slot : slots) {
+            if (slot.fence) glDeleteSync(slot.fence);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            if (slot.mapped) glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            glDeleteBuffers(1, &slot.pbo);
+        }
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &color_buffer);
+
+        const RecordStats result = stats();
+        LOG_INFO("录制结束: {}, 捕获 {} 帧, 编码 {} 帧, 丢弃 {} 帧",
+                 options.path, result.captured, result.encoded, result.dropped);
+    }
+
+    size_t ScreenRecorder::memory_usage() const {
+        // 读回 PBO 常驻；持久映射时队列中的帧就在 PBO 里，否则每帧另有一份拷贝
+        const size_t frame_bytes = static_cast<size_t>(width) * height * 4;
+        return frame_bytes * Slots + (persistent ? 0 : encode_queue->size() * frame_bytes);
+    }
+
+    void ScreenRecorder::on_memory_pressure(int level) {
+        // 至少保留一帧，编码与读回仍能重叠
+        const size_t depth[MemoryBudget::PressureLevels] = {Slots, 2, 1};
+        encode_queue->setCapacity(depth[level]);
+    }
+
+    void ScreenRecorder::capture(int src_w, int src_h) {
+        last_captured = -1;
+        Slot& slot = slots[next_slot];
+        if (slot.state.load(std::memory_order_acquire) != Free) {
+            // 编码跟不上或 GPU 尚未完成，丢帧而不是阻塞渲染线程
+            ++dropped;
+            return;
+        }
+
+        // 后缓冲 -> 录制 FBO（缩放并上下翻转）
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+        glBlitFramebuffer(0, 0, src_w, src_h, 0, height, width, 0, GL_COLOR_BUFFER_BIT,
+                          src_w == width && src_h == height ? GL_NEAREST : GL_LINEAR);
+
+        // 读回到 PBO，立即返回
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        slot.pts = AV_NOPTS_VALUE;
+        slot.state.store(Reading, std::memory_order_relaxed);
+        reading.push_back(next_slot);
+        last_captured = next_slot;
+        next_slot = (next_slot + 1) % Slots;
+        ++captured;
+    }
+
+    void ScreenRecorder::on_presented(Clock::time_point when) {
+        if (last_captured >= 0) {
+            if (!started) {
+                start_time = when;
+                started = true;
+            }
+            int64_t pts = std::chrono::duration_cast<std::chrono::microseconds>(when - start_time).count();
+            // 时间戳必须严格递增
+            if (last_pts != AV_NOPTS_VALUE && pts <= last_pts) pts = last_pts + 1;
+            slots[last_captured].pts = pts;
+            last_pts = pts;
+            last_captured = -1;
+        }
+        poll();
+    }
+
+    void ScreenRecorder::poll() {
+        while (!reading.empty() && hand_off(reading.front(), false)) {
+        }
+    }
+
+    bool ScreenRecorder::hand_off(int index, bool wait) {
+        Slot& slot = slots[index];
+        if (slot.pts == AV_NOPTS_VALUE) {
+            if (!wait) return false;
+            // 录制停止时最后一帧可能尚未显示
+            slot.pts = last_pts == AV_NOPTS_VALUE ? 0 : last_pts + 1;
+            last_pts = slot.pts;
+        }
+
+        const GLenum status = glClientWaitSync(slot.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                               wait ? GL_TIMEOUT_IGNORED : 0);
+        if (status == GL_TIMEOUT_EXPIRED) return false;
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        reading.pop_front();
+
+        EncodeItem item;
+        item.pts = slot.pts;
+        if (slot.mapped) {
+            // 编码线程直接读取映射内存，完成后释放槽位
+            item.slot = index;
+            slot.state.store(Encoding, std::memory_order_release);
+        } else {
+            AVFrame* frame = av_frame_alloc();
+            frame->width = width;
+            frame->height = height;
+            frame->format = AV_PIX_FMT_RGBA;
+            const size_t row_bytes = static_cast<size_t>(width) * 4;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            const auto* data = static_cast<const uint8_t*>(
+                    glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, row_bytes * height, GL_MAP_READ_BIT));
+            if (data && av_frame_get_buffer(frame, 0) >= 0) {
+                for (int y = 0; y < height; y++) {
+                    memcpy(frame->data[0] + y * frame->linesize[0], data + y * row_bytes, row_bytes);
+                }
+                item.frame = frame;
+            } else {
+                av_frame_free(&frame);
+            }
+            if (data) glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            slot.state.store(Free, std::memory_order_release);
+            if (!item.frame) {
+                ++dropped;
+                return true;
+            }
+        }
+
+        const bool queued = wait ? encode_queue->push(item) : encode_queue->tryPush(item);
+        if (!queued) {
+            ++dropped;
+            av_frame_free(&item.frame);
+            if (item.slot >= 0) slot.state.store(Free, std::memory_order_release);
+        }
+        return true;
+    }
+
+    void ScreenRecorder::encode_loop() {
+        // 指向持久映射内存的帧，不持有数据
+        AVFrame* view = av_frame_alloc();
+        view->width = width;
+        view->height = height;
+        view->format = AV_PIX_FMT_RGBA;
+        view->linesize[0] = width * 4;
+
+        bool failed = false;
+        EncodeItem item;
+        while (encode_queue->pop(item)) {
+            AVFrame* frame = item.frame;
+            if (item.slot >= 0) {
+                view->data[0] = const_cast<uint8_t*>(slots[item.slot].mapped);
+                frame = view;
+            }
+            frame->pts = item.pts;
+
+            if (!failed) {
+                if (encoder->encode(frame)) {
+                    ++encoded;
+                } else {
+                    LOG_ERROR("录制编码失败，后续帧将被丢弃");
+                    failed = true;
+                }
+            }
+
+            if (item.slot >= 0) {
+                slots[item.slot].state.store(Free, std::memory_order_release);
+            } else {
+                av_frame_free(&item.frame);
+            }
+        }
+
+        view->data[0] = nullptr;
+        av_frame_free(&view);
+        encoder->finish();
+    }
+
+    RecordStats ScreenRecorder::stats() const {
+        RecordStats result;
+        result.captured = captured;
+        result.encoded = encoded;
+        result.dropped = dropped;
+        return result;
+    }
+
+} // namespace video
@@ -7,28 +7,45 @@
 
 namespace video {
 
-    TextRenderer::TextRenderer(const char* font_path, int font_size) {
-        if (TTF_Init() != 0) {
-            throw std::runtime_error("TTF_Init failed");
-        }
-        font = TTF_OpenFont(font_path, font_size);
-        if (!font) {
-            throw std::runtime_error("无法加载字体文件");
+    TextRenderer::TextRenderer(SDL_Renderer* renderer, const char* font_path, int font_size)
+        : renderer(renderer), atlas(font_path, font_size) {
+        atlas_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC,
+                                          GlyphAtlas::AtlasSize, GlyphAtlas::AtlasSize);
+        if (!atlas_texture) {
+            throw std::runtime_error(SDL_GetError());
         }
+        SDL_SetTextureBlendMode(atlas_texture, SDL_BLENDMODE_BLEND);
     }
 
     TextRenderer::~TextRenderer() {
-        if (font) TTF_CloseFont(font);
-        TTF_Quit();
+        if (atlas_texture) SDL_DestroyTexture(atlas_texture);
     }
 
-    SDL_Texture* TextRenderer::render_text(SDL_Renderer* renderer, const std::string& text, SDL_Color color) {
-        SDL_Surface* surface = TTF_RenderUTF8_Blended(font, text.c_str(), color);
-        if (!surface) return nullptr;
+    float TextRenderer::draw_text(const std::string& text, float x, float y, SDL_Color color) {
+        quads.clear();
+        const float width = atlas.layout(text, x, y, quads);
+        if (quads.empty()) return width;
+
+        // 只上传新光栅化字形所在的行
+        int y0, y1;
+        if (atlas.take_dirty_rows(y0, y1)) {
+            SDL_Rect rect = {0, y0, GlyphAtlas::AtlasSize, y1 - y0};
+            SDL_UpdateTexture(atlas_texture, &rect, atlas.pixels() + y0 * GlyphAtlas::AtlasSize * 4,
+                              GlyphAtlas::AtlasSize * 4);
+        }
 
-        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_FreeSurface(surface);
-        return texture;
+        vertices.clear();
+        indices.clear();
+        for (const auto& q : quads) {
+            const int base = static_cast<int>(vertices.size());
+            vertices.push_back({{q.x0, q.y0}, color, {q.u0, q.v0}});
+            vertices.push_back({{q.x1, q.y0}, color, {q.u1, q.v0}});
+            vertices.push_back({{q.x1, q.y1}, color, {q.u1, q.v1}});
+            vertices.push_back({{q.x0, q.y1}, color, {q.u0, q.v1}});
+            indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+        }
+        SDL_RenderGeometry(renderer, atlas_texture, vertices.data(), static_cast<int>(vertices.size()),
+                           indices.data(), static_cast<int>(indices.size()));
+        return width;
     }
 }
-
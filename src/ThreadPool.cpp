@@ -0,0 +1,140 @@
+//
+// Created by Weichuandong on 2025/4/2.
+//
+
+#include "video/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace video {
+
+    namespace {
+        // 当前线程所属的线程池与队列下标，用于把工作线程提交的任务放进自己的队列
+        thread_local const ThreadPool* current_pool = nullptr;
+        thread_local int current_index = -1;
+    }
+
+    ThreadPool::ThreadPool(int threads) {
+        if (threads <= 0) {
+            threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+        }
+        for (int i = 0; i < threads; i++) {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (int i = 0; i < threads; i++) {
+            workers.emplace_back(&ThreadPool::worker_loop, this, i);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        sleep_cv.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::submit(std::function<void()> task) {
+        const int index = current_pool == this ? current_index
+                        : static_cast<int>(next_queue++ % queues.size());
+        {
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->tasks.push_back(std::move(task));
+        }
+        ++pending;
+        // 先计数再加锁通知，等待中的线程不会错过唤醒
+        { std::lock_guard<std::mutex> lock(sleep_mutex); }
+        sleep_cv.notify_one();
+    }
+
+    bool ThreadPool::take(int index, std::function<void()>& task) {
+        {
+            WorkerQueue& own = *queues[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        const int count = static_cast<int>(queues.size());
+        for (int k = 1; k < count; k++) {
+            WorkerQueue& victim = *queues[(index + k) % count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ThreadPool::worker_loop(int index) {
+        current_pool = this;
+        current_index = index;
+        while (true) {
+            std::function<void()> task;
+            if (take(index, task)) {
+                --pending;
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            sleep_cv.wait(lock, [this] { return stopping || pending.load() > 0; });
+            // 退出前执行完已提交的任务
+            if (stopping && pending.load() == 0) return;
+        }
+    }
+
+    void ThreadPool::parallel_for(int count, const std::function<void(int)>& fn) {
+        if (count <= 0) return;
+        if (count == 1 || workers.empty()) {
+            for (int i = 0; i < count; i++) fn(i);
+            return;
+        }
+
+        // 下标按需领取，先完成的线程多做；共享状态由辅助任务持有，
+        // 调用方只等待所有下标完成，不等待晚启动、领不到下标的辅助任务
+        struct State {
+            std::atomic<int> next{0};
+            std::atomic<int> done{0};
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+        auto state = std::make_shared<State>();
+        const std::function<void(int)>* body = &fn;
+
+        auto run = [state, body, count] {
+            int finished = 0;
+            for (int i = state->next++; i < count; i = state->next++) {
+                (*body)(i);
+                ++finished;
+            }
+            if (finished > 0 && state->done.fetch_add(finished) + finished == count) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->finished.notify_all();
+            }
+        };
+
+        const int helpers = std::min(count - 1, size());
+        for (int i = 0; i < helpers; i++) {
+            submit(run);
+        }
+        run();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&] { return state->done.load() == count; });
+    }
+
+    ThreadPool& ThreadPool::shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+} // namespace video
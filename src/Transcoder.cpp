@@ -0,0 +1,272 @@
+//
+// Created by WeiChuandong on 2025/3/20.
+//
+
+#include "video/Transcoder.h"
+#include "video/filters/BuiltinFilters.h"
+
+#include <thread>
+#include <algorithm>
+
+extern "C" {
+#include <libavutil/time.h>
+}
+
+namespace video {
+
+    Transcoder::Transcoder(const TranscodeOptions& options) : options(options) {
+    }
+
+    namespace {
+        constexpr size_t FrameQueueDepth = 8;
+    }
+
+    Transcoder::~Transcoder() {
+        MemoryBudget::shared().remove(this);
+    }
+
+    size_t Transcoder::memory_usage() const {
+        size_t frames = 0;
+        if (frame_queue) frames += frame_queue->size();
+        if (segment_queue) frames += segment_queue->size() * options.segmentFrames;
+        return frames * frame_bytes;
+    }
+
+    void Transcoder::on_memory_pressure(int level) {
+        if (frame_queue) {
+            const size_t depth[MemoryBudget::PressureLevels] = {FrameQueueDepth, 2, 1};
+            frame_queue->setCapacity(depth[level]);
+        }
+        if (segment_queue) {
+            // 每个分段有整段的帧，紧张时只排队一段
+            const size_t depth[MemoryBudget::PressureLevels] = {segment_depth, std::min<size_t>(segment_depth, 2), 1};
+            segment_queue->setCapacity(depth[level]);
+        }
+    }
+
+    bool Transcoder::run() {
+        decoder = std::make_unique<FFmpegDecoder>(options.input);
+
+        // 与交互播放使用同一套滤镜，保证输出一致
+        FilterManager& filterManager = decoder->getFilterManager();
+        registerBuiltinFilters(filterManager);
+        filterManager.setThreadCount(options.filterThreads);
+        for (const auto& name : options.filters) {
+            if (!filterManager.activateFilter(name)) {
+                return false;
+            }
+        }
+        if (!filterManager.waitForBuilds()) {
+            LOG_ERROR("滤镜链构建失败");
+            return false;
+        }
+
+        // 解码与滤镜重叠执行
+        decoder->setFilterPipeline(true, 4);
+
+        AVRational frame_rate = decoder->frame_rate();
+        if (frame_rate.num <= 0 || frame_rate.den <= 0) frame_rate = {25, 1};
+        const AVRational time_base = decoder->time_base();
+
+        const bool segmented = options.segmentFrames > 0;
+        const int hw_threads = std::max(1u, std::thread::hardware_concurrency());
+        const int workers = options.encodeWorkers > 0 ? options.encodeWorkers : std::max(1, hw_threads / 2);
+
+        if (segmented) {
+            segment_depth = workers;
+            segment_queue = std::make_unique<BoundedQueue<Segment>>(segment_depth);
+        } else {
+            frame_queue = std::make_unique<BoundedQueue<AVFrame*>>(FrameQueueDepth);
+        }
+        MemoryBudget::shared().add(this, "transcode");
+
+        std::vector<std::thread> threads;
+        Segment segment;
+        int segment_count = 0;
+        start_time_us = av_gettime_relative();
+        last_report_us = start_time_us;
+
+        FFmpegDecoder::YUVData yuvData{};
+        while (!encode_failed && decoder->get_next_frame(yuvData)) {
+            AVFrame* frame = yuvData.frame;
+
+            if (frame->pts == AV_NOPTS_VALUE) {
+                frame->pts = av_rescale_q(frames_decoded, av_inv_q(frame_rate), time_base);
+            }
+
+            // 滤镜可能改变输出尺寸（如四分屏），编码器按首帧参数创建
+            if (!encoder) {
+                EncoderConfig config;
+                config.path = options.output;
+                config.codecName = options.codec;
+                config.width = frame->width;
+                config.height = frame->height;
+                config.inputFormat = static_cast<AVPixelFormat>(frame->format);
+                config.timeBase = time_base;
+                config.frameRate = frame_rate;
+                config.bitRate = options.bitRate;
+                if (segmented) {
+                    // 每个分段以关键帧开头独立编码；关闭 B 帧保证分段拼接后 dts 单调
+                    config.gopSize = options.segmentFrames;
+                    config.maxBFrames = 0;
+                    config.segmented = true;
+                }
+                encoder = std::make_unique<VideoEncoder>(config);
+
+                if (segmented) {
+                    const int threads_per_worker = std::max(1, hw_threads / workers);
+                    for (int i = 0; i < workers; i++) {
+                        threads.emplace_back(&Transcoder::segment_worker, this, threads_per_worker);
+                    }
+                    LOG_INFO("GOP 分段并行编码: {} 帧/段, {} 个编码线程", options.segmentFrames, workers);
+                } else {
+                    threads.emplace_back(&Transcoder::encode_loop, this);
+                }
+                frame_bytes = frame_memory(frame);
+            }
+
+            // 之后由编码线程负责释放
+            yuvData.frame = nullptr;
+
+            ++frames_decoded;
+            media_seconds = decoder->get_current_pts();
+
+            if (segmented) {
+                segment.frames.push_back(frame);
+                if (static_cast<int>(segment.frames.size()) >= options.segmentFrames) {
+                    segment.index = segment_count++;
+                    segment_queue->push(std::move(segment));
+                    segment = Segment();
+                }
+            } else {
+                frame_queue->push(frame);
+            }
+
+            report_progress(false);
+            MemoryBudget::shared().update();
+        }
+
+        // 收尾：提交最后一个分段并等待所有编码线程结束
+        if (segmented && segment_queue) {
+            if (!segment.frames.empty()) {
+                segment.index = segment_count++;
+                segment_queue->push(std::move(segment));
+            }
+            segment_queue->close();
+        }
+        if (frame_queue) frame_queue->close();
+        for (auto& t : threads) t.join();
+
+        for (auto& s : finished_segments) {
+            for (auto* pkt : s.second.packets) av_packet_free(&pkt);
+        }
+        finished_segments.clear();
+
+        MemoryBudget::shared().remove(this);
+        bool ok = !encode_failed && encoder && encoder->finish();
+        report_progress(true);
+        return ok;
+    }
+
+    void Transcoder::encode_loop() {
+        AVFrame* frame = nullptr;
+        while (frame_queue->pop(frame)) {
+            if (!encode_failed && !encoder->encode(frame)) {
+                encode_failed = true;
+            }
+            av_frame_free(&frame);
+        }
+    }
+
+    void Transcoder::segment_worker(int threads) {
+        SwsContext* sws = nullptr;
+        Segment segment;
+        while (segment_queue->pop(segment)) {
+            EncodedSegment out;
+            if (!encode_failed) {
+                // 每个分段使用全新的编码上下文，首帧必为关键帧
+                AVCodecContext* ctx = encoder->create_segment_context(threads);
+                if (!ctx || !encode_segment(ctx, sws, segment, out)) {
+                    encode_failed = true;
+                }
+                avcodec_free_context(&ctx);
+            }
+            for (auto* frame : segment.frames) av_frame_free(&frame);
+
+            {
+                std::lock_guard<std::mutex> lock(write_mutex);
+                finished_segments[segment.index] = std::move(out);
+                write_ready_segments();
+            }
+            segment = Segment();
+        }
+        sws_freeContext(sws);
+    }
+
+    bool Transcoder::encode_segment(AVCodecContext* ctx, SwsContext*& sws, Segment& segment, EncodedSegment& out) {
+        AVPacket* pkt = av_packet_alloc();
+        bool ok = true;
+
+        auto receive = [&]() {
+            int ret;
+            while ((ret = avcodec_receive_packet(ctx, pkt)) >= 0) {
+                out.packets.push_back(av_packet_clone(pkt));
+                av_packet_unref(pkt);
+            }
+            return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF;
+        };
+
+        for (auto* frame : segment.frames) {
+            AVFrame* converted = VideoEncoder::convert_frame(sws, frame, ctx->pix_fmt);
+            if (!converted) {
+                ok = false;
+                break;
+            }
+            converted->pict_type = AV_PICTURE_TYPE_NONE;
+            int ret = avcodec_send_frame(ctx, converted);
+            av_frame_free(&converted);
+            if (ret < 0 || !receive()) {
+                ok = false;
+                break;
+            }
+        }
+
+        if (ok) {
+            avcodec_send_frame(ctx, nullptr);
+            ok = receive();
+        }
+        av_packet_free(&pkt);
+        return ok;
+    }
+
+    void Transcoder::write_ready_segments() {
+        // 调用者持有 write_mutex
+        auto it = finished_segments.find(next_segment_to_write);
+        while (it != finished_segments.end()) {
+            for (auto* pkt : it->second.packets) {
+                if (!encode_failed && !encoder->write_packet(pkt)) {
+                    encode_failed = true;
+                }
+                av_packet_free(&pkt);
+            }
+            finished_segments.erase(it);
+            it = finished_segments.find(++next_segment_to_write);
+        }
+    }
+
+    void Transcoder::report_progress(bool final) {
+        const int64_t now = av_gettime_relative();
+        if (!final && now - last_report_us < 2000000) return;
+        last_report_us = now;
+
+        const double elapsed = (now - start_time_us) / 1e6;
+        const double fps = elapsed > 0 ? frames_decoded / elapsed : 0.0;
+        const double speed = elapsed > 0 ? media_seconds / elapsed : 0.0;
+        if (final) {
+            LOG_INFO("转码完成: {} 帧, 耗时 {:.2f}s, {:.1f} fps, {:.2f}x 实时", frames_decoded, elapsed, fps, speed);
+        } else {
+            LOG_INFO("转码中: {} 帧, {:.1f} fps, {:.2f}x 实时", frames_decoded, fps, speed);
+        }
+    }
+
+} // namespace video
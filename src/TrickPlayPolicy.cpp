@@ -0,0 +1,79 @@
+//
+// Created by Weichuandong on 2025/4/3.
+//
+
+#include "video/TrickPlayPolicy.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace video {
+
+    namespace {
+        constexpr double SpeedSteps[] = {0.25, 0.5, 0.75, 1.0, 1.25, 1.5, 2.0, 4.0, 8.0, 16.0};
+        // 解码占用超过该比例时跳过更多帧；换速时预测负载低于 SelectLoad 的级别才选用
+        constexpr double OverloadLoad = 0.85;
+        constexpr double SelectLoad = 0.7;
+    }
+
+    const char* decode_skip_name(DecodeSkip skip) {
+        switch (skip) {
+            case DecodeSkip::None: return "full";
+            case DecodeSkip::NonRef: return "nonref";
+            case DecodeSkip::NonKey: return "keyframes";
+            default: return "unknown";
+        }
+    }
+
+    DecodeSkip TrickPlayPolicy::set_speed(double speed) {
+        playback_speed = std::clamp(speed, MinSpeed, MaxSpeed);
+
+        // 负载与速度成正比，未测量过的级别视为能跟上
+        level = 0;
+        if (playback_speed > 1.0) {
+            while (level < LevelCount - 1 && normalized_load[level] * playback_speed >= SelectLoad) {
+                level++;
+            }
+        }
+        frames_since_change = 0;
+        smoothed_load = 0.0;
+        return current();
+    }
+
+    DecodeSkip TrickPlayPolicy::step_speed(bool faster) {
+        const int count = static_cast<int>(sizeof(SpeedSteps) / sizeof(SpeedSteps[0]));
+        int index = 0;
+        while (index < count - 1 && SpeedSteps[index] < playback_speed - 1e-6) index++;
+        if (faster) {
+            // 当前速度不在档位上时取下一个更大的档位
+            if (SpeedSteps[index] <= playback_speed + 1e-6) index = std::min(index + 1, count - 1);
+        } else {
+            index = std::max(index - 1, 0);
+        }
+        return set_speed(SpeedSteps[index]);
+    }
+
+    DecodeSkip TrickPlayPolicy::update(double decode_seconds, double content_seconds) {
+        // 跳转或时间戳异常的样本不参与统计
+        if (content_seconds <= 0.0 || content_seconds / playback_speed > 1.0) {
+            return current();
+        }
+
+        const double load = decode_seconds * playback_speed / content_seconds;
+        smoothed_load = smoothed_load == 0.0 ? load : smoothed_load * 0.9 + load * 0.1;
+        frames_since_change++;
+        // 观察几帧后才记录，避免级别切换后的第一帧（如等待关键帧）影响测量
+        if (frames_since_change >= 8) {
+            normalized_load[level] = smoothed_load / playback_speed;
+        }
+
+        if (playback_speed > 1.0 && level < LevelCount - 1 &&
+            smoothed_load > OverloadLoad && frames_since_change >= 8) {
+            level++;
+            frames_since_change = 0;
+            smoothed_load = 0.0;
+        }
+        return current();
+    }
+
+} // namespace video
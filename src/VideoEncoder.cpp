@@ -0,0 +1,216 @@
+//
+// Created by WeiChuandong on 2025/3/20.
+//
+
+#include "video/VideoEncoder.h"
+
+#include <cstring>
+
+extern "C" {
+#include <libavutil/opt.h>
+}
+
+namespace video {
+
+    static std::string error_string(int err) {
+        char errBuff[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(err, errBuff, sizeof(errBuff));
+        return errBuff;
+    }
+
+    VideoEncoder::VideoEncoder(const EncoderConfig& config_) : config(config_) {
+        if (avformat_alloc_output_context2(&fmt_ctx, nullptr, nullptr, config.path.c_str()) < 0 || !fmt_ctx) {
+            throw std::runtime_error("无法创建输出封装: " + config.path);
+        }
+
+        codec = avcodec_find_encoder_by_name(config.codecName.c_str());
+        if (!codec) {
+            LOG_WARN("找不到编码器 {}，使用容器默认编码器", config.codecName);
+            codec = avcodec_find_encoder(fmt_ctx->oformat->video_codec);
+        }
+        if (!codec) {
+            avformat_free_context(fmt_ctx);
+            throw std::runtime_error("找不到可用的视频编码器");
+        }
+
+        // 分段模式下主上下文只提供流参数，不打开编码器
+        codec_ctx = configure_context(config.threads);
+        if (codec_ctx && !config.segmented) {
+            if (fmt_ctx->oformat->flags & AVFMT_GLOBALHEADER) {
+                codec_ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+            }
+            codec_ctx = open_context(codec_ctx);
+        }
+        if (!codec_ctx) {
+            avformat_free_context(fmt_ctx);
+            throw std::runtime_error("无法打开编码器");
+        }
+
+        stream = avformat_new_stream(fmt_ctx, nullptr);
+        stream->time_base = codec_ctx->time_base;
+        stream->avg_frame_rate = config.frameRate;
+        avcodec_parameters_from_context(stream->codecpar, codec_ctx);
+
+        if (!(fmt_ctx->oformat->flags & AVFMT_NOFILE)) {
+            if (avio_open(&fmt_ctx->pb, config.path.c_str(), AVIO_FLAG_WRITE) < 0) {
+                avcodec_free_context(&codec_ctx);
+                avformat_free_context(fmt_ctx);
+                throw std::runtime_error("无法打开输出文件: " + config.path);
+            }
+        }
+
+        if (avformat_write_header(fmt_ctx, nullptr) < 0) {
+            if (!(fmt_ctx->oformat->flags & AVFMT_NOFILE)) avio_closep(&fmt_ctx->pb);
+            avcodec_free_context(&codec_ctx);
+            avformat_free_context(fmt_ctx);
+            throw std::runtime_error("无法写入文件头");
+        }
+
+        LOG_INFO("编码输出: {} ({} {}x{}, {})", config.path, codec->name,
+                 config.width, config.height, av_get_pix_fmt_name(codec_ctx->pix_fmt));
+    }
+
+    VideoEncoder::~VideoEncoder() {
+        finish();
+        sws_freeContext(sws_ctx);
+        avcodec_free_context(&codec_ctx);
+        if (fmt_ctx) {
+            if (!(fmt_ctx->oformat->flags & AVFMT_NOFILE)) avio_closep(&fmt_ctx->pb);
+            avformat_free_context(fmt_ctx);
+        }
+    }
+
+    AVCodecContext* VideoEncoder::configure_context(int threads) const {
+        AVCodecContext* ctx = avcodec_alloc_context3(codec);
+        if (!ctx) return nullptr;
+
+        ctx->width = config.width;
+        ctx->height = config.height;
+        ctx->time_base = config.timeBase;
+        ctx->framerate = config.frameRate;
+        ctx->sample_aspect_ratio = {1, 1};
+        ctx->thread_count = threads;
+        if (config.bitRate > 0) ctx->bit_rate = config.bitRate;
+        if (config.gopSize > 0) ctx->gop_size = config.gopSize;
+        if (config.maxBFrames >= 0) ctx->max_b_frames = config.maxBFrames;
+
+        // 优先使用输入格式，避免不必要的转换
+        ctx->pix_fmt = config.outputFormat != AV_PIX_FMT_NONE ? config.outputFormat : config.inputFormat;
+        if (codec->pix_fmts) {
+            bool supported = false;
+            for (const AVPixelFormat* p = codec->pix_fmts; *p != AV_PIX_FMT_NONE; p++) {
+                if (*p == ctx->pix_fmt) supported = true;
+            }
+            if (!supported) {
+                ctx->pix_fmt = avcodec_find_best_pix_fmt_of_list(codec->pix_fmts, config.inputFormat, 0, nullptr);
+            }
+        }
+
+        if (!config.preset.empty() && ctx->priv_data &&
+            av_opt_set(ctx->priv_data, "preset", config.preset.c_str(), 0) < 0) {
+            LOG_WARN("编码器 {} 不支持 preset {}", codec->name, config.preset);
+        }
+        return ctx;
+    }
+
+    AVCodecContext* VideoEncoder::open_context(AVCodecContext* ctx) const {
+        if (avcodec_open2(ctx, codec, nullptr) < 0) {
+            avcodec_free_context(&ctx);
+            return nullptr;
+        }
+        return ctx;
+    }
+
+    AVCodecContext* VideoEncoder::create_segment_context(int threads) const {
+        AVCodecContext* ctx = configure_context(threads);
+        if (!ctx) return nullptr;
+        // 各分段的编码器各自生成 SPS/PPS，不保证与流头中的参数集逐字节一致：
+        // 不使用全局头，参数集写在关键帧前，每个分段可独立解码（mp4 由首个数据包生成 avcC）
+        if (strcmp(codec->name, "libx264") == 0) {
+            av_opt_set(ctx->priv_data, "x264-params", "repeat-headers=1", 0);
+        }
+        return open_context(ctx);
+    }
+
+    AVFrame* VideoEncoder::convert_frame(SwsContext*& sws, const AVFrame* src, AVPixelFormat dst_format) {
+        if (src->format == dst_format) {
+            return av_frame_clone(src);
+        }
+
+        sws = sws_getCachedContext(sws, src->width, src->height, static_cast<AVPixelFormat>(src->format),
+                                   src->width, src->height, dst_format,
+                                   SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!sws) return nullptr;
+
+        AVFrame* dst = av_frame_alloc();
+        dst->width = src->width;
+        dst->height = src->height;
+        dst->format = dst_format;
+        if (av_frame_get_buffer(dst, 0) < 0) {
+            av_frame_free(&dst);
+            return nullptr;
+        }
+        sws_scale(sws, src->data, src->linesize, 0, src->height, dst->data, dst->linesize);
+        av_frame_copy_props(dst, src);
+        return dst;
+    }
+
+    bool VideoEncoder::encode(const AVFrame* frame) {
+        if (finished || !avcodec_is_open(codec_ctx)) return false;
+
+        AVFrame* converted = convert_frame(sws_ctx, frame, codec_ctx->pix_fmt);
+        if (!converted) {
+            LOG_ERROR("编码前像素格式转换失败");
+            return false;
+        }
+        // 关键帧由编码器根据 GOP 决定
+        converted->pict_type = AV_PICTURE_TYPE_NONE;
+
+        int ret = avcodec_send_frame(codec_ctx, converted);
+        av_frame_free(&converted);
+        if (ret < 0) {
+            LOG_ERROR("发送编码帧失败: {}", error_string(ret));
+            return false;
+        }
+        return drain(codec_ctx);
+    }
+
+    bool VideoEncoder::drain(AVCodecContext* ctx) {
+        AVPacket* pkt = av_packet_alloc();
+        int ret;
+        while ((ret = avcodec_receive_packet(ctx, pkt)) >= 0) {
+            if (!write_packet(pkt)) {
+                av_packet_free(&pkt);
+                return false;
+            }
+        }
+        av_packet_free(&pkt);
+        return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF;
+    }
+
+    bool VideoEncoder::write_packet(AVPacket* pkt) {
+        pkt->stream_index = stream->index;
+        av_packet_rescale_ts(pkt, codec_ctx->time_base, stream->time_base);
+        // av_interleaved_write_frame 会接管数据包引用
+        int ret = av_interleaved_write_frame(fmt_ctx, pkt);
+        if (ret < 0) {
+            LOG_ERROR("写入数据包失败: {}", error_string(ret));
+            return false;
+        }
+        return true;
+    }
+
+    bool VideoEncoder::finish() {
+        if (finished) return true;
+        finished = true;
+
+        bool ok = true;
+        if (avcodec_is_open(codec_ctx)) {
+            avcodec_send_frame(codec_ctx, nullptr);
+            ok = drain(codec_ctx);
+        }
+        ok = av_write_trailer(fmt_ctx) == 0 && ok;
+        return ok;
+    }
+
+} // namespace video
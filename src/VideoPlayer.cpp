@@ -4,42 +4,84 @@
 
 #include "video/VideoPlayer.h"
 
+#include <cmath>
+#include <cstdlib>
+#include <iterator>
+
 namespace video {
-    VideoPlayer::VideoPlayer(const std::string& filepath)
-        : decoder(std::make_unique<FFmpegDecoder>(filepath)),
-          gl_renderer(std::make_unique<GLRenderer>(decoder->width(), decoder->height())),
-          rgb_buffer(new uint8_t[decoder->width() * decoder->height() * 3]) {
-        // 视频时长信息
-        duration = decoder->duration();
-        // 绑定键盘事件回调
-        gl_renderer->setEventCallback([this](SDL_Keycode key) {
-            this->handleKeyPress(key);
-        });
-
-        gl_renderer->setSeekCallback([this](float ratio) {
-            this->handleSeek(ratio);
-        });
-
-        gl_renderer->setFrameStepCallback([this](bool forward) {
-            if (forward) {
-                step_forward_frame();
-            } else {
-                step_back_frame();
+    namespace {
+        std::unique_ptr<VideoRenderer> create_renderer(const PlayerOptions& options, int width, int height) {
+            if (options.renderer == RendererBackend::SDL) {
+                return std::make_unique<SDLRenderer>(width, height, options.swapMode);
             }
-        });
+            return std::make_unique<GLRenderer>(width, height, options.swapMode);
+        }
+
+        bool is_live(const PlayerOptions& options, const std::string& filepath) {
+            return options.live || is_live_url(filepath);
+        }
+
+        // 按键 1~7 对应的滤镜，intensity < 0 表示不设置强度
+        struct FilterKey {
+            const char* name;
+            float intensity;
+        };
+        constexpr FilterKey FilterKeys[] = {
+            {"vflip", -1.0f}, {"hflip", -1.0f}, {"hmirror", -1.0f}, {"vmirror", -1.0f},
+            {"quadmirror", -1.0f}, {"gray", 1.0f}, {"gray", 0.5f}
+        };
+
+        DecoderOptions decoder_options(const PlayerOptions& options, const std::string& filepath) {
+            DecoderOptions decoder;
+            decoder.network.enabled = options.networkCache;
+            decoder.network.cacheDir = options.cacheDir;
+            decoder.network.cacheLimit = options.cacheLimit;
+            decoder.lowLatency = is_live(options, filepath);
+            return decoder;
+        }
+    }
 
-        gl_renderer->setIsPausedCallback([this](){
-            return is_paused;
-        });
+    VideoPlayer::VideoPlayer(const std::string& filepath, const PlayerOptions& options)
+        : decoder(std::make_unique<FFmpegDecoder>(filepath, decoder_options(options, filepath))),
+          renderer(create_renderer(options, decoder->width(), decoder->height())) {
+        // 视频时长信息
+        duration = decoder->duration();
+        // 直播：显示队列只留一帧，按数据包到达时刻估计延迟
+        live = is_live(options, filepath);
+        if (live) {
+            live_latency = LiveLatencyPolicy(options.liveLatency);
+            renderer->set_queue_depth(1);
+            decoder->setPacketCallback([this](double pts) {
+                live_latency.on_packet(pts);
+            });
+            duration = 0.0;
+            LOG_INFO("直播低延迟模式，目标延迟 {:.0f}ms", live_latency.target() * 1000.0);
+        }
 
         // 注册滤镜
-        decoder->getFilterManager().registerFilter(std::make_shared<FlipFilter>(FlipFilter::VERTICAL));
-        decoder->getFilterManager().registerFilter(std::make_shared<FlipFilter>(FlipFilter::HORIZONTAL));
-        decoder->getFilterManager().registerFilter(std::make_shared<MirrorFilter>(MirrorFilter::HORIZONTAL));
-        decoder->getFilterManager().registerFilter(std::make_shared<MirrorFilter>(MirrorFilter::VERTICAL));
-        decoder->getFilterManager().registerFilter(std::make_shared<MirrorFilter>(MirrorFilter::QUAD));
-        decoder->getFilterManager().registerFilter(std::make_shared<GrayscaleFilter>(1.0f));
-        decoder->getFilterManager().registerFilter(std::make_shared<GrayscaleFilter>(0.5f));
+        registerBuiltinFilters(decoder->getFilterManager());
+
+        // 滤镜线程配置
+        decoder->getFilterManager().setThreadCount(options.filterThreads);
+        decoder->setFilterPipeline(options.filterPipeline, live ? 1 : options.filterPipelineDepth);
+
+        renderer->set_scaler(options.scaleFilter, options.prescale);
+        allowPrescale = options.prescale;
+        accurateSeek = options.accurateSeek;
+
+        apply_decode_skip(trick_play.set_speed(live ? 1.0 : options.speed));
+
+        recordBasePath = options.recordPath.empty() ? "recording.mp4" : options.recordPath;
+        recordOptions.codec = options.recordCodec;
+        recordOptions.bitRate = options.recordBitRate;
+        if (!options.recordPath.empty()) {
+            toggleRecording();
+        }
+
+        // 解码直接写入 GL 暂存缓冲（SDL 后端没有暂存缓冲，池为空时解码器自行分配）
+        if (options.zeroCopyDecode) {
+            decoder->setFrameBufferPool(renderer->frame_buffer_pool());
+        }
 
         LOG_INFO("初始化播放器: {} ({}x{}), 时长: {:.2f}s",
                  filepath,
@@ -49,132 +91,231 @@ namespace video {
         );
     }
 
+    VideoPlayer::~VideoPlayer() {
+        // 解码器持有的帧可能位于渲染器的暂存缓冲中，必须先于渲染器释放
+        decoder.reset();
+        renderer.reset();
+    }
+
     void VideoPlayer::run() {
-        /* 主循环：解码 + 渲染 */
-        while (!shouldQuit && gl_renderer->handle_events()) {
+        /* 主线程只处理窗口事件，解码在播放线程，绘制在渲染线程（SDL 后端在主线程） */
+        std::thread playback(&VideoPlayer::playback_loop, this);
+
+        while (!shouldQuit && renderer->handle_events()) {
+            // handle_events 内部最多等待 10ms，及时响应播放线程的退出
+        }
+        shouldQuit = true;
+        // 显示队列已无人消费（SDL 后端），让阻塞在提交中的播放线程退出
+        renderer->close();
+
+        playback.join();
+    }
+
+    void VideoPlayer::playback_loop() {
+        /* 播放线程：处理输入 + 解码 + 提交显示 */
+        while (!shouldQuit && apply_commands()) {
+            // 汇总内存占用，超出预算时各子系统收缩
+            MemoryBudget::shared().update();
+
             FFmpegDecoder::YUVData yuvData{};
 
-            bool frame_available = !is_paused && decoder->get_next_frame(yuvData);
+            const auto decode_start = std::chrono::steady_clock::now();
+            bool frame_available = !is_paused && !scrubbing && decoder->get_next_frame(yuvData);
             if (frame_available) {
-                gl_renderer->render_frame(yuvData.frame->data[0], yuvData.frame->data[1], yuvData.frame->data[2],
-                                          yuvData.frame->width, yuvData.frame->height,
-                                          yuvData.frame->linesize[0], yuvData.frame->linesize[1]);
-
-                gl_renderer->render_ui(decoder->get_current_pts() / duration,
-                                       decoder->get_current_pts(),
-                                       duration,
-                                       is_paused,
-                                       false);
-                SDL_Delay(33);
-            } else if (is_paused) {
-                SDL_Delay(100);
+                // 按解码占用的时间比例决定快进时是否跳帧
+                const double decode_seconds = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - decode_start).count();
+                const double pts = decoder->get_current_pts();
+                apply_decode_skip(trick_play.update(decode_seconds, pts - last_decoded_pts));
+                last_decoded_pts = pts;
+
+                // 直播积压过多时丢弃这一帧，直接解码下一帧追赶
+                if (live && !keep_live_latency(pts)) continue;
+
+                // 显示队列满时在此阻塞，播放速度由渲染线程的显示调度决定
+                if (!present(yuvData)) break;
+            } else if (is_paused || scrubbing) {
+                SDL_Delay(10);
             } else {
                 break;
             }
         }
+        shouldQuit = true;
+    }
+
+    bool VideoPlayer::present(FFmpegDecoder::YUVData& yuvData) {
+        OverlayState state;
+        state.progress = duration > 0.0 ? static_cast<float>(decoder->get_current_pts() / duration) : 0.0f;
+        state.current_time = decoder->get_current_pts();
+        state.total_time = duration;
+        // 暂停与拖动预览的帧立即显示
+        state.is_paused = is_paused || scrubbing;
+        state.speed = live ? live_latency.speed() : trick_play.speed();
+        if (live) {
+            state.show_timeline = false;
+            state.live_latency = std::max(0.0, live_latency.latency());
+        }
+        state.seek_time = seek_requested;
+        seek_requested = {};
+
+        // 帧的所有权交给渲染线程
+        AVFrame* frame = yuvData.frame;
+        yuvData.frame = nullptr;
+        return renderer->submit_frame(frame, state);
     }
 
-    void VideoPlayer::handleSeek(float ration) {
+    void VideoPlayer::handleSeek(float ration, bool preview) {
+        if (live) return;
         const double target_time = ration * duration;
-        decoder->seek(target_time);
+        // 旧位置已解码、尚未显示的帧不再显示
+        renderer->discard_queued();
+
+        if (preview) {
+            // 拖动中只解码目标位置之前的关键帧，预览跟手
+            scrubbing = true;
+            seek_requested = std::chrono::steady_clock::now();
+            FFmpegDecoder::YUVData yuvData{};
+            if (decoder->preview_frame(target_time, yuvData)) {
+                present(yuvData);
+            }
+            LOG_DEBUG("Scrub preview: {:.2f}s (ration={})", target_time, ration);
+            return;
+        }
+
+        scrubbing = false;
+        seek_to(target_time);
         is_paused = false;
         LOG_DEBUG("Seek to: {:.2f}s (ration={})", target_time, ration);
     }
 
-    void VideoPlayer::handleKeyPress(SDL_Keycode key) {
-        switch (key) {
-            case SDLK_SPACE: {
+    void VideoPlayer::seek_to(double seconds) {
+        if (live) {
+            LOG_INFO("直播模式不支持跳转");
+            return;
+        }
+        seek_requested = std::chrono::steady_clock::now();
+        decoder->seek(seconds, accurateSeek);
+    }
+
+    bool VideoPlayer::apply_commands() {
+        // 输入线程投递的命令在这里统一取出，合并后依次执行，不与解码、提交交错
+        renderer->commands().drain(pending_commands);
+        for (const PlayerCommand& command : pending_commands) {
+            if (command.event == PlayerEvent::Quit) {
+                LOG_INFO("退出播放");
+                return false;
+            }
+            handle_command(command);
+        }
+        return true;
+    }
+
+    void VideoPlayer::handle_command(const PlayerCommand& command) {
+        switch (command.event) {
+            case PlayerEvent::PlayPause: {
                 is_paused = !is_paused;
                 if (is_paused) LOG_INFO("播放器暂停");
                 else LOG_INFO("继续播放");
                 break;
             }
-
-            case SDLK_LEFT: {
-                if (!is_paused) {
-                    double current_time = decoder->get_current_pts();
-                    decoder->seek(std::max(0.0, current_time - 5.0));
-                    LOG_INFO("duration = {}, current_time = {}, 后退5S", duration, current_time);
+            case PlayerEvent::SeekBackWard_5:
+            case PlayerEvent::SeekForward_5: {
+                const bool forward = command.event == PlayerEvent::SeekForward_5;
+                // 暂停时方向键单帧步进，连按的次数合并在 value 中
+                if (is_paused) {
+                    const long steps = std::max(1L, std::lround(command.value / RelativeSeekSeconds));
+                    handle_command({PlayerEvent::StepFrame, 0.0, static_cast<int>(forward ? steps : -steps)});
+                    break;
                 }
+                const double current_time = decoder->get_current_pts();
+                seek_to(forward ? std::min(duration, current_time + command.value)
+                                : std::max(0.0, current_time - command.value));
+                LOG_INFO("duration = {}, current_time = {}, {}{}S", duration, current_time,
+                         forward ? "前进" : "后退", command.value);
                 break;
             }
-            case SDLK_RIGHT: {
-                if (!is_paused) {
-                    double current_time = decoder->get_current_pts();
-                    decoder->seek(std::min(duration, current_time + 5.0));
-                    LOG_INFO("duration = {}, current_time = {}, 前进5S", duration, current_time);
+            case PlayerEvent::StepFrame: {
+                // 播放中按步进键先暂停
+                is_paused = true;
+                for (int i = 0; i < std::abs(command.arg); i++) {
+                    if (command.arg > 0) step_forward_frame();
+                    else step_back_frame();
                 }
                 break;
             }
-            case SDLK_ESCAPE: {
-                shouldQuit = true;
-                LOG_INFO("ESC 退出");
-                break;
-            }
-            case SDLK_BACKSPACE: {
-                decoder->seek(0.0);
+            case PlayerEvent::Restart: {
+                seek_to(0.0);
                 LOG_INFO("从头播放");
                 break;
             }
-            case SDLK_1: {
-                if (decoder->getFilterManager().isFilterExists("vflip")) {
-                    decoder->getFilterManager().deactivateFilter("vflip");
-                } else {
-                    decoder->getFilterManager().activateFilter("vflip");
-                }
+            case PlayerEvent::Seek: {
+                handleSeek(static_cast<float>(command.value), command.arg != 0);
                 break;
             }
-            case SDLK_2: {
-                if (decoder->getFilterManager().isFilterExists("hflip")) {
-                    decoder->getFilterManager().deactivateFilter("hflip");
-                } else {
-                    decoder->getFilterManager().activateFilter("hflip");
+            // 播放速度：立即生效，连按的档数已合并
+            case PlayerEvent::SpeedStep: {
+                if (live) {
+                    LOG_INFO("直播模式下播放速度由延迟控制");
+                    break;
+                }
+                for (int i = 0; i < std::abs(command.arg); i++) {
+                    apply_decode_skip(trick_play.step_speed(command.arg > 0));
                 }
+                LOG_INFO("播放速度: {}x", trick_play.speed());
                 break;
             }
-            case SDLK_3: {
-                if (decoder->getFilterManager().isFilterExists("hmirror")) {
-                    decoder->getFilterManager().deactivateFilter("hmirror");
+            case PlayerEvent::ToggleFilter: {
+                if (command.arg < 0 || command.arg >= static_cast<int>(std::size(FilterKeys))) break;
+                const FilterKey& filter = FilterKeys[command.arg];
+                FilterManager& filters = decoder->getFilterManager();
+                // 以最新请求为准，同一帧边界内连续的开关不会叠成两次激活
+                if (filters.isFilterRequested(filter.name)) {
+                    // 同一滤镜的另一档强度键（灰度 6/7）切换强度，而不是关闭
+                    float current = 0.0f;
+                    if (filter.intensity >= 0.0f &&
+                        filters.getFilterParam(filter.name, "intensity", current) &&
+                        std::abs(current - filter.intensity) > 0.001f) {
+                        filters.setFilterParam(filter.name, "intensity", filter.intensity);
+                    } else {
+                        filters.deactivateFilter(filter.name);
+                    }
                 } else {
-                    decoder->getFilterManager().activateFilter("hmirror");
+                    if (filter.intensity >= 0.0f) {
+                        filters.setFilterParam(filter.name, "intensity", filter.intensity);
+                    }
+                    filters.activateFilter(filter.name);
                 }
                 break;
             }
-            case SDLK_4: {
-                if (decoder->getFilterManager().isFilterExists("vmirror")) {
-                    decoder->getFilterManager().deactivateFilter("vmirror");
-                } else {
-                    decoder->getFilterManager().activateFilter("vmirror");
-                }
+            // 灰度强度平滑调节，无需重建滤镜图
+            case PlayerEvent::AdjustFilter: {
+                decoder->getFilterManager().adjustFilterParam("gray", "intensity", command.arg);
                 break;
             }
-            case SDLK_5: {
-                if (decoder->getFilterManager().isFilterExists("quadmirror")) {
-                    decoder->getFilterManager().deactivateFilter("quadmirror");
-                } else {
-                    decoder->getFilterManager().activateFilter("quadmirror");
-                }
+            case PlayerEvent::ClearFilters: {
+                decoder->getFilterManager().deactivateAllFilter();
                 break;
             }
-            case SDLK_6: {
-                if (decoder->getFilterManager().isFilterExists("gray1.000000")) {
-                    decoder->getFilterManager().deactivateFilter("gray1.000000");
-                } else {
-                    decoder->getFilterManager().activateFilter("gray1.000000");
-                }
+            // 依次切换缩放方式
+            case PlayerEvent::CycleScaler: {
+                const int next = (static_cast<int>(renderer->scaler()) + 1) % static_cast<int>(ScaleFilter::Count);
+                renderer->set_scaler(static_cast<ScaleFilter>(next), allowPrescale);
+                LOG_INFO("缩放方式: {}", scale_filter_name(static_cast<ScaleFilter>(next)));
                 break;
             }
-            case SDLK_7: {
-                if (decoder->getFilterManager().isFilterExists("gray0.500000")) {
-                    decoder->getFilterManager().deactivateFilter("gray0.500000");
-                } else {
-                    decoder->getFilterManager().activateFilter("gray0.500000");
-                }
+            case PlayerEvent::ToggleRecording: {
+                toggleRecording();
+                // 暂停时也要立即开始/结束
+                FFmpegDecoder::YUVData redraw{};
+                present(redraw);
                 break;
             }
-
-            case SDLK_0: {
-                decoder->getFilterManager().deactivateAllFilter();
+            // 显示/隐藏上传统计
+            case PlayerEvent::ToggleStats: {
+                renderer->set_show_stats(!renderer->is_showing_stats());
+                // 暂停时也要立即看到变化
+                FFmpegDecoder::YUVData redraw{};
+                present(redraw);
                 break;
             }
             default:
@@ -182,6 +323,51 @@ namespace video {
         }
     }
 
+    void VideoPlayer::apply_decode_skip(DecodeSkip skip) {
+        if (skip == decoder->decode_skip()) return;
+        decoder->set_decode_skip(skip);
+        LOG_INFO("{}x 解码: {}", trick_play.speed(), decode_skip_name(skip));
+    }
+
+    bool VideoPlayer::keep_live_latency(double pts) {
+        // 显示队列中排在这一帧前面的帧也计入延迟
+        const AVRational rate = decoder->frame_rate();
+        const double frame_duration = rate.num > 0 ? av_q2d(av_inv_q(rate)) : 0.04;
+        const bool keep = live_latency.update(pts, renderer->queued_frames() * frame_duration);
+
+        const auto now = std::chrono::steady_clock::now();
+        if (live_latency.latency() >= 0.0 && now - live_reported >= std::chrono::seconds(2)) {
+            live_reported = now;
+            LOG_INFO("直播延迟 {:.0f}ms (目标 {:.0f}ms), 播放速度 {}x, 已丢弃 {} 帧",
+                     live_latency.latency() * 1000.0, live_latency.target() * 1000.0,
+                     live_latency.speed(), live_latency.dropped());
+        }
+        return keep;
+    }
+
+    void VideoPlayer::toggleRecording() {
+        // 按本地的请求状态切换：请求由渲染线程异步应用，is_recording() 在此之前不会更新
+        recordRequested = !recordRequested;
+        if (!recordRequested) {
+            renderer->stop_recording();
+            LOG_INFO("停止录制");
+            return;
+        }
+
+        // 第一次录制使用指定文件名，之后依次加序号：name_2.mp4、name_3.mp4 ...
+        // 序号按渲染线程确认成功开始的录制计数，未生效或失败的请求不占用序号
+        const int index = renderer->recordings_started() + 1;
+        recordOptions.path = recordBasePath;
+        if (index > 1) {
+            const size_t dot = recordBasePath.find_last_of('.');
+            const size_t slash = recordBasePath.find_last_of("/\\");
+            const bool has_ext = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+            recordOptions.path = (has_ext ? recordBasePath.substr(0, dot) : recordBasePath) +
+                                 "_" + std::to_string(index) + (has_ext ? recordBasePath.substr(dot) : "");
+        }
+        renderer->start_recording(recordOptions);
+    }
+
     void VideoPlayer::step_forward_frame() {
         if (!is_paused) return;
 
@@ -189,50 +375,29 @@ namespace video {
         // 解码一帧并显示
         if (decoder->get_next_frame(yuvData)) {
 
-            // 渲染帧
-            gl_renderer->render_frame(
-                    yuvData.frame->data[0], yuvData.frame->data[1], yuvData.frame->data[2],
-                    yuvData.frame->width, yuvData.frame->height,
-                    yuvData.frame->linesize[0], yuvData.frame->linesize[1]
-                    );
-
-            // 更新UI
-            gl_renderer->render_ui(decoder->get_current_pts() / duration,
-                                   decoder->get_current_pts(),
-                                   duration,
-                                   is_paused,
-                                   false);
+            // 提交显示
+            present(yuvData);
         }
     }
 
     void VideoPlayer::step_back_frame() {
-        // 计算上一帧的大致位置（当前时间减去一帧的持续时间）
-        double frame_duration = 1.0 / decoder->get_current_pts();
+        // 上一帧的位置：当前时间减去一帧的持续时间
+        const AVRational rate = decoder->frame_rate();
+        double frame_duration = rate.num > 0 ? av_q2d(av_inv_q(rate)) : 0.04;
         double target_time = decoder->get_current_pts() - frame_duration;
 
         if (target_time < 0) target_time = 0;
 
-        // 跳转到目标位置
-        decoder->seek(target_time);
+        // 跳转到目标位置（精确跳转时从关键帧预解码到上一帧）
+        seek_to(target_time);
 
         // 解码并显示该帧
         FFmpegDecoder::YUVData yuvData{};
         // 解码一帧并显示
         if (decoder->get_next_frame(yuvData)) {
 
-            // 渲染帧
-            gl_renderer->render_frame(
-                    yuvData.frame->data[0], yuvData.frame->data[1], yuvData.frame->data[2],
-                    yuvData.frame->width, yuvData.frame->height,
-                    yuvData.frame->linesize[0], yuvData.frame->linesize[1]
-            );
-
-            // 更新UI
-            gl_renderer->render_ui(decoder->get_current_pts() / duration,
-                                   decoder->get_current_pts(),
-                                   duration,
-                                   is_paused,
-                                   false);
+            // 提交显示
+            present(yuvData);
         }
     }
 
@@ -0,0 +1,218 @@
+//
+// Created by Weichuandong on 2025/4/1.
+//
+
+#include "video/VideoRenderer.h"
+
+#include <algorithm>
+
+namespace video {
+
+    VideoRenderer::VideoRenderer()
+        : present_queue(std::make_unique<BoundedQueue<PresentItem>>(PresentQueueDepth)) {
+        MemoryBudget::shared().add(this, "present");
+    }
+
+    VideoRenderer::~VideoRenderer() {
+        MemoryBudget::shared().remove(this);
+        // 派生类停止显示后队列中可能还有未显示的帧
+        present_queue->close();
+        PresentItem item;
+        while (present_queue->tryPop(item)) {
+            release(item);
+        }
+    }
+
+    void VideoRenderer::release(PresentItem& item) {
+        av_frame_free(&item.frame);
+        for (AVFrame*& tile : item.tiles) {
+            av_frame_free(&tile);
+        }
+        item.tiles.clear();
+    }
+
+    size_t VideoRenderer::memory_usage() const {
+        return present_queue->size() * queued_frame_bytes;
+    }
+
+    void VideoRenderer::on_memory_pressure(int level) {
+        // 至少保留一帧，解码与显示仍能重叠
+        const size_t depth[MemoryBudget::PressureLevels] = {queue_depth, std::min<size_t>(queue_depth, 2), 1};
+        present_queue->setCapacity(depth[level]);
+    }
+
+    void VideoRenderer::set_queue_depth(size_t depth) {
+        queue_depth = std::max<size_t>(1, depth);
+        present_queue->setCapacity(queue_depth);
+    }
+
+    bool VideoRenderer::submit_frame(AVFrame* frame, const OverlayState& state) {
+        if (frame) queued_frame_bytes = frame_memory(frame);
+        // 队列满时阻塞，显示节奏由此反压到解码
+        if (!present_queue->push(PresentItem{frame, state})) {
+            av_frame_free(&frame);
+            return false;
+        }
+        return true;
+    }
+
+    bool VideoRenderer::submit_tiles(std::vector<AVFrame*> frames, int columns, const OverlayState& state) {
+        PresentItem item;
+        item.state = state;
+        item.tiles = std::move(frames);
+        item.columns = std::max(1, columns);
+        size_t bytes = 0;
+        for (const AVFrame* frame : item.tiles) bytes += frame_memory(frame);
+        if (bytes > 0) queued_frame_bytes = bytes;
+        if (!present_queue->push(item)) {
+            release(item);
+            return false;
+        }
+        return true;
+    }
+
+    void VideoRenderer::present(PresentItem& item) {
+        // 拼接画面由调用方按各路内容时间选帧，立即显示
+        if (!item.tiles.empty()) {
+            draw_tiles(item.tiles, item.columns, item.state);
+            scheduler->on_swap(false);
+            shown_state = item.state;
+            release(item);
+            return;
+        }
+
+        // 只刷新 UI 或暂停时单帧步进，立即显示
+        if (!item.frame || item.state.is_paused) {
+            draw(item.frame, item.state, true);
+            scheduler->on_swap(false);
+            report_seek(item.state);
+            shown_state = item.state;
+            av_frame_free(&item.frame);
+            return;
+        }
+
+        // 按内容时间对齐到显示器刷新：未到时刻则继续显示上一帧
+        scheduler->begin_frame(item.state.current_time, item.state.speed);
+        // 快进时内容帧率可能高于刷新率，已迟到且后面还有帧时直接丢弃
+        if (item.state.speed > 1.0 && scheduler->is_late() && present_queue->size() > 0) {
+            scheduler->on_drop();
+            av_frame_free(&item.frame);
+            return;
+        }
+        scheduler->wait_until_due();
+        while (scheduler->should_hold()) {
+            draw(nullptr, shown_state, false);
+            scheduler->on_repeat_swap();
+        }
+
+        draw(item.frame, item.state, true);
+        scheduler->on_swap(true);
+        report_seek(item.state);
+        shown_state = item.state;
+        av_frame_free(&item.frame);
+    }
+
+    void VideoRenderer::report_seek(const OverlayState& state) {
+        if (state.seek_time == std::chrono::steady_clock::time_point{}) return;
+        const double latency_ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - state.seek_time).count();
+        scheduler->on_seek_shown(latency_ms);
+        LOG_INFO("跳转到显示: {:.1f}ms", latency_ms);
+    }
+
+    void VideoRenderer::log_pacing_stats() const {
+        const PacingStats& pacing = scheduler->stats();
+        LOG_INFO("显示节奏: {} 帧, 迟到 {}, 丢弃 {}, 重复刷新 {}, 抖动 {:.2f}ms, 刷新率 {:.2f}Hz",
+                 pacing.frames, pacing.late_frames, pacing.dropped_frames, pacing.repeated_refreshes,
+                 pacing.jitter_ms, pacing.refresh_hz);
+    }
+
+    void VideoRenderer::draw_tiles(const std::vector<AVFrame*>& frames, int columns, const OverlayState& state) {
+        (void)frames; (void)columns; (void)state;
+        static bool warned = false;
+        if (!warned) {
+            warned = true;
+            LOG_WARN("当前渲染后端不支持拼接显示");
+        }
+    }
+
+    void VideoRenderer::start_recording(const RecordOptions& options) {
+        LOG_WARN("当前渲染后端不支持录制: {}", options.path);
+    }
+
+    bool VideoRenderer::process_event(const SDL_Event& event) {
+        // 只负责把输入转换为命令，命令在播放线程的帧边界执行
+        switch (event.type) {
+            case SDL_QUIT:
+                command_bus.post({PlayerEvent::Quit});
+                return false;
+            case SDL_KEYDOWN: {
+                const PlayerCommand command = command_for_key(event.key.keysym.sym);
+                if (command.event != PlayerEvent::None) {
+                    command_bus.post(command);
+                }
+                break;
+            }
+            case SDL_MOUSEBUTTONDOWN:{
+                if (event.button.button == SDL_BUTTON_LEFT) {
+                    int x = event.button.x;
+                    int y = event.button.y;
+
+                    // 判断是否点击进度条区域
+                    int w = 0, h = 0;
+                    SDL_GetWindowSize(window, &w, &h);
+                    const float bar_y = progress_bar_top(h);
+
+                    if (y >= bar_y && y <= bar_y + ProgressBarHeight) {
+                        // 开始拖动：鼠标移出窗口后仍能收到移动与松开事件
+                        scrubbing = true;
+                        SDL_CaptureMouse(SDL_TRUE);
+                        post_seek(x / (float)w, true);
+                    }
+                }
+                break;
+            }
+            case SDL_MOUSEMOTION: {
+                if (scrubbing) {
+                    int w = 0, h = 0;
+                    SDL_GetWindowSize(window, &w, &h);
+                    post_seek(event.motion.x / (float)w, true);
+                }
+                break;
+            }
+            case SDL_MOUSEBUTTONUP: {
+                if (scrubbing && event.button.button == SDL_BUTTON_LEFT) {
+                    // 松开时在最终位置精确跳转
+                    scrubbing = false;
+                    SDL_CaptureMouse(SDL_FALSE);
+                    int w = 0, h = 0;
+                    SDL_GetWindowSize(window, &w, &h);
+                    post_seek(event.button.x / (float)w, false);
+                }
+                break;
+            }
+            case SDL_WINDOWEVENT: {
+                if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
+                    on_window_resized(event.window.data1, event.window.data2);
+                }
+                break;
+            }
+        }
+        return true;
+    }
+
+    void VideoRenderer::post_seek(float ratio, bool preview) {
+        PlayerCommand command{PlayerEvent::Seek};
+        command.value = std::clamp(ratio, 0.0f, 1.0f);
+        command.arg = preview ? 1 : 0;
+        command_bus.post(command);
+    }
+
+    void VideoRenderer::discard_queued() {
+        PresentItem item;
+        while (present_queue->tryPop(item)) {
+            release(item);
+        }
+    }
+
+} // namespace video
@@ -0,0 +1,20 @@
+//
+// Created by WeiChuandong on 2025/3/20.
+//
+#include "video/filters/BuiltinFilters.h"
+#include "video/filters/FlipFilter.h"
+#include "video/filters/MirrorFilter.h"
+#include "video/filters/GrayscaleFilter.h"
+
+namespace video {
+
+    void registerBuiltinFilters(FilterManager& manager) {
+        manager.registerFilter(std::make_shared<FlipFilter>(FlipFilter::VERTICAL));
+        manager.registerFilter(std::make_shared<FlipFilter>(FlipFilter::HORIZONTAL));
+        manager.registerFilter(std::make_shared<MirrorFilter>(MirrorFilter::HORIZONTAL));
+        manager.registerFilter(std::make_shared<MirrorFilter>(MirrorFilter::VERTICAL));
+        manager.registerFilter(std::make_shared<MirrorFilter>(MirrorFilter::QUAD));
+        manager.registerFilter(std::make_shared<GrayscaleFilter>(1.0f));
+    }
+
+}
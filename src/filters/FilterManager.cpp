@@ -3,23 +3,38 @@
 //
 #include "video/filters/FilterManager.h"
 
+#include <algorithm>
+#include <cmath>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+}
+
 namespace video {
 
 FilterManager::FilterManager()
-    : filterGraph(nullptr),
-      bufferSinkCtx(nullptr),
-      bufferSrcCtx(nullptr),
-      width(0),
+    : width(0),
       height(0),
       pixFormat(0){
-
+    MemoryBudget::shared().add(this, "filters");
 }
 
 FilterManager::~FilterManager() {
+    MemoryBudget::shared().remove(this);
+    {
+        std::lock_guard<std::mutex> lock(buildMutex);
+        stopBuild = true;
+    }
+    buildCond.notify_all();
+    if (buildThread.joinable()) {
+        buildThread.join();
+    }
     release();
 }
 
 bool FilterManager::init(int width_, int height_, int pixFormat_) {
+    // 构建线程在取请求时一并读取
+    std::lock_guard<std::mutex> lock(buildMutex);
     width = width_;
     height = height_;
     pixFormat = pixFormat_;
@@ -28,13 +43,12 @@ bool FilterManager::init(int width_, int height_, int pixFormat_) {
 }
 
 void FilterManager::release() {
-    if (filterGraph) {
-        avfilter_graph_free(&filterGraph);
-        filterGraph = nullptr;
-    }
+    currentGraph.reset();
+    graphBytes = 0;
 
-    bufferSrcCtx = nullptr;
-    bufferSinkCtx = nullptr;
+    std::lock_guard<std::mutex> lock(graphMutex);
+    pendingGraph.reset();
+    hasPendingGraph = false;
 }
 
     void FilterManager::registerFilter(std::shared_ptr<Filter> filter) {
@@ -51,177 +65,500 @@ bool FilterManager::activateFilter(const std::string &filterName) {
         return false;
     }
 
-    // 避免重复激活
-    if (isFilterExists(filterName)) return true;
-
-    activeFilters.push_back(filterName);
+    {
+        std::lock_guard<std::mutex> lock(buildMutex);
+        // 避免重复激活
+        if (std::find(requestedFilters.begin(), requestedFilters.end(), filterName) != requestedFilters.end()) {
+            return true;
+        }
+        requestedFilters.push_back(filterName);
+    }
     return rebuildFilterChain();
 }
 
 bool FilterManager::deactivateFilter(const std::string &filterName) {
-    // 查找并移除激活的滤镜
-    for (auto it = activeFilters.begin(); it != activeFilters.end(); ++it) {
-        if (*it == filterName) {
-            activeFilters.erase(it);
-            return rebuildFilterChain();
-        }
+    {
+        // 查找并移除激活的滤镜
+        std::lock_guard<std::mutex> lock(buildMutex);
+        auto it = std::find(requestedFilters.begin(), requestedFilters.end(), filterName);
+        if (it == requestedFilters.end()) return true;
+        requestedFilters.erase(it);
     }
-    return true;
+    return rebuildFilterChain();
 }
 
     void FilterManager::deactivateAllFilter() {
-        if (activeFilters.empty()) return;
-
-        activeFilters.clear();
+        {
+            std::lock_guard<std::mutex> lock(buildMutex);
+            if (requestedFilters.empty()) return;
+            requestedFilters.clear();
+        }
 
-        release();
+        // 同样走异步路径，保证与正在进行的构建请求顺序一致
+        rebuildFilterChain();
     }
 
 
 bool FilterManager::rebuildFilterChain() {
-    // 重建渲染链的核心逻辑
-    release();
+    {
+        std::lock_guard<std::mutex> lock(buildMutex);
+        if (stopBuild) return false;
+
+        // 构建滤镜链描述字符串
+        std::stringstream filterDesc;
+        {
+            // 滤镜参数可能正在被滤镜线程修改
+            std::lock_guard<std::mutex> graphLock(graphMutex);
+
+            // 如果有多个滤镜，需要将它们连接起来
+            for (size_t i = 0; i < requestedFilters.size(); ++i) {
+                auto it = filters.find(requestedFilters[i]);
+
+                if (it != filters.end()) {
+                    if (i > 0) filterDesc << ",";
+                    filterDesc << it->second->getFilterString();
+                }
+            }
+        }
 
-    if (activeFilters.empty()) return true;
+        // 提交给后台线程，新的请求会覆盖尚未开始的旧请求
+        requestedDesc = filterDesc.str();
+        requestedChain = requestedFilters;
+        ++requestedVersion;
 
-    filterGraph = avfilter_graph_alloc();
-    if (!filterGraph) {
-        LOG_ERROR("Failed to allocate filter graph");
-        return false;
+        // 构建线程在首次请求时才创建，拼接播放中不用滤镜的各路解码器不占用线程
+        if (!buildThread.joinable()) {
+            buildThread = std::thread(&FilterManager::buildLoop, this);
+        }
     }
+    buildCond.notify_one();
+    return true;
+}
 
-    // 构建缓冲源滤镜（接收解码后的原始帧）
-    const AVFilter* bufferSrc = avfilter_get_by_name("buffer");
-    if (!bufferSrc) {
-        LOG_ERROR("Cannot find buffer source filter");
-        return false;
-    }
+    void FilterManager::buildLoop() {
+        std::unique_lock<std::mutex> lock(buildMutex);
+        while (true) {
+            buildCond.wait(lock, [this] { return stopBuild || requestedVersion != builtVersion; });
+            if (stopBuild) break;
+
+            const uint64_t version = requestedVersion;
+            const std::string desc = requestedDesc;
+            const std::vector<std::string> chain = requestedChain;
+            const int graphWidth = width;
+            const int graphHeight = height;
+            const int graphPixFormat = pixFormat;
+            lock.unlock();
+
+            // 空描述直接切换为直通，无需构建
+            std::unique_ptr<FilterGraphInstance> instance;
+            bool success = true;
+            if (!desc.empty()) {
+                instance = buildGraph(desc, graphWidth, graphHeight, graphPixFormat);
+                success = instance != nullptr;
+            }
 
-    // 构建缓冲槽滤镜（提供处理后的帧）
-    const AVFilter* bufferSink = avfilter_get_by_name("buffersink");
-    if (!bufferSink) {
-        LOG_ERROR("Cannot find buffer sink filter");
-        return false;
-    }
+            lock.lock();
+            builtVersion = version;
+            lastBuildSucceeded = success;
+            buildDoneCond.notify_all();
 
-    // 为buffer源滤镜创建参数
-    AVRational timeBase = {1, 1000}; // 这里使用通用时基
-    char args[512];
-    snprintf(args, sizeof(args),
-             "video_size=%dx%d:pix_fmt=%d:time_base=%d/%d:pixel_aspect=%d/%d",
-             width, height, pixFormat,
-             timeBase.num, timeBase.den, 1, 1);
-
-    // 创建buffer源滤镜上下文
-    int ret = avfilter_graph_create_filter(&bufferSrcCtx, bufferSrc, "in",
-                                           args, nullptr, filterGraph);
-    if (ret < 0) {
-        LOG_ERROR("Cannot create buffer source");
-        return false;
+            // 构建期间已有更新的请求，丢弃本次结果
+            if (version != requestedVersion) continue;
+
+            if (!success) {
+                // 构建失败时保留旧滤镜链继续工作，请求回滚到实际运行的滤镜，之后的开关以此为准
+                LOG_ERROR("Filter chain build failed, keeping previous chain: {}", desc);
+                requestedFilters = activeFilters;
+                continue;
+            }
+
+            // 构建成功后才提交为当前滤镜链
+            activeFilters = chain;
+            chainActive = !desc.empty();
+
+            std::lock_guard<std::mutex> graphLock(graphMutex);
+            pendingGraph = std::move(instance);
+            hasPendingGraph = true;
+        }
     }
 
-    // 创建buffer槽滤镜上下文
-    ret = avfilter_graph_create_filter(&bufferSinkCtx, bufferSink, "out",
-                                       nullptr, nullptr, filterGraph);
-    if (ret < 0) {
-        LOG_ERROR("Cannot create buffer sink");
-        return false;
+    bool FilterManager::waitForBuilds() {
+        std::unique_lock<std::mutex> lock(buildMutex);
+        buildDoneCond.wait(lock, [this] { return stopBuild || builtVersion == requestedVersion; });
+        return lastBuildSucceeded;
     }
 
-    // 设置buffer槽滤镜的像素格式
-    ret = av_opt_set_bin(bufferSinkCtx, "pix_fmts",
-                         (uint8_t*)&pixFormat, sizeof(pixFormat),
-                         AV_OPT_SEARCH_CHILDREN);
-    if (ret < 0) {
-        LOG_ERROR("Cannot set output pixel format");
-        return false;
+    FilterManager::BuildStatus FilterManager::buildStatus() {
+        std::lock_guard<std::mutex> lock(buildMutex);
+        if (builtVersion != requestedVersion) return BuildStatus::Pending;
+        return lastBuildSucceeded ? BuildStatus::Ready : BuildStatus::Failed;
     }
 
-    // 构建滤镜链描述字符串
-    std::stringstream filterDesc;
+    std::unique_ptr<FilterGraphInstance> FilterManager::buildGraph(const std::string& filtersDescStr,
+                                                                   int graphWidth, int graphHeight,
+                                                                   int graphPixFormat) {
+        auto instance = std::make_unique<FilterGraphInstance>();
+        instance->width = graphWidth;
+        instance->height = graphHeight;
+        instance->pixFormat = graphPixFormat;
+
+        instance->graph = avfilter_graph_alloc();
+        if (!instance->graph) {
+            LOG_ERROR("Failed to allocate filter graph");
+            return nullptr;
+        }
 
-    // 如果有多个滤镜，需要将它们连接起来
-    for (size_t i = 0; i < activeFilters.size(); ++i) {
-        const auto& filterName = activeFilters[i];
-        auto it = filters.find(filterName);
+        // 启用切片多线程，必须在创建任何滤镜之前设置
+        instance->graph->nb_threads = threadCount;
+        instance->graph->thread_type = AVFILTER_THREAD_SLICE;
 
-        if (it != filters.end()) {
-            if (i > 0) filterDesc << ",";
-            filterDesc << it->second->getFilterString();
+        // 构建缓冲源滤镜（接收解码后的原始帧）
+        const AVFilter* bufferSrc = avfilter_get_by_name("buffer");
+        if (!bufferSrc) {
+            LOG_ERROR("Cannot find buffer source filter");
+            return nullptr;
         }
-    }
 
-    std::string filtersDescStr = filterDesc.str();
-    LOG_INFO("Building filter chain: {}", filtersDescStr.c_str());
+        // 构建缓冲槽滤镜（提供处理后的帧）
+        const AVFilter* bufferSink = avfilter_get_by_name("buffersink");
+        if (!bufferSink) {
+            LOG_ERROR("Cannot find buffer sink filter");
+            return nullptr;
+        }
+
+        // 为buffer源滤镜创建参数
+        AVRational timeBase = {1, 1000}; // 这里使用通用时基
+        char args[512];
+        snprintf(args, sizeof(args),
+                 "video_size=%dx%d:pix_fmt=%d:time_base=%d/%d:pixel_aspect=%d/%d",
+                 graphWidth, graphHeight, graphPixFormat,
+                 timeBase.num, timeBase.den, 1, 1);
+
+        // 创建buffer源滤镜上下文
+        int ret = avfilter_graph_create_filter(&instance->bufferSrcCtx, bufferSrc, "in",
+                                               args, nullptr, instance->graph);
+        if (ret < 0) {
+            LOG_ERROR("Cannot create buffer source");
+            return nullptr;
+        }
+
+        // 创建buffer槽滤镜上下文
+        ret = avfilter_graph_create_filter(&instance->bufferSinkCtx, bufferSink, "out",
+                                           nullptr, nullptr, instance->graph);
+        if (ret < 0) {
+            LOG_ERROR("Cannot create buffer sink");
+            return nullptr;
+        }
+
+        // 设置buffer槽滤镜的像素格式
+        ret = av_opt_set_bin(instance->bufferSinkCtx, "pix_fmts",
+                             (uint8_t*)&graphPixFormat, sizeof(graphPixFormat),
+                             AV_OPT_SEARCH_CHILDREN);
+        if (ret < 0) {
+            LOG_ERROR("Cannot set output pixel format");
+            return nullptr;
+        }
+
+        LOG_INFO("Building filter chain: {}", filtersDescStr.c_str());
+
+        // 创建滤镜描述的输出和输入端
+        AVFilterInOut* outputs = avfilter_inout_alloc();
+        AVFilterInOut* inputs = avfilter_inout_alloc();
+
+        if (!outputs || !inputs) {
+            avfilter_inout_free(&outputs);
+            avfilter_inout_free(&inputs);
+            LOG_ERROR("Failed to allocate filter endpoints");
+            return nullptr;
+        }
+
+        // 配置滤镜图输入
+        outputs->name = av_strdup("in");
+        outputs->filter_ctx = instance->bufferSrcCtx;
+        outputs->pad_idx = 0;
+        outputs->next = nullptr;
+
+        // 配置滤镜图输出
+        inputs->name = av_strdup("out");
+        inputs->filter_ctx = instance->bufferSinkCtx;
+        inputs->pad_idx = 0;
+        inputs->next = nullptr;
 
-    // 创建滤镜描述的输出和输入端
-    AVFilterInOut* outputs = avfilter_inout_alloc();
-    AVFilterInOut* inputs = avfilter_inout_alloc();
+        // 解析滤镜链描述并创建滤镜链
+        ret = avfilter_graph_parse_ptr(instance->graph, filtersDescStr.c_str(),
+                                       &inputs, &outputs, nullptr);
 
-    if (!outputs || !inputs) {
         avfilter_inout_free(&outputs);
         avfilter_inout_free(&inputs);
-        LOG_ERROR("Failed to allocate filter endpoints");
-        return false;
+
+        if (ret < 0) {
+            LOG_ERROR("Failed to parse filter description");
+            char errBuff[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errBuff, sizeof(errBuff));
+            LOG_ERROR("Error: {}", errBuff);
+            return nullptr;
+        }
+
+        // 配置滤镜图
+        ret = avfilter_graph_config(instance->graph, nullptr);
+        if (ret < 0) {
+            LOG_ERROR("Failed to configure filter graph");
+            return nullptr;
+        }
+
+        // 预热：在切换前先让一帧完整走过滤镜图
+        if (!primeGraph(*instance)) {
+            LOG_ERROR("Failed to prime filter graph");
+            return nullptr;
+        }
+
+        LOG_INFO("Filter chain rebuilt successfully");
+        return instance;
     }
 
-    // 配置滤镜图输入
-    outputs->name = av_strdup("in");
-    outputs->filter_ctx = bufferSrcCtx;
-    outputs->pad_idx = 0;
-    outputs->next = nullptr;
-
-    // 配置滤镜图输出
-    inputs->name = av_strdup("out");
-    inputs->filter_ctx = bufferSinkCtx;
-    inputs->pad_idx = 0;
-    inputs->next = nullptr;
-
-    // 解析滤镜字符串并将滤镜添加到图中
-    if (filtersDescStr.empty()) {
-        // 如果没有滤镜描述，创建一个简单的直通路径
-        ret = avfilter_link(bufferSrcCtx, 0, bufferSinkCtx, 0);
-    } else {
-        // 解析滤镜链描述并创建滤镜链
-        ret = avfilter_graph_parse_ptr(filterGraph, filtersDescStr.c_str(),
-                                       &inputs, &outputs, nullptr);
+    bool FilterManager::primeGraph(FilterGraphInstance& instance) {
+        AVFrame* frame = av_frame_alloc();
+        if (!frame) return false;
+
+        frame->width = instance.width;
+        frame->height = instance.height;
+        frame->format = instance.pixFormat;
+        frame->pts = 0;
+
+        int ret = av_frame_get_buffer(frame, 0);
+        if (ret >= 0) {
+            // 使用黑帧，避免未初始化的内存进入滤镜
+            ptrdiff_t linesizes[4];
+            for (int i = 0; i < 4; i++) linesizes[i] = frame->linesize[i];
+            av_image_fill_black(frame->data, linesizes, static_cast<AVPixelFormat>(instance.pixFormat),
+                                frame->color_range, instance.width, instance.height);
+            ret = av_buffersrc_add_frame_flags(instance.bufferSrcCtx, frame, 0);
+        }
+        av_frame_free(&frame);
+        if (ret < 0) return false;
+
+        // 取出并丢弃预热输出，新图切换后不残留任何帧
+        AVFrame* out = av_frame_alloc();
+        if (!out) return false;
+        while ((ret = av_buffersink_get_frame(instance.bufferSinkCtx, out)) >= 0) {
+            av_frame_unref(out);
+        }
+        av_frame_free(&out);
+
+        return ret == AVERROR(EAGAIN);
     }
 
-    avfilter_inout_free(&outputs);
-    avfilter_inout_free(&inputs);
+    void FilterManager::swapPendingGraph() {
+        if (!hasPendingGraph) return;
 
-    if (ret < 0) {
-        LOG_ERROR("Failed to parse filter description");
-        char errBuff[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errBuff, sizeof(errBuff));
-        LOG_ERROR("Error: %s", errBuff);
-        return false;
+        std::unique_ptr<FilterGraphInstance> oldGraph;
+        {
+            std::lock_guard<std::mutex> lock(graphMutex);
+            oldGraph = std::move(currentGraph);
+            currentGraph = std::move(pendingGraph);
+            hasPendingGraph = false;
+        }
+        // 旧图在锁外释放
+
+        // 除 buffer/buffersink 外每个滤镜大约持有一帧输出
+        size_t bytes = 0;
+        if (currentGraph && currentGraph->graph) {
+            const int frame_size = av_image_get_buffer_size(static_cast<AVPixelFormat>(currentGraph->pixFormat),
+                                                            currentGraph->width, currentGraph->height, 1);
+            bytes = static_cast<size_t>(std::max(0, frame_size)) *
+                    std::max(1, static_cast<int>(currentGraph->graph->nb_filters) - 2);
+        }
+        graphBytes = bytes;
+
+        // 新图按请求时的参数构建，期间的参数变化需要补发
+        resendParams = true;
     }
 
-    // 配置滤镜图
-    ret = avfilter_graph_config(filterGraph, nullptr);
-    if (ret < 0) {
-        LOG_ERROR("Failed to configure filter graph");
-        return false;
+    void FilterManager::updateParams() {
+        if (!hasParamTargets && !resendParams) return;
+
+        std::lock_guard<std::mutex> lock(graphMutex);
+        if (resendParams) {
+            resendParams = false;
+            if (currentGraph) {
+                for (const auto& entry : filters) {
+                    sendCommands(*currentGraph, entry.second->getParamCommands());
+                }
+            }
+        }
+
+        for (auto it = paramTargets.begin(); it != paramTargets.end();) {
+            auto filterIt = filters.find(it->first.first);
+            if (filterIt == filters.end()) {
+                it = paramTargets.erase(it);
+                continue;
+            }
+
+            float current = it->second.value;
+            float step = 0.0f;
+            for (const auto& param : filterIt->second->getParams()) {
+                if (param.name == it->first.second) {
+                    current = param.value;
+                    step = param.step;
+                    break;
+                }
+            }
+
+            // 每帧向目标值逼近一部分，足够接近时直接到位
+            float next = it->second.value;
+            if (it->second.animate && std::abs(next - current) > step * 0.05f) {
+                next = current + (next - current) * 0.35f;
+            }
+
+            filterIt->second->setParam(it->first.second, next);
+            if (currentGraph) {
+                sendCommands(*currentGraph, filterIt->second->getParamCommands());
+            }
+
+            if (next == it->second.value) {
+                it = paramTargets.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        hasParamTargets = !paramTargets.empty();
     }
 
-    LOG_INFO("Filter chain rebuilt successfully");
-    return true;
-}
+    void FilterManager::sendCommands(FilterGraphInstance& instance, const std::vector<FilterCommand>& commands) {
+        for (const auto& cmd : commands) {
+            // 按实例标签匹配 "Parsed_xxx_N@tag" 形式的滤镜名
+            const std::string suffix = "@" + cmd.target;
+            for (unsigned i = 0; i < instance.graph->nb_filters; i++) {
+                AVFilterContext* ctx = instance.graph->filters[i];
+                if (!ctx->name) continue;
+
+                std::string name = ctx->name;
+                if (name.size() < suffix.size() ||
+                    name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+                    continue;
+                }
+
+                char res[256] = {0};
+                int ret = avfilter_process_command(ctx, cmd.command.c_str(), cmd.arg.c_str(),
+                                                   res, sizeof(res), 0);
+                if (ret < 0) {
+                    char errBuff[AV_ERROR_MAX_STRING_SIZE];
+                    av_strerror(ret, errBuff, sizeof(errBuff));
+                    LOG_WARN("Filter command {} {}={} failed: {}", name, cmd.command, cmd.arg, errBuff);
+                }
+            }
+        }
+    }
+
+    bool FilterManager::setFilterParam(const std::string& filterName, const std::string& paramName,
+                                       float value, bool animate) {
+        auto it = filters.find(filterName);
+        if (it == filters.end()) {
+            LOG_ERROR("Filter not found : {}", filterName);
+            return false;
+        }
+
+        bool supportsCommands;
+        {
+            std::lock_guard<std::mutex> lock(graphMutex);
+            bool found = false;
+            for (const auto& param : it->second->getParams()) {
+                if (param.name == paramName) {
+                    value = std::max(param.minValue, std::min(param.maxValue, value));
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                LOG_ERROR("Filter {} has no param {}", filterName, paramName);
+                return false;
+            }
+
+            supportsCommands = !it->second->getParamCommands().empty();
+            if (supportsCommands) {
+                // 由滤镜线程在下一帧前生效
+                paramTargets[{filterName, paramName}] = {value, animate};
+                hasParamTargets = true;
+                return true;
+            }
+
+            it->second->setParam(paramName, value);
+        }
+
+        // 不支持运行时命令的滤镜只能重建滤镜图
+        if (isFilterRequested(filterName)) {
+            return rebuildFilterChain();
+        }
+        return true;
+    }
+
+    bool FilterManager::adjustFilterParam(const std::string& filterName, const std::string& paramName, int steps) {
+        auto it = filters.find(filterName);
+        if (it == filters.end()) {
+            LOG_ERROR("Filter not found : {}", filterName);
+            return false;
+        }
+
+        float target = 0.0f;
+        {
+            std::lock_guard<std::mutex> lock(graphMutex);
+
+            // 在上一次尚未完成的目标值上累加，保证连续按键不丢步
+            auto targetIt = paramTargets.find({filterName, paramName});
+            bool found = false;
+            for (const auto& param : it->second->getParams()) {
+                if (param.name == paramName) {
+                    float base = targetIt != paramTargets.end() ? targetIt->second.value : param.value;
+                    target = base + param.step * steps;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                LOG_ERROR("Filter {} has no param {}", filterName, paramName);
+                return false;
+            }
+        }
+
+        return setFilterParam(filterName, paramName, target, true);
+    }
+
+    bool FilterManager::getFilterParam(const std::string& filterName, const std::string& paramName, float& value) {
+        auto it = filters.find(filterName);
+        if (it == filters.end()) return false;
+
+        std::lock_guard<std::mutex> lock(graphMutex);
+        auto targetIt = paramTargets.find({filterName, paramName});
+        if (targetIt != paramTargets.end()) {
+            value = targetIt->second.value;
+            return true;
+        }
+        for (const auto& param : it->second->getParams()) {
+            if (param.name == paramName) {
+                value = param.value;
+                return true;
+            }
+        }
+        return false;
+    }
 
     AVFrame* FilterManager::applyFilters(AVFrame* frame) {
+        // 两帧之间切换到已构建完成的新滤镜图
+        swapPendingGraph();
+        updateParams();
+
         // 如果没有滤镜图或没有输入帧，则直接返回原帧
-        if (!filterGraph || !frame) {
+        if (!currentGraph || !frame) {
             return frame;
         }
 
         // 将帧发送到源缓冲区
-        int ret = av_buffersrc_add_frame_flags(bufferSrcCtx, frame,
+        int ret = av_buffersrc_add_frame_flags(currentGraph->bufferSrcCtx, frame,
                                                AV_BUFFERSRC_FLAG_KEEP_REF);
         if (ret < 0) {
             char errBuff[AV_ERROR_MAX_STRING_SIZE];
             av_strerror(ret, errBuff, sizeof(errBuff));
-            LOG_ERROR("Error feeding the filter: %s", errBuff);
+            LOG_ERROR("Error feeding the filter: {}", errBuff);
             return frame; // 返回原始帧
         }
 
@@ -233,14 +570,14 @@ bool FilterManager::rebuildFilterChain() {
         }
 
         // 从滤镜链获取处理后的帧
-        ret = av_buffersink_get_frame(bufferSinkCtx, filteredFrame);
+        ret = av_buffersink_get_frame(currentGraph->bufferSinkCtx, filteredFrame);
         if (ret < 0) {
             // 如果没有可用的帧，释放分配的帧并返回原始帧
             av_frame_free(&filteredFrame);
             if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
                 char errBuff[AV_ERROR_MAX_STRING_SIZE];
                 av_strerror(ret, errBuff, sizeof(errBuff));
-                LOG_ERROR("Error getting filtered frame: %s", errBuff);
+                LOG_ERROR("Error getting filtered frame: {}", errBuff);
             }
             return frame;
         }
@@ -253,13 +590,30 @@ bool FilterManager::rebuildFilterChain() {
         return filteredFrame;
     }
 
-    bool FilterManager::isFilterExists(const std::string& filterName) {
-        if (activeFilters.empty()) return false;
+    void FilterManager::setThreadCount(int threads) {
+        threads = std::max(0, threads);
+        if (threadCount == threads) return;
 
-        for (auto it : activeFilters) {
-            if (it == filterName) return true;
+        threadCount = threads;
+        LOG_INFO("Filter graph threads: {}", threads == 0 ? std::string("auto") : std::to_string(threads));
+        bool hasFilters;
+        {
+            std::lock_guard<std::mutex> lock(buildMutex);
+            hasFilters = !requestedFilters.empty();
         }
-        return false;
+        if (hasFilters) {
+            rebuildFilterChain();
+        }
+    }
+
+    bool FilterManager::isFilterExists(const std::string& filterName) {
+        std::lock_guard<std::mutex> lock(buildMutex);
+        return std::find(activeFilters.begin(), activeFilters.end(), filterName) != activeFilters.end();
+    }
+
+    bool FilterManager::isFilterRequested(const std::string& filterName) {
+        std::lock_guard<std::mutex> lock(buildMutex);
+        return std::find(requestedFilters.begin(), requestedFilters.end(), filterName) != requestedFilters.end();
     }
 
 
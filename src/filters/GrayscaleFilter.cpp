@@ -6,52 +6,42 @@
 
 namespace video {
 
-    GrayscaleFilter::GrayscaleFilter(float intensity) : intensity(intensity) {
-        intensity = std::max(0.0f, std::min(1.0f, intensity));
+    GrayscaleFilter::GrayscaleFilter(float intensity) {
+        setIntensity(intensity);
     }
 
-    std::string GrayscaleFilter::getFilterString() const {
-        if (intensity >= 0.999f) {
-            return "format=gray";
-        } else {
-            float color = 1.0f - intensity;
-
-            // 使用stringstream以确保浮点数格式正确
-            std::stringstream ss;
-            ss << std::fixed << std::setprecision(3);
-
-            // colorchannelmixer滤镜允许混合RGB通道
-            // 灰度公式: 0.299*R + 0.587*G + 0.114*B
-            // 我们将根据intensity调整混合比例
-            ss << "colorchannelmixer=";
-
-            // 红色通道混合
-            ss << "rr=" << (0.299f * intensity + color) << ":";
-            ss << "rg=" << (0.587f * intensity) << ":";
-            ss << "rb=" << (0.114f * intensity) << ":";
-
-            // 绿色通道混合
-            ss << "gr=" << (0.299f * intensity) << ":";
-            ss << "gg=" << (0.587f * intensity + color) << ":";
-            ss << "gb=" << (0.114f * intensity) << ":";
-
-            // 蓝色通道混合
-            ss << "br=" << (0.299f * intensity) << ":";
-            ss << "bg=" << (0.587f * intensity) << ":";
-            ss << "bb=" << (0.114f * intensity + color);
+    std::string GrayscaleFilter::saturation() const {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(3) << (1.0f - intensity);
+        return ss.str();
+    }
 
-            return ss.str();
-        }
+    std::string GrayscaleFilter::getFilterString() const {
+        // hue 直接在 YUV 上调整饱和度（s=0 即灰度），不经过 RGB 转换，且支持运行时命令调整强度
+        // @后的标签用于定位运行时命令
+        return "hue@" + getName() + "=s=" + saturation();
     }
 
     void GrayscaleFilter::setIntensity(float intensity_) {
-        intensity = intensity_;
+        intensity = std::max(0.0f, std::min(1.0f, intensity_));
     }
 
     std::string GrayscaleFilter::getName() const {
-        LOG_DEBUG("name = {}", "gray" + std::to_string(intensity));
+        return "gray";
+    }
+
+    std::vector<FilterParam> GrayscaleFilter::getParams() const {
+        return {{"intensity", intensity, 0.0f, 1.0f, 0.05f}};
+    }
+
+    bool GrayscaleFilter::setParam(const std::string& name, float value) {
+        if (name != "intensity") return false;
+        setIntensity(value);
+        return true;
+    }
 
-        return "gray" + std::to_string(intensity);
+    std::vector<FilterCommand> GrayscaleFilter::getParamCommands() const {
+        return {{getName(), "s", saturation()}};
     }
 
 }
@@ -1,19 +1,221 @@
 #include <iostream>
-#include "video/videoPlayer.h"
+#include <cstring>
+#include <cstdio>
+#include <cctype>
+#include <algorithm>
+#include <sstream>
+#include "video/VideoPlayer.h"
+#include "video/MosaicPlayer.h"
+#include "video/MemoryBudget.h"
+#include "video/Transcoder.h"
+#ifdef VIDEOPLAYER_HEADLESS
+#include "video/HeadlessRunner.h"
+#endif
 #include "logger.h"
 
+static void print_usage(const char* prog) {
+    std::cerr << "用法: " << prog << " [选项] <视频文件>" << std::endl
+              << "       " << prog << " --mosaic [选项] <视频文件1> <视频文件2> ..." << std::endl
+              << "  --filter-threads <N>      滤镜切片线程数（0 为自动）" << std::endl
+              << "  --filter-pipeline [深度]  滤镜在独立线程执行" << std::endl
+              << "  --no-zero-copy            解码不写入 GL 暂存缓冲" << std::endl
+              << "  --renderer <gl|sdl>       渲染后端，sdl 为 SDL_Renderer + YUV 流式纹理（适合无 GPU），默认 gl" << std::endl
+              << "  --vsync <on|adaptive|off> 交换间隔，默认 on" << std::endl
+              << "  --scaler <名称>           缩放方式 auto|bilinear|bicubic|lanczos|mipmap，默认 auto" << std::endl
+              << "  --no-prescale             窗口远小于视频时不在 CPU 上预先缩小" << std::endl
+              << "  --fast-seek               跳转到目标之前的关键帧，不预解码到目标帧" << std::endl
+              << "  --speed <倍数>            播放速度 0.25 ~ 16，播放中按 -/= 调整，默认 1" << std::endl
+              << "  --record <输出文件>       录制屏幕画面（含滤镜与 UI），播放中按 R 开始/停止" << std::endl
+              << "  --live [目标延迟ms]       直播低延迟模式：不缓冲、少探测、显示队列 1 帧，延迟超出目标时加速或丢帧，默认 300ms" << std::endl
+              << "                            udp/rtp/rtsp/rtmp/srt 地址自动启用" << std::endl
+              << "  --cache-dir <目录>        http(s) 输入的磁盘缓存目录，默认系统临时目录下的 glitchplayer-cache" << std::endl
+              << "  --cache-limit <MB>        磁盘缓存上限，超出时删除最久未使用的缓存，0 表示不限，默认 2048" << std::endl
+              << "  --no-net-cache            http(s) 输入不做分块预读与磁盘缓存，直接交给 FFmpeg 打开" << std::endl
+              << "  --memory-budget <MB>      进程内存预算，超出时缩小队列与缓存（统计见 I 键），默认不限" << std::endl
+              << "  --mosaic                  多路视频拼接在同一窗口播放（共享解码线程池，按分块尺寸解码）" << std::endl
+              << "离线转码（无窗口）:" << std::endl
+              << "  --transcode <输出文件>    解码 -> 滤镜 -> 编码到文件" << std::endl
+              << "  --filters <a,b,...>       滤镜链（转码与离屏渲染），名称同播放时的滤镜（vflip,hflip,hmirror,vmirror,quadmirror,gray）" << std::endl
+              << "  --codec <名称>            编码器（转码与录制），默认 libx264" << std::endl
+              << "  --bitrate <bps>           目标码率（转码与录制）" << std::endl
+              << "  --gop-split <帧数>        按 GOP 切分并行编码" << std::endl
+              << "  --encode-workers <N>      并行编码线程数" << std::endl
+#ifdef VIDEOPLAYER_HEADLESS
+              << "离屏渲染（无显示器，EGL）:" << std::endl
+              << "  --headless [帧数]         离屏渲染完整绘制路径并输出性能统计" << std::endl
+              << "  --size <宽x高>            离屏渲染尺寸，默认视频尺寸" << std::endl
+              << "  --dump-frames <目录>      读回帧并写为 PPM" << std::endl
+              << "  --golden <目录>           与目录中的 PPM 基准图逐字节比较" << std::endl
+              << "  --golden-tolerance <N>    基准图比较时每个通道允许的误差，默认 0" << std::endl
+              << "  --dump-every <N>          每 N 帧读回一次" << std::endl
+              << "  --sync-readback           关闭 PBO 异步读回" << std::endl
+              << "  --no-ui                   不绘制进度条和时间" << std::endl
+#endif
+              ;
+}
+
+static std::vector<std::string> split_list(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
 int main(int argc, char** argv) {
-    if (argc < 2) {
-        std::cerr << "用法: " << argv[0] << " <视频文件>" << std::endl;
+    video::PlayerOptions options;
+    video::TranscodeOptions transcode;
+#ifdef VIDEOPLAYER_HEADLESS
+    video::HeadlessOptions headless;
+    bool run_headless = false;
+#endif
+    std::string filepath;
+    std::vector<std::string> files;
+    bool mosaic = false;
+    size_t memory_budget_mb = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter-threads") == 0 && i + 1 < argc) {
+            options.filterThreads = std::atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--filter-pipeline") == 0) {
+            options.filterPipeline = true;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                options.filterPipelineDepth = std::max(1, std::atoi(argv[++i]));
+            }
+        } else if (strcmp(argv[i], "--no-zero-copy") == 0) {
+            options.zeroCopyDecode = false;
+        } else if (strcmp(argv[i], "--renderer") == 0 && i + 1 < argc) {
+            const char* backend = argv[++i];
+            if (strcmp(backend, "sdl") == 0) options.renderer = video::RendererBackend::SDL;
+            else if (strcmp(backend, "gl") == 0) options.renderer = video::RendererBackend::GL;
+            else {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--vsync") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "adaptive") == 0) options.swapMode = video::SwapMode::Adaptive;
+            else if (strcmp(mode, "off") == 0) options.swapMode = video::SwapMode::Off;
+            else options.swapMode = video::SwapMode::VSync;
+        } else if (strcmp(argv[i], "--scaler") == 0 && i + 1 < argc) {
+            if (!video::parse_scale_filter(argv[++i], options.scaleFilter)) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--no-prescale") == 0) {
+            options.prescale = false;
+        } else if (strcmp(argv[i], "--fast-seek") == 0) {
+            options.accurateSeek = false;
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            options.speed = std::atof(argv[++i]);
+            if (options.speed <= 0.0) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            options.recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--live") == 0) {
+            options.live = true;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                options.liveLatency = std::atoi(argv[++i]) / 1000.0;
+            }
+        } else if (strcmp(argv[i], "--cache-dir") == 0 && i + 1 < argc) {
+            options.cacheDir = argv[++i];
+        } else if (strcmp(argv[i], "--cache-limit") == 0 && i + 1 < argc) {
+            options.cacheLimit = static_cast<int64_t>(std::max(0, std::atoi(argv[++i]))) << 20;
+        } else if (strcmp(argv[i], "--no-net-cache") == 0) {
+            options.networkCache = false;
+        } else if (strcmp(argv[i], "--memory-budget") == 0 && i + 1 < argc) {
+            memory_budget_mb = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+        } else if (strcmp(argv[i], "--mosaic") == 0) {
+            mosaic = true;
+        } else if (strcmp(argv[i], "--transcode") == 0 && i + 1 < argc) {
+            transcode.output = argv[++i];
+        } else if (strcmp(argv[i], "--filters") == 0 && i + 1 < argc) {
+            transcode.filters = split_list(argv[++i]);
+        } else if (strcmp(argv[i], "--codec") == 0 && i + 1 < argc) {
+            transcode.codec = argv[++i];
+        } else if (strcmp(argv[i], "--bitrate") == 0 && i + 1 < argc) {
+            transcode.bitRate = std::atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--gop-split") == 0 && i + 1 < argc) {
+            transcode.segmentFrames = std::atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--encode-workers") == 0 && i + 1 < argc) {
+            transcode.encodeWorkers = std::atoi(argv[++i]);
+#ifdef VIDEOPLAYER_HEADLESS
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            run_headless = true;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                headless.maxFrames = std::atoi(argv[++i]);
+            }
+        } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &headless.width, &headless.height) != 2) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--dump-frames") == 0 && i + 1 < argc) {
+            headless.dumpDir = argv[++i];
+        } else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+            headless.goldenDir = argv[++i];
+        } else if (strcmp(argv[i], "--golden-tolerance") == 0 && i + 1 < argc) {
+            headless.goldenTolerance = std::max(0, std::atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--dump-every") == 0 && i + 1 < argc) {
+            headless.dumpEvery = std::atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sync-readback") == 0) {
+            headless.asyncReadback = false;
+        } else if (strcmp(argv[i], "--no-ui") == 0) {
+            headless.drawUi = false;
+#endif
+        } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            filepath = argv[i];
+            files.push_back(filepath);
+        }
+    }
+
+    if (filepath.empty()) {
+        print_usage(argv[0]);
         return 1;
     }
     Logger::init(true);
+    video::MemoryBudget::shared().set_limit(memory_budget_mb << 20);
 
     LOG_INFO("启动播放器");
     LOG_INFO("当前工作目录: {}", std::filesystem::current_path().string());
 
     try {
-        video::VideoPlayer player(argv[1]);
+        if (!transcode.output.empty()) {
+            transcode.input = filepath;
+            transcode.filterThreads = options.filterThreads;
+            video::Transcoder transcoder(transcode);
+            return transcoder.run() ? 0 : 1;
+        }
+#ifdef VIDEOPLAYER_HEADLESS
+        if (run_headless) {
+            headless.input = filepath;
+            headless.filters = transcode.filters;
+            headless.filterThreads = options.filterThreads;
+            headless.zeroCopyDecode = options.zeroCopyDecode;
+            headless.scaleFilter = options.scaleFilter;
+            headless.prescale = options.prescale;
+            video::HeadlessRunner runner(headless);
+            return runner.run() ? 0 : 1;
+        }
+#endif
+
+        if (mosaic) {
+            video::MosaicPlayer player(files, options);
+            player.run();
+            LOG_INFO("播放器正常退出");
+            return 0;
+        }
+
+        options.recordCodec = transcode.codec;
+        options.recordBitRate = transcode.bitRate;
+        video::VideoPlayer player(filepath, options);
         player.run();
 
         LOG_INFO("播放器正常退出");
@@ -23,4 +225,4 @@ int main(int argc, char** argv) {
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,151 @@
+//
+// Created by Weichuandong on 2025/4/5.
+//
+
+#include "video/BoundedQueue.h"
+#include "TestCheck.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using video::BoundedQueue;
+
+namespace {
+
+    void test_fifo_order() {
+        BoundedQueue<int> queue(4);
+        for (int i = 0; i < 4; i++) CHECK(queue.push(i));
+        CHECK(queue.size() == 4);
+        int value = -1;
+        for (int i = 0; i < 4; i++) {
+            CHECK(queue.pop(value));
+            CHECK(value == i);
+        }
+        CHECK(!queue.tryPop(value));
+    }
+
+    void test_try_push_keeps_item_when_full() {
+        BoundedQueue<std::unique_ptr<int>> queue(1);
+        auto first = std::make_unique<int>(1);
+        auto second = std::make_unique<int>(2);
+        CHECK(queue.tryPush(first));
+        CHECK(!first);
+        CHECK(!queue.tryPush(second));
+        CHECK(second && *second == 2);
+    }
+
+    void test_pop_for_times_out() {
+        BoundedQueue<int> queue(2);
+        int value = 0;
+        const auto start = std::chrono::steady_clock::now();
+        CHECK(!queue.popFor(value, std::chrono::milliseconds(20)));
+        CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(15));
+    }
+
+    void test_close_drains_then_fails() {
+        BoundedQueue<int> queue(4);
+        CHECK(queue.push(1));
+        CHECK(queue.push(2));
+        queue.close();
+        CHECK(!queue.push(3));
+        int item = 3;
+        CHECK(!queue.tryPush(item));
+
+        // 关闭后仍能取完已有元素
+        int value = 0;
+        CHECK(queue.pop(value) && value == 1);
+        CHECK(queue.popFor(value, std::chrono::milliseconds(1)) && value == 2);
+        CHECK(!queue.pop(value));
+        CHECK(!queue.popFor(value, std::chrono::milliseconds(1)));
+    }
+
+    void test_close_wakes_blocked_threads() {
+        BoundedQueue<int> empty(1);
+        BoundedQueue<int> full(1);
+        CHECK(full.push(0));
+
+        std::atomic<int> woken{0};
+        std::thread consumer([&] {
+            int value = 0;
+            if (!empty.pop(value)) woken++;
+        });
+        std::thread producer([&] {
+            if (!full.push(1)) woken++;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        empty.close();
+        full.close();
+        consumer.join();
+        producer.join();
+        CHECK(woken == 2);
+    }
+
+    void test_set_capacity() {
+        BoundedQueue<int> queue(4);
+        for (int i = 0; i < 4; i++) CHECK(queue.push(i));
+
+        // 变小时已有元素保留，取到低于新容量之前不接受新元素
+        queue.setCapacity(2);
+        CHECK(queue.size() == 4);
+        int value = 0;
+        int item = 4;
+        CHECK(queue.tryPop(value));
+        CHECK(queue.tryPop(value));
+        CHECK(!queue.tryPush(item));
+        CHECK(queue.tryPop(value));
+        CHECK(queue.tryPush(item));
+
+        // 变大时唤醒阻塞的生产者
+        BoundedQueue<int> blocked(1);
+        CHECK(blocked.push(0));
+        std::atomic<bool> pushed{false};
+        std::thread producer([&] { pushed = blocked.push(1); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        CHECK(!pushed);
+        blocked.setCapacity(2);
+        producer.join();
+        CHECK(pushed);
+        CHECK(blocked.size() == 2);
+    }
+
+    void test_producers_and_consumer() {
+        constexpr int Producers = 4;
+        constexpr int Items = 2000;
+        BoundedQueue<int> queue(3);
+
+        std::vector<std::thread> producers;
+        for (int p = 0; p < Producers; p++) {
+            producers.emplace_back([&queue, p] {
+                for (int i = 0; i < Items; i++) queue.push(p * Items + i);
+            });
+        }
+
+        // 每个生产者的元素按发送顺序到达，总数不丢不重
+        std::vector<int> last(Producers, -1);
+        int received = 0;
+        int value = 0;
+        while (received < Producers * Items && queue.pop(value)) {
+            const int producer = value / Items;
+            CHECK(value % Items == last[producer] + 1);
+            last[producer] = value % Items;
+            received++;
+        }
+        for (auto& thread : producers) thread.join();
+        CHECK(received == Producers * Items);
+        CHECK(queue.size() == 0);
+    }
+
+} // namespace
+
+int main() {
+    test_fifo_order();
+    test_try_push_keeps_item_when_full();
+    test_pop_for_times_out();
+    test_close_drains_then_fails();
+    test_close_wakes_blocked_threads();
+    test_set_capacity();
+    test_producers_and_consumer();
+    return test::result("BoundedQueueTest");
+}
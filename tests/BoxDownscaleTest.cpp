@@ -0,0 +1,92 @@
+//
+// Created by Weichuandong on 2025/4/5.
+//
+
+#include "video/BoxDownscale.h"
+#include "TestCheck.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+    constexpr uint8_t Guard = 0xA5;
+
+    // 逐像素的参考实现，与 SSE2/NEON 路径逐字节比较
+    uint8_t reference_pixel(const uint8_t* src, int stride, int width, int height, int x, int y) {
+        const int x0 = std::min(x * 2, width - 1);
+        const int x1 = std::min(x * 2 + 1, width - 1);
+        const int y0 = std::min(y * 2, height - 1);
+        const int y1 = std::min(y * 2 + 1, height - 1);
+        const int sum = src[y0 * stride + x0] + src[y0 * stride + x1] + src[y1 * stride + x0] + src[y1 * stride + x1];
+        return static_cast<uint8_t>((sum + 2) >> 2);
+    }
+
+    // offset 让源指针不按 16 字节对齐；输出行尾留保护字节检查越界写
+    void check_size(std::mt19937& rng, int width, int height, int dst_width, int dst_height, int offset) {
+        const int src_stride = width + 13;
+        const int dst_stride = dst_width + 7;
+        std::vector<uint8_t> src(static_cast<size_t>(src_stride) * height + offset);
+        std::uniform_int_distribution<int> value(0, 255);
+        for (auto& pixel : src) pixel = static_cast<uint8_t>(value(rng));
+        const uint8_t* plane = src.data() + offset;
+
+        std::vector<uint8_t> dst(static_cast<size_t>(dst_stride) * dst_height, Guard);
+        video::box_downscale_2x(plane, src_stride, width, height, dst.data(), dst_stride, dst_width, dst_height);
+
+        int mismatches = 0;
+        int overwritten = 0;
+        for (int y = 0; y < dst_height; y++) {
+            for (int x = 0; x < dst_width; x++) {
+                if (dst[y * dst_stride + x] != reference_pixel(plane, src_stride, width, height, x, y)) mismatches++;
+            }
+            for (int x = dst_width; x < dst_stride; x++) {
+                if (dst[y * dst_stride + x] != Guard) overwritten++;
+            }
+        }
+        if (mismatches != 0 || overwritten != 0) {
+            std::fprintf(stderr, "%dx%d -> %dx%d (偏移 %d): %d 个像素不一致, %d 个保护字节被改写\n",
+                         width, height, dst_width, dst_height, offset, mismatches, overwritten);
+        }
+        CHECK(mismatches == 0);
+        CHECK(overwritten == 0);
+    }
+
+    void test_matches_reference() {
+        std::mt19937 rng(20250405);
+        const int sizes[][2] = {
+                {1, 1}, {2, 2}, {3, 5}, {15, 9}, {16, 16}, {17, 17}, {31, 4},
+                {32, 2}, {33, 7}, {64, 3}, {129, 65}, {1920, 6}, {1921, 5}
+        };
+        for (const auto& size : sizes) {
+            const int width = size[0];
+            const int height = size[1];
+            for (int offset = 0; offset < 2; offset++) {
+                // 向上取整（最后一列/行钳位）和向下取整两种输出尺寸
+                check_size(rng, width, height, (width + 1) / 2, (height + 1) / 2, offset);
+                if (width >= 2 && height >= 2) {
+                    check_size(rng, width, height, width / 2, height / 2, offset);
+                }
+            }
+        }
+    }
+
+    void test_rounding() {
+        // 四舍五入：和为 4n+2 时进位，避免逐级缩小后整体变暗
+        const uint8_t src[] = {0, 1, 255, 255,
+                               0, 1, 255, 254};
+        uint8_t dst[2] = {};
+        video::box_downscale_2x(src, 4, 4, 2, dst, 2, 2, 1);
+        CHECK(dst[0] == 1);
+        CHECK(dst[1] == 255);
+    }
+
+} // namespace
+
+int main() {
+    test_matches_reference();
+    test_rounding();
+    return test::result("BoxDownscaleTest");
+}
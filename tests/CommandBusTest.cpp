@@ -0,0 +1,167 @@
+//
+// Created by Weichuandong on 2025/4/5.
+//
+
+#include "video/CommandBus.h"
+#include "logger.h"
+#include "TestCheck.h"
+
+#include <vector>
+
+using video::CommandBus;
+
+namespace {
+
+    PlayerCommand make(PlayerEvent event, double value = 0.0, int arg = 0) {
+        PlayerCommand command;
+        command.event = event;
+        command.value = value;
+        command.arg = arg;
+        return command;
+    }
+
+    PlayerCommand forward() { return make(PlayerEvent::SeekForward_5, video::RelativeSeekSeconds); }
+    PlayerCommand backward() { return make(PlayerEvent::SeekBackWard_5, video::RelativeSeekSeconds); }
+
+    std::vector<PlayerCommand> drain(CommandBus& bus, std::initializer_list<PlayerCommand> commands) {
+        for (const auto& command : commands) bus.post(command);
+        std::vector<PlayerCommand> merged;
+        bus.drain(merged);
+        return merged;
+    }
+
+    void test_relative_seeks_sum() {
+        CommandBus bus;
+        auto merged = drain(bus, {forward(), forward(), forward()});
+        CHECK(merged.size() == 1);
+        CHECK(merged[0].event == PlayerEvent::SeekForward_5);
+        CHECK_NEAR(merged[0].value, 15.0, 1e-9);
+
+        merged = drain(bus, {forward(), backward(), backward(), backward()});
+        CHECK(merged.size() == 1);
+        CHECK(merged[0].event == PlayerEvent::SeekBackWard_5);
+        CHECK_NEAR(merged[0].value, 10.0, 1e-9);
+
+        // 正反抵消后不执行
+        CHECK(drain(bus, {forward(), backward()}).empty());
+    }
+
+    void test_latest_seek_wins() {
+        CommandBus bus;
+        // 拖动预览后松开：只执行最终跳转
+        auto merged = drain(bus, {make(PlayerEvent::Seek, 0.2, 1), make(PlayerEvent::Seek, 0.3, 1),
+                                  make(PlayerEvent::Seek, 0.4, 0)});
+        CHECK(merged.size() == 1);
+        CHECK_NEAR(merged[0].value, 0.4, 1e-9);
+        CHECK(merged[0].arg == 0);
+
+        // 松开后又开始拖动：最新的预览代表当前意图
+        merged = drain(bus, {make(PlayerEvent::Seek, 0.4, 0), make(PlayerEvent::Seek, 0.6, 1)});
+        CHECK(merged.size() == 1);
+        CHECK_NEAR(merged[0].value, 0.6, 1e-9);
+        CHECK(merged[0].arg == 1);
+
+        // 拖动过程中夹着其他命令：较早的跳转全部丢弃，最后一次留在原位置
+        merged = drain(bus, {make(PlayerEvent::Seek, 0.1, 1), make(PlayerEvent::SpeedStep, 0.0, 1),
+                             make(PlayerEvent::Seek, 0.2, 1), make(PlayerEvent::AdjustFilter, 0.0, -1),
+                             make(PlayerEvent::Seek, 0.5, 0), make(PlayerEvent::ToggleStats)});
+        CHECK(merged.size() == 4);
+        CHECK(merged[0].event == PlayerEvent::SpeedStep);
+        CHECK(merged[1].event == PlayerEvent::AdjustFilter);
+        CHECK(merged[2].event == PlayerEvent::Seek);
+        CHECK_NEAR(merged[2].value, 0.5, 1e-9);
+        CHECK(merged[2].arg == 0);
+        CHECK(merged[3].event == PlayerEvent::ToggleStats);
+    }
+
+    void test_play_pause_pairs_cancel() {
+        CommandBus bus;
+        const PlayerCommand toggle = make(PlayerEvent::PlayPause);
+        CHECK(drain(bus, {toggle, toggle}).empty());
+        auto merged = drain(bus, {toggle, toggle, toggle});
+        CHECK(merged.size() == 1);
+        CHECK(merged[0].event == PlayerEvent::PlayPause);
+    }
+
+    void test_steps_sum() {
+        CommandBus bus;
+        for (PlayerEvent event : {PlayerEvent::StepFrame, PlayerEvent::SpeedStep, PlayerEvent::AdjustFilter}) {
+            auto merged = drain(bus, {make(event, 0.0, 1), make(event, 0.0, 1), make(event, 0.0, 1),
+                                      make(event, 0.0, -1)});
+            CHECK(merged.size() == 1);
+            CHECK(merged[0].event == event);
+            CHECK(merged[0].arg == 2);
+            CHECK(drain(bus, {make(event, 0.0, 1), make(event, 0.0, -1)}).empty());
+        }
+    }
+
+    void test_duplicates_collapse() {
+        CommandBus bus;
+        for (PlayerEvent event : {PlayerEvent::Quit, PlayerEvent::Restart, PlayerEvent::ClearFilters}) {
+            auto merged = drain(bus, {make(event), make(event), make(event)});
+            CHECK(merged.size() == 1);
+            CHECK(merged[0].event == event);
+        }
+        // 开关类命令成对出现也要逐个执行
+        auto merged = drain(bus, {make(PlayerEvent::ToggleFilter, 0.0, 2), make(PlayerEvent::ToggleFilter, 0.0, 2),
+                                  make(PlayerEvent::ToggleStats), make(PlayerEvent::ToggleStats)});
+        CHECK(merged.size() == 4);
+    }
+
+    void test_only_adjacent_merge() {
+        CommandBus bus;
+        auto merged = drain(bus, {forward(), make(PlayerEvent::PlayPause), forward()});
+        CHECK(merged.size() == 3);
+        CHECK(merged[0].event == PlayerEvent::SeekForward_5);
+        CHECK(merged[1].event == PlayerEvent::PlayPause);
+        CHECK(merged[2].event == PlayerEvent::SeekForward_5);
+        CHECK_NEAR(merged[2].value, 5.0, 1e-9);
+
+        // 中间的命令抵消后，两侧的命令变为相邻
+        const PlayerCommand toggle = make(PlayerEvent::PlayPause);
+        CHECK(drain(bus, {toggle, forward(), backward(), toggle}).empty());
+    }
+
+    void test_drain_replaces_and_overflow() {
+        CommandBus bus;
+        std::vector<PlayerCommand> merged(3, make(PlayerEvent::Quit));
+        bus.drain(merged);
+        CHECK(merged.empty());
+
+        // 队列满时丢弃，不阻塞
+        int accepted = 0;
+        for (int i = 0; i < 300; i++) {
+            if (bus.post(make(PlayerEvent::ToggleFilter, 0.0, i % 7))) accepted++;
+        }
+        CHECK(accepted == 256);
+        bus.drain(merged);
+        CHECK(merged.size() == 256);
+        CHECK(merged[255].arg == 255 % 7);
+        CHECK(bus.post(forward()));
+    }
+
+    void test_key_bindings() {
+        PlayerCommand command = video::command_for_key(SDLK_RIGHT);
+        CHECK(command.event == PlayerEvent::SeekForward_5);
+        CHECK_NEAR(command.value, video::RelativeSeekSeconds, 1e-9);
+        command = video::command_for_key(SDLK_COMMA);
+        CHECK(command.event == PlayerEvent::StepFrame && command.arg == -1);
+        command = video::command_for_key(SDLK_7);
+        CHECK(command.event == PlayerEvent::ToggleFilter && command.arg == 6);
+        CHECK(video::command_for_key(SDLK_q).event == PlayerEvent::None);
+    }
+
+} // namespace
+
+int main() {
+    Logger::init();
+    test_relative_seeks_sum();
+    test_latest_seek_wins();
+    test_play_pause_pairs_cancel();
+    test_steps_sum();
+    test_duplicates_collapse();
+    test_only_adjacent_merge();
+    test_drain_replaces_and_overflow();
+    test_key_bindings();
+    return test::result("CommandBusTest");
+}
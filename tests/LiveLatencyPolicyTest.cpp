@@ -0,0 +1,125 @@
+//
+// Created by Weichuandong on 2025/4/5.
+//
+
+#include "video/LiveLatencyPolicy.h"
+#include "TestCheck.h"
+
+using video::LiveLatencyPolicy;
+
+namespace {
+
+    // 测试在微秒级内完成，延迟几乎全部来自 queued_seconds，可以精确控制
+    constexpr double Tolerance = 0.01;
+
+    double settle(LiveLatencyPolicy& policy, double pts, double queued, int frames = 200) {
+        for (int i = 0; i < frames; i++) policy.update(pts, queued);
+        return policy.speed();
+    }
+
+    void test_before_first_packet() {
+        LiveLatencyPolicy policy;
+        CHECK(policy.update(1.0, 5.0));
+        CHECK(policy.latency() < 0.0);
+        CHECK_NEAR(policy.speed(), 1.0, 1e-9);
+        CHECK_NEAR(LiveLatencyPolicy(-1.0).target(), 0.0, 1e-9);
+    }
+
+    void test_latency_includes_queue() {
+        LiveLatencyPolicy policy(0.3);
+        policy.on_packet(10.0);
+        CHECK(policy.update(10.0, 0.0));
+        CHECK_NEAR(policy.latency(), 0.0, Tolerance);
+        CHECK(policy.update(10.0, 0.25));
+        CHECK_NEAR(policy.latency(), 0.25, Tolerance);
+        CHECK_NEAR(policy.speed(), 1.0, 1e-9);
+    }
+
+    void test_baseline_is_fastest_arrival() {
+        LiveLatencyPolicy policy(0.3);
+        policy.on_packet(0.0);
+        // 后一个包的时间戳领先 1 秒到达：之前的包实际晚到了 1 秒
+        policy.on_packet(1.0);
+        CHECK(policy.update(1.0, 0.0));
+        CHECK_NEAR(policy.latency(), 0.0, Tolerance);
+        CHECK(!policy.update(0.0, 0.0));
+        CHECK_NEAR(policy.latency(), 1.0, Tolerance);
+    }
+
+    void test_drop_beyond_target() {
+        LiveLatencyPolicy policy(0.3);
+        policy.on_packet(5.0);
+        // 超出目标 0.5 秒以内只加速，超过则丢帧
+        CHECK(policy.update(5.0, 0.75));
+        CHECK(policy.dropped() == 0);
+        CHECK(!policy.update(5.0, 0.9));
+        CHECK(!policy.update(5.0, 2.0));
+        CHECK(policy.dropped() == 2);
+        CHECK_NEAR(policy.latency(), 2.0, Tolerance);
+    }
+
+    void test_speed_ladder() {
+        LiveLatencyPolicy policy(0.3);
+        policy.on_packet(0.0);
+
+        // 平滑后的超出量越过 Enter 升档
+        CHECK_NEAR(settle(policy, 0.0, 0.35, 1), 1.05, 1e-9);
+        CHECK_NEAR(settle(policy, 0.0, 0.5), 1.1, 1e-9);
+        CHECK_NEAR(settle(policy, 0.0, 0.7), 1.25, 1e-9);
+
+        // 回到目标附近逐级降档，中间经过各档的滞回区间
+        CHECK_NEAR(settle(policy, 0.0, 0.55), 1.25, 1e-9);     // 0.25 > Leave 0.2
+        CHECK_NEAR(settle(policy, 0.0, 0.4), 1.1, 1e-9);            // 0.1 > Leave 0.08
+        CHECK_NEAR(settle(policy, 0.0, 0.32), 1.05, 1e-9);          // 0.02 > Leave 0.01
+        CHECK_NEAR(settle(policy, 0.0, 0.3), 1.0, 1e-9);
+
+        // 同样的超出量，从低档出发不会越过 Enter
+        LiveLatencyPolicy rising(0.3);
+        rising.on_packet(0.0);
+        CHECK_NEAR(settle(rising, 0.0, 0.4), 1.05, 1e-9);           // 0.1 < Enter 0.15
+        CHECK(rising.dropped() == 0);
+        LiveLatencyPolicy idle(0.3);
+        idle.on_packet(0.0);
+        CHECK_NEAR(settle(idle, 0.0, 0.32), 1.0, 1e-9);             // 0.02 < Enter 0.03
+    }
+
+    void test_discontinuity_resets_baseline() {
+        LiveLatencyPolicy policy(0.3);
+        policy.on_packet(100.0);
+        // 时间戳回退（源重新开始）时重新估计基准，否则会被当作 90 秒的延迟全部丢弃
+        policy.on_packet(10.0);
+        CHECK(policy.update(10.0, 0.0));
+        CHECK_NEAR(policy.latency(), 0.0, Tolerance);
+
+        // 向前跳跃超过 5 秒同样重新估计
+        policy.on_packet(20.0);
+        CHECK(policy.update(20.0, 0.0));
+        CHECK_NEAR(policy.latency(), 0.0, Tolerance);
+        CHECK(policy.dropped() == 0);
+    }
+
+    void test_live_url() {
+        CHECK(video::is_live_url("udp://239.0.0.1:1234"));
+        CHECK(video::is_live_url("rtp://127.0.0.1:5004"));
+        CHECK(video::is_live_url("rtsp://camera/stream"));
+        CHECK(video::is_live_url("rtsps://camera/stream"));
+        CHECK(video::is_live_url("rtmp://server/live"));
+        CHECK(video::is_live_url("srt://host:9000"));
+        CHECK(!video::is_live_url("http://host/video.mp4"));
+        CHECK(!video::is_live_url("udp.mp4"));
+        CHECK(!video::is_live_url("file://udp://x"));
+        CHECK(!video::is_live_url(""));
+    }
+
+} // namespace
+
+int main() {
+    test_before_first_packet();
+    test_latency_includes_queue();
+    test_baseline_is_fastest_arrival();
+    test_drop_beyond_target();
+    test_speed_ladder();
+    test_discontinuity_resets_baseline();
+    test_live_url();
+    return test::result("LiveLatencyPolicyTest");
+}
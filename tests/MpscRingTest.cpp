@@ -0,0 +1,91 @@
+//
+// Created by Weichuandong on 2025/4/5.
+//
+
+#include "video/MpscRing.h"
+#include "TestCheck.h"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using video::MpscRing;
+
+namespace {
+
+    void test_fifo_and_full() {
+        MpscRing<int, 8> ring;
+        int value = -1;
+        CHECK(!ring.try_pop(value));
+        for (int i = 0; i < 8; i++) CHECK(ring.try_push(i));
+        // 满时拒绝，不覆盖未取走的元素
+        CHECK(!ring.try_push(8));
+        for (int i = 0; i < 8; i++) {
+            CHECK(ring.try_pop(value));
+            CHECK(value == i);
+        }
+        CHECK(!ring.try_pop(value));
+    }
+
+    void test_wrap_around() {
+        MpscRing<int, 4> ring;
+        int next_pop = 0;
+        int value = 0;
+        // 多次绕圈，每轮推入 3 个取出 3 个
+        for (int round = 0; round < 1000; round++) {
+            for (int i = 0; i < 3; i++) CHECK(ring.try_push(round * 3 + i));
+            for (int i = 0; i < 3; i++) {
+                CHECK(ring.try_pop(value));
+                CHECK(value == next_pop++);
+            }
+        }
+        CHECK(!ring.try_pop(value));
+    }
+
+    void test_multiple_producers() {
+        constexpr int Producers = 4;
+        constexpr uint32_t Items = 100000;
+        MpscRing<uint64_t, 64> ring;
+
+        std::vector<std::thread> producers;
+        for (int p = 0; p < Producers; p++) {
+            producers.emplace_back([&ring, p] {
+                for (uint32_t i = 0; i < Items; i++) {
+                    const uint64_t item = (static_cast<uint64_t>(p) << 32) | i;
+                    while (!ring.try_push(item)) std::this_thread::yield();
+                }
+            });
+        }
+
+        // 同一生产者的元素保持顺序，总数不丢不重
+        std::vector<int64_t> last(Producers, -1);
+        uint64_t received = 0;
+        bool ordered = true;
+        uint64_t item = 0;
+        while (received < static_cast<uint64_t>(Producers) * Items) {
+            if (!ring.try_pop(item)) {
+                std::this_thread::yield();
+                continue;
+            }
+            const auto producer = static_cast<int>(item >> 32);
+            const auto sequence = static_cast<int64_t>(item & 0xffffffffu);
+            if (producer >= Producers || sequence != last[producer] + 1) ordered = false;
+            else last[producer] = sequence;
+            received++;
+        }
+        for (auto& thread : producers) thread.join();
+
+        CHECK(ordered);
+        CHECK(received == static_cast<uint64_t>(Producers) * Items);
+        CHECK(!ring.try_pop(item));
+        for (int p = 0; p < Producers; p++) CHECK(last[p] == static_cast<int64_t>(Items) - 1);
+    }
+
+} // namespace
+
+int main() {
+    test_fifo_and_full();
+    test_wrap_around();
+    test_multiple_producers();
+    return test::result("MpscRingTest");
+}
@@ -0,0 +1,130 @@
+//
+// Created by Weichuandong on 2025/4/5.
+//
+
+#include "video/PresentScheduler.h"
+#include "logger.h"
+#include "TestCheck.h"
+
+#include <thread>
+#include <vector>
+
+using video::PresentScheduler;
+using video::SwapMode;
+
+namespace {
+
+    using Clock = PresentScheduler::Clock;
+
+    Clock::duration seconds(double value) {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(value));
+    }
+
+    // 模拟按固定周期阻塞的交换：每次交换睡眠到下一次刷新
+    class FakeDisplay {
+    public:
+        explicit FakeDisplay(double period) : period(period), next(Clock::now()) {}
+
+        void swap() {
+            next += seconds(period);
+            std::this_thread::sleep_until(next);
+        }
+
+        // 跳过若干次刷新，模拟一次卡顿
+        void stall(int refreshes) { next += seconds(period * refreshes); }
+
+    private:
+        double period;
+        Clock::time_point next;
+    };
+
+    void test_short_swaps_fall_back_to_off() {
+        PresentScheduler scheduler(SwapMode::VSync, 60.0);
+        scheduler.begin_frame(0.0);
+        // 交换不阻塞：连续 9 次间隔远小于刷新周期后改为按时间调度
+        for (int i = 0; i < 9; i++) scheduler.on_swap(false);
+        CHECK(scheduler.mode() == SwapMode::VSync);
+        scheduler.on_swap(false);
+        CHECK(scheduler.mode() == SwapMode::Off);
+        CHECK(!scheduler.should_hold());
+    }
+
+    void test_median_refresh_estimate() {
+        // 标称 60Hz，实际 72Hz，夹杂被合并的长间隔
+        PresentScheduler scheduler(SwapMode::VSync, 60.0);
+        CHECK_NEAR(scheduler.stats().refresh_hz, 60.0, 1e-9);
+
+        FakeDisplay display(1.0 / 72.0);
+        scheduler.on_swap(false);
+        for (int i = 0; i < 48; i++) {
+            if (i % 6 == 5) display.stall(2);
+            display.swap();
+            scheduler.on_swap(false);
+        }
+        CHECK(scheduler.mode() == SwapMode::VSync);
+        CHECK_NEAR(scheduler.stats().refresh_hz, 72.0, 3.0);
+    }
+
+    void test_cadence_24_on_60() {
+        PresentScheduler scheduler(SwapMode::VSync, 60.0);
+        FakeDisplay display(1.0 / 60.0);
+
+        // 每帧占用的刷新次数，24fps@60Hz 应为 2、3 交替（3:2 节奏）
+        constexpr int Frames = 48;
+        std::vector<int> refreshes;
+        for (int i = 0; i < Frames; i++) {
+            scheduler.begin_frame(i / 24.0);
+            int count = 1;
+            while (scheduler.should_hold()) {
+                display.swap();
+                scheduler.on_repeat_swap();
+                count++;
+            }
+            display.swap();
+            scheduler.on_swap(true);
+            if (i > 0) refreshes.push_back(count);
+        }
+
+        int total = 0;
+        int twos = 0;
+        int threes = 0;
+        for (int count : refreshes) {
+            total += count;
+            if (count == 2) twos++;
+            if (count == 3) threes++;
+        }
+        // 允许调度抖动造成个别帧偏离
+        CHECK(twos + threes >= static_cast<int>(refreshes.size()) - 2);
+        CHECK(twos >= 20 && threes >= 20);
+        CHECK_NEAR(total, (Frames - 1) * 2.5, 3.0);
+        CHECK(scheduler.stats().frames == Frames);
+        CHECK(scheduler.stats().repeated_refreshes == total - static_cast<int>(refreshes.size()));
+    }
+
+    void test_resync_after_seek() {
+        PresentScheduler scheduler(SwapMode::VSync, 60.0);
+        FakeDisplay display(1.0 / 60.0);
+        scheduler.begin_frame(10.0);
+        display.swap();
+        scheduler.on_swap(true);
+
+        // 时间戳回退（跳转）后立即显示，不等待旧时钟上的时刻
+        scheduler.begin_frame(2.0);
+        CHECK(!scheduler.should_hold());
+        CHECK(!scheduler.is_late());
+
+        // 大幅前跳同样重新对齐
+        scheduler.begin_frame(30.0);
+        CHECK(!scheduler.should_hold());
+    }
+
+} // namespace
+
+int main() {
+    Logger::init();
+    test_short_swaps_fall_back_to_off();
+    test_median_refresh_estimate();
+    test_cadence_24_on_60();
+    test_resync_after_seek();
+    return test::result("PresentSchedulerTest");
+}
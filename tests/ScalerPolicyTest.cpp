@@ -0,0 +1,116 @@
+//
+// Created by Weichuandong on 2025/4/5.
+//
+
+#include "video/ScalerPolicy.h"
+#include "TestCheck.h"
+
+#include <cstring>
+
+using video::ScaleFilter;
+using video::ScalerChoice;
+using video::ScalerPolicy;
+
+namespace {
+
+    ScalerChoice auto_choice(ScalerPolicy& policy, int vw, int vh, int view_w, int view_h,
+                             double gpu_ms = 0.0, double budget_ms = 0.0, bool prescale = true) {
+        return policy.update(ScaleFilter::Auto, prescale, vw, vh, view_w, view_h, gpu_ms, budget_ms);
+    }
+
+    void test_prescale_shift() {
+        ScalerPolicy policy;
+        // 减半后仍不小于窗口才预缩放，最多两次
+        CHECK(auto_choice(policy, 3840, 2160, 960, 540).prescale_shift == 2);
+        CHECK(auto_choice(policy, 3840, 2160, 1000, 540).prescale_shift == 1);
+        CHECK(auto_choice(policy, 7680, 4320, 960, 540).prescale_shift == 2);
+        CHECK(auto_choice(policy, 1920, 1080, 1280, 720).prescale_shift == 0);
+        CHECK(auto_choice(policy, 3840, 2160, 960, 540, 0.0, 0.0, false).prescale_shift == 0);
+    }
+
+    void test_filter_by_ratio() {
+        ScalerPolicy policy;
+        // 预缩放到恰好等于窗口时原样采样
+        CHECK(auto_choice(policy, 3840, 2160, 960, 540).filter == ScaleFilter::Bilinear);
+        CHECK(auto_choice(policy, 1280, 720, 1280, 720).filter == ScaleFilter::Bilinear);
+        // 剩余比例小于 1/2 用 mipmap
+        CHECK(auto_choice(policy, 3840, 2160, 800, 450, 0.0, 0.0, false).filter == ScaleFilter::Mipmap);
+        // 预缩放后比例回到 1/2 以上，使用最高质量卷积核
+        const ScalerChoice choice = auto_choice(policy, 3840, 2160, 800, 450);
+        CHECK(choice.prescale_shift == 2);
+        CHECK(choice.filter == ScaleFilter::Lanczos);
+        CHECK(auto_choice(policy, 1280, 720, 1920, 1080).filter == ScaleFilter::Lanczos);
+    }
+
+    void test_explicit_request() {
+        ScalerPolicy policy;
+        const ScalerChoice choice = policy.update(ScaleFilter::Bicubic, true, 3840, 2160, 960, 540, 50.0, 16.0);
+        CHECK(choice.filter == ScaleFilter::Bicubic);
+        CHECK(choice.prescale_shift == 2);
+        CHECK(policy.update(ScaleFilter::Mipmap, false, 1280, 720, 1280, 720, 0.0, 0.0).filter == ScaleFilter::Mipmap);
+    }
+
+    void test_invalid_size_keeps_choice() {
+        ScalerPolicy policy;
+        const ScalerChoice before = auto_choice(policy, 3840, 2160, 800, 450);
+        const ScalerChoice after = auto_choice(policy, 3840, 2160, 0, 0);
+        CHECK(after.filter == before.filter);
+        CHECK(after.prescale_shift == before.prescale_shift);
+    }
+
+    void test_quality_follows_budget() {
+        ScalerPolicy policy;
+        // 缩放比例 2/3，走卷积核阶梯；GPU 耗时超过预算一半，30 帧后降一级
+        for (int i = 1; i < 30; i++) {
+            CHECK(auto_choice(policy, 1920, 1080, 1280, 720, 10.0, 16.0).filter == ScaleFilter::Lanczos);
+        }
+        CHECK(auto_choice(policy, 1920, 1080, 1280, 720, 10.0, 16.0).filter == ScaleFilter::Bicubic);
+        for (int i = 1; i < 30; i++) {
+            CHECK(auto_choice(policy, 1920, 1080, 1280, 720, 10.0, 16.0).filter == ScaleFilter::Bicubic);
+        }
+        CHECK(auto_choice(policy, 1920, 1080, 1280, 720, 10.0, 16.0).filter == ScaleFilter::Bilinear);
+        for (int i = 0; i < 60; i++) {
+            CHECK(auto_choice(policy, 1920, 1080, 1280, 720, 10.0, 16.0).filter == ScaleFilter::Bilinear);
+        }
+
+        // 低于预算 1/5 要持续 240 帧才恢复一级
+        ScalerPolicy recovering;
+        for (int i = 0; i < 60; i++) auto_choice(recovering, 1920, 1080, 1280, 720, 10.0, 16.0);
+        CHECK(recovering.current().filter == ScaleFilter::Bilinear);
+        for (int i = 1; i < 240; i++) {
+            CHECK(auto_choice(recovering, 1920, 1080, 1280, 720, 1.0, 16.0).filter == ScaleFilter::Bilinear);
+        }
+        CHECK(auto_choice(recovering, 1920, 1080, 1280, 720, 1.0, 16.0).filter == ScaleFilter::Bicubic);
+    }
+
+    void test_no_budget_keeps_quality() {
+        ScalerPolicy policy;
+        for (int i = 0; i < 100; i++) auto_choice(policy, 1920, 1080, 1280, 720, 40.0, 0.0);
+        CHECK(policy.current().filter == ScaleFilter::Lanczos);
+    }
+
+    void test_names() {
+        for (int i = 0; i < static_cast<int>(ScaleFilter::Count); i++) {
+            const auto filter = static_cast<ScaleFilter>(i);
+            ScaleFilter parsed = ScaleFilter::Count;
+            CHECK(video::parse_scale_filter(video::scale_filter_name(filter), parsed));
+            CHECK(parsed == filter);
+        }
+        ScaleFilter filter = ScaleFilter::Bicubic;
+        CHECK(!video::parse_scale_filter("nearest", filter));
+        CHECK(filter == ScaleFilter::Bicubic);
+        CHECK(std::strcmp(video::scale_filter_name(ScaleFilter::Lanczos), "lanczos") == 0);
+    }
+
+} // namespace
+
+int main() {
+    test_prescale_shift();
+    test_filter_by_ratio();
+    test_explicit_request();
+    test_invalid_size_keeps_choice();
+    test_quality_follows_budget();
+    test_no_budget_keeps_quality();
+    test_names();
+    return test::result("ScalerPolicyTest");
+}
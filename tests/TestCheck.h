@@ -0,0 +1,49 @@
+//
+// Created by Weichuandong on 2025/4/5.
+//
+
+#ifndef VIDEOPLAYER_TESTCHECK_H
+#define VIDEOPLAYER_TESTCHECK_H
+
+#include <cmath>
+#include <cstdio>
+
+// 单元测试的最小断言：失败时打印位置并计数，main 返回 test::result()
+namespace test {
+
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline int result(const char* name) {
+        if (failures() == 0) {
+            std::printf("%s: 通过\n", name);
+            return 0;
+        }
+        std::printf("%s: %d 项失败\n", name, failures());
+        return 1;
+    }
+
+} // namespace test
+
+#define CHECK(expr)                                                                 \
+    do {                                                                            \
+        if (!(expr)) {                                                              \
+            std::fprintf(stderr, "%s:%d: 检查失败: %s\n", __FILE__, __LINE__, #expr); \
+            ++test::failures();                                                     \
+        }                                                                           \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                             \
+    do {                                                                                    \
+        const double check_actual = (actual);                                               \
+        const double check_expected = (expected);                                           \
+        if (!(std::abs(check_actual - check_expected) <= (tolerance))) {                    \
+            std::fprintf(stderr, "%s:%d: 检查失败: %s = %g, 期望 %g\n", __FILE__, __LINE__,   \
+                         #actual, check_actual, check_expected);                            \
+            ++test::failures();                                                             \
+        }                                                                                   \
+    } while (0)
+
+#endif //VIDEOPLAYER_TESTCHECK_H
@@ -0,0 +1,100 @@
+//
+// Created by Weichuandong on 2025/4/5.
+//
+
+#include "video/ThreadPool.h"
+#include "TestCheck.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using video::ThreadPool;
+
+namespace {
+
+    // 每个下标恰好执行一次
+    bool each_once(ThreadPool& pool, int count) {
+        std::unique_ptr<std::atomic<int>[]> hits(new std::atomic<int>[count > 0 ? count : 1]);
+        for (int i = 0; i < count; i++) hits[i] = 0;
+        pool.parallel_for(count, [&](int i) { hits[i]++; });
+        for (int i = 0; i < count; i++) {
+            if (hits[i] != 1) return false;
+        }
+        return true;
+    }
+
+    void test_parallel_for_counts() {
+        ThreadPool pool(3);
+        CHECK(pool.size() == 3);
+        for (int count : {0, 1, 2, 3, 4, 7, 100, 10000}) {
+            CHECK(each_once(pool, count));
+        }
+
+        int calls = 0;
+        pool.parallel_for(-5, [&](int) { calls++; });
+        CHECK(calls == 0);
+
+        // 只有一个下标时在调用线程直接执行
+        std::thread::id runner;
+        pool.parallel_for(1, [&](int) { runner = std::this_thread::get_id(); });
+        CHECK(runner == std::this_thread::get_id());
+    }
+
+    void test_nested_parallel_for() {
+        // 外层占满工作线程后内层仍能完成（调用线程自己领取下标）
+        for (int threads : {1, 2, 4}) {
+            ThreadPool pool(threads);
+            constexpr int Outer = 16;
+            constexpr int Inner = 64;
+            std::vector<std::atomic<int>> hits(Outer * Inner);
+            for (auto& hit : hits) hit = 0;
+            pool.parallel_for(Outer, [&](int i) {
+                pool.parallel_for(Inner, [&](int j) { hits[i * Inner + j]++; });
+            });
+            bool all_once = true;
+            for (auto& hit : hits) all_once = all_once && hit == 1;
+            CHECK(all_once);
+        }
+    }
+
+    void test_concurrent_callers() {
+        ThreadPool pool(2);
+        std::atomic<int> ok{0};
+        std::vector<std::thread> callers;
+        for (int t = 0; t < 4; t++) {
+            callers.emplace_back([&] {
+                for (int round = 0; round < 50; round++) {
+                    if (each_once(pool, 33)) ok++;
+                }
+            });
+        }
+        for (auto& caller : callers) caller.join();
+        CHECK(ok == 4 * 50);
+    }
+
+    void test_submit_drains_on_destroy() {
+        std::atomic<int> done{0};
+        {
+            ThreadPool pool(2);
+            for (int i = 0; i < 200; i++) {
+                pool.submit([&done] { done++; });
+            }
+            // 任务中再提交的任务进入工作线程自己的队列
+            pool.submit([&pool, &done] {
+                for (int i = 0; i < 10; i++) pool.submit([&done] { done++; });
+            });
+        }
+        CHECK(done == 210);
+    }
+
+} // namespace
+
+int main() {
+    test_parallel_for_counts();
+    test_nested_parallel_for();
+    test_concurrent_callers();
+    test_submit_drains_on_destroy();
+    return test::result("ThreadPoolTest");
+}
@@ -0,0 +1,123 @@
+//
+// Created by Weichuandong on 2025/4/5.
+//
+
+#include "video/TrickPlayPolicy.h"
+#include "TestCheck.h"
+
+#include <cstring>
+
+using video::DecodeSkip;
+using video::TrickPlayPolicy;
+
+namespace {
+
+    constexpr double FrameSeconds = 1.0 / 24.0;
+
+    // 按目标负载喂入 frames 帧：负载 = 解码耗时 * 速度 / 内容时间
+    DecodeSkip feed(TrickPlayPolicy& policy, double load, int frames) {
+        DecodeSkip skip = policy.current();
+        for (int i = 0; i < frames; i++) {
+            skip = policy.update(load * FrameSeconds / policy.speed(), FrameSeconds);
+        }
+        return skip;
+    }
+
+    void test_speed_clamp() {
+        TrickPlayPolicy policy(100.0);
+        CHECK_NEAR(policy.speed(), TrickPlayPolicy::MaxSpeed, 1e-9);
+        policy.set_speed(0.01);
+        CHECK_NEAR(policy.speed(), TrickPlayPolicy::MinSpeed, 1e-9);
+        CHECK(policy.current() == DecodeSkip::None);
+    }
+
+    void test_step_ladder() {
+        TrickPlayPolicy policy;
+        const double up[] = {1.25, 1.5, 2.0, 4.0, 8.0, 16.0, 16.0};
+        for (double expected : up) {
+            policy.step_speed(true);
+            CHECK_NEAR(policy.speed(), expected, 1e-9);
+        }
+        const double down[] = {8.0, 4.0, 2.0, 1.5, 1.25, 1.0, 0.75, 0.5, 0.25, 0.25};
+        for (double expected : down) {
+            policy.step_speed(false);
+            CHECK_NEAR(policy.speed(), expected, 1e-9);
+        }
+
+        // 不在档位上的速度取相邻的档位
+        policy.set_speed(3.0);
+        policy.step_speed(true);
+        CHECK_NEAR(policy.speed(), 4.0, 1e-9);
+        policy.set_speed(3.0);
+        policy.step_speed(false);
+        CHECK_NEAR(policy.speed(), 2.0, 1e-9);
+    }
+
+    void test_escalates_when_overloaded() {
+        TrickPlayPolicy policy(4.0);
+        // 观察满 8 帧后才升级
+        CHECK(feed(policy, 0.96, 7) == DecodeSkip::None);
+        CHECK(feed(policy, 0.96, 1) == DecodeSkip::NonRef);
+        CHECK(feed(policy, 0.96, 7) == DecodeSkip::NonRef);
+        CHECK(feed(policy, 0.96, 1) == DecodeSkip::NonKey);
+        CHECK(feed(policy, 2.0, 50) == DecodeSkip::NonKey);
+
+        // 负载未超过上限不升级
+        TrickPlayPolicy light(4.0);
+        CHECK(feed(light, 0.8, 100) == DecodeSkip::None);
+    }
+
+    void test_normal_speed_never_skips() {
+        TrickPlayPolicy policy(1.0);
+        CHECK(feed(policy, 3.0, 100) == DecodeSkip::None);
+        policy.set_speed(0.5);
+        CHECK(feed(policy, 3.0, 100) == DecodeSkip::None);
+    }
+
+    void test_select_on_speed_change() {
+        // 未测量过的级别视为能跟上
+        TrickPlayPolicy fresh;
+        CHECK(fresh.set_speed(16.0) == DecodeSkip::None);
+
+        // 4x 下完整解码负载 0.96（折算 1x 为 0.24），跳过 B 帧后 0.4（折算 0.1）
+        TrickPlayPolicy policy(4.0);
+        CHECK(feed(policy, 0.96, 8) == DecodeSkip::NonRef);
+        CHECK(feed(policy, 0.4, 16) == DecodeSkip::NonRef);
+
+        CHECK(policy.set_speed(2.0) == DecodeSkip::None);       // 0.48
+        CHECK(policy.set_speed(4.0) == DecodeSkip::NonRef);     // 0.96 -> 0.4
+        CHECK(policy.set_speed(8.0) == DecodeSkip::NonKey);     // 1.92 -> 0.8 -> 未测量
+        CHECK(policy.set_speed(1.0) == DecodeSkip::None);
+        CHECK(policy.step_speed(true) == DecodeSkip::None);     // 1.25x: 0.3
+    }
+
+    void test_ignores_invalid_samples() {
+        TrickPlayPolicy policy(4.0);
+        CHECK(feed(policy, 0.96, 7) == DecodeSkip::None);
+        // 时间戳不前进、回退或跨度超过 1 秒墙上时间（跳转）的样本不计入观察期
+        for (int i = 0; i < 20; i++) {
+            CHECK(policy.update(1.0, 0.0) == DecodeSkip::None);
+            CHECK(policy.update(1.0, -FrameSeconds) == DecodeSkip::None);
+            CHECK(policy.update(1.0, 4.5) == DecodeSkip::None);
+        }
+        CHECK(feed(policy, 0.96, 1) == DecodeSkip::NonRef);
+    }
+
+    void test_names() {
+        CHECK(std::strcmp(video::decode_skip_name(DecodeSkip::None), "full") == 0);
+        CHECK(std::strcmp(video::decode_skip_name(DecodeSkip::NonRef), "nonref") == 0);
+        CHECK(std::strcmp(video::decode_skip_name(DecodeSkip::NonKey), "keyframes") == 0);
+    }
+
+} // namespace
+
+int main() {
+    test_speed_clamp();
+    test_step_ladder();
+    test_escalates_when_overloaded();
+    test_normal_speed_never_skips();
+    test_select_on_speed_change();
+    test_ignores_invalid_samples();
+    test_names();
+    return test::result("TrickPlayPolicyTest");
+}